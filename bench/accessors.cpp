@@ -0,0 +1,103 @@
+#include "json.h"
+#include "bench.h"
+#include <string>
+#include <vector>
+
+/*
+ * Latency of the jobject accessors as the accessed value grows. Each line reports one accessor at one size or depth,
+ * so the ns_per_op column shows how the cost scales: constant, linear or worse.
+ */
+
+static const size_t sizes[] = { 4, 16, 64, 256, 1024, 4096 };
+static const size_t depths[] = { 1, 2, 4, 8, 16 };
+
+static std::string key_for(const size_t index)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "key_%lu", (unsigned long)index);
+    return buffer;
+}
+
+/* Builds an object with the given number of numeric members */
+static json::jobject make_object(const size_t size)
+{
+    json::jobject result;
+    for(size_t i = 0; i < size; i++) result[key_for(i)] = (int)i;
+    return result;
+}
+
+/* Builds an object holding an array of numbers under the key "items" */
+static json::jobject make_array(const size_t size)
+{
+    std::vector<int> items;
+    for(size_t i = 0; i < size; i++) items.push_back((int)i);
+    json::jobject result;
+    result["items"] = items;
+    return result;
+}
+
+/* Builds objects nested under the key "n", with a number at the innermost level */
+static json::jobject make_nested(const size_t depth)
+{
+    json::jobject result;
+    result["n"] = 1;
+    for(size_t i = 0; i < depth; i++)
+    {
+        json::jobject parent;
+        parent["n"] = result;
+        parent["padding"] = "a short string that each level carries";
+        result = parent;
+    }
+    return result;
+}
+
+int main(void)
+{
+    bench_header();
+    char name[32];
+
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        const size_t size = sizes[s];
+        snprintf(name, sizeof(name), "size=%lu", (unsigned long)size);
+        std::vector<std::string> keys;
+        for(size_t i = 0; i < size; i++) keys.push_back(key_for(i));
+        size_t next = 0;
+
+        // operator[] on a const object, reading members in turn
+        const json::jobject object = make_object(size);
+        const size_t object_bytes = object.as_string().size();
+        BENCH_RUN("object_index", name, object_bytes, bench_sink += (int)object[keys[next++ % size]]);
+
+        // Assignment through proxy, overwriting members in turn
+        json::jobject writable = make_object(size);
+        BENCH_RUN("proxy_assign", name, object_bytes, writable[keys[next % size]] = (int)next; next++);
+
+        // Element access on a long array, reading elements in turn
+        const json::jobject array = make_array(size);
+        const size_t array_bytes = array.as_string().size();
+        BENCH_RUN("array_index", name, array_bytes, bench_sink += (int)array["items"].array(next++ % size));
+
+        // Type checks parse the whole value they are applied to
+        BENCH_RUN("is_string", name, array_bytes, bench_sink += array["items"].is_string());
+        BENCH_RUN("is_number", name, array_bytes, bench_sink += array["items"].is_number());
+
+        // Conversion of a whole array
+        BENCH_RUN("as_array", name, array_bytes, bench_sink += array["items"].as_array<int>().size());
+    }
+
+    for(size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); d++)
+    {
+        const size_t depth = depths[d];
+        snprintf(name, sizeof(name), "depth=%lu", (unsigned long)depth);
+        const json::jobject nested = make_nested(depth);
+        const size_t nested_bytes = nested.as_string().size();
+
+        // Walks to the innermost value with a chain of const_value::get
+        BENCH_RUN("get_chain", name, nested_bytes,
+            json::jobject::const_value value(nested.get("n"));
+            for(size_t i = 1; i < depth; i++) value = value.get("n");
+            bench_sink += (int)value.get("n"));
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Minimum duration of a single measurement, in seconds */
+#ifndef BENCH_MIN_SECONDS
+#define BENCH_MIN_SECONDS 0.25
+#endif
+
+/* Accumulates results so the compiler cannot discard the measured work */
+static volatile size_t bench_sink = 0;
+
+/* The record used by test/random.cpp */
+static const char bench_record[] =
+"{"
+"	\"_id\": \"5b8ae80aa0ad7bab287b087c\","
+"	\"index\" : 0,"
+"	\"guid\" : \"d05c39f8-e92d-4911-b727-fe3d78b6de6c\","
+"	\"isActive\" : true,"
+"	\"balance\" : \"$3,801.20\","
+"	\"picture\" : \"http://placehold.it/32x32\","
+"	\"age\" : 38,"
+"	\"eyeColor\" : \"blue\","
+"	\"name\" : \"Garrett Beck\","
+"	\"gender\" : \"male\","
+"	\"company\" : \"PERMADYNE\","
+"	\"email\" : \"garrettbeck@permadyne.com\","
+"	\"phone\" : \"+1 (813) 532-3550\","
+"	\"address\" : \"191 Crawford Avenue, Echo, Oklahoma, 6993\","
+"	\"about\" : \"Deserunt deserunt quis laboris elit aliquip labore veniam mollit consequat esse labore. Nulla et tempor labore quis et magna do. Do officia sit aute ullamco in reprehenderit irure. Officia laborum amet ad ea labore fugiat excepteur proident aute.\r\n\","
+"	\"registered\" : \"2015-11-19T08:36:06 -01:00\","
+"	\"latitude\" : 41.271876,"
+"	\"longitude\" : 15.372805,"
+"	\"tags\" : [\"dolore\", \"adipisicing\", \"nostrud\", \"elit\", \"est\", \"et\", \"sunt\"],"
+"	\"friends\": [{\"id\": 0, \"name\" : \"Amie Jarvis\"}, {\"id\": 1, \"name\" : \"Rosanna Gonzales\"}, {\"id\": 2, \"name\" : \"Rhodes Crane\"}],"
+"	\"greeting\": \"Hello, Garrett Beck! You have 7 unread messages.\","
+"	\"favoriteFruit\" : \"strawberry\""
+"}";
+
+/* Prints the column names of the machine-readable output */
+static void bench_header(void)
+{
+    printf("suite,name,bytes,iterations,ns_per_op,mb_per_s\n");
+}
+
+/* Prints one measurement as a comma-separated line */
+static void bench_report(const char *suite, const char *name, const size_t bytes, const unsigned long iterations, const double seconds)
+{
+    const double ns_per_op = seconds * 1e9 / (double)iterations;
+    const double mb_per_s = bytes == 0 || seconds <= 0 ? 0 : (double)bytes * (double)iterations / seconds / 1e6;
+    printf("%s,%s,%lu,%lu,%.1f,%.2f\n", suite, name, (unsigned long)bytes, iterations, ns_per_op, mb_per_s);
+    fflush(stdout);
+}
+
+/* Runs a statement, doubling the number of iterations until the run lasts at least BENCH_MIN_SECONDS, and reports the result */
+#define BENCH_RUN(suite, name, bytes, statement)                               \
+    {                                                                          \
+        unsigned long bench_iterations = 1;                                    \
+        double bench_seconds = 0;                                              \
+        while (1) {                                                            \
+            const clock_t bench_start = clock();                               \
+            for (unsigned long bench_i = 0; bench_i < bench_iterations;        \
+                 bench_i++) {                                                  \
+                statement;                                                     \
+            }                                                                  \
+            bench_seconds = (double)(clock() - bench_start) / CLOCKS_PER_SEC;  \
+            if (bench_seconds >= BENCH_MIN_SECONDS) break;                     \
+            bench_iterations *= 2;                                             \
+        }                                                                      \
+        bench_report(suite, name, bytes, bench_iterations, bench_seconds);     \
+    }
+
+#endif
@@ -0,0 +1,30 @@
+#include "json.h"
+#include "bench.h"
+#include <string>
+
+/* Measures encoding and decoding of one payload in every format */
+static void run(const char *suite, const json::jobject &payload)
+{
+    const std::string text = payload.as_string();
+    const std::string cbor = payload.as_cbor();
+    const std::string msgpack = payload.as_msgpack();
+
+    BENCH_RUN(suite, "text_parse", text.size(), bench_sink += json::jobject::parse(text).size());
+    BENCH_RUN(suite, "text_serialize", text.size(), bench_sink += payload.as_string().size());
+    BENCH_RUN(suite, "cbor_decode", cbor.size(), bench_sink += json::jobject::parse_cbor(cbor).size());
+    BENCH_RUN(suite, "cbor_encode", cbor.size(), bench_sink += payload.as_cbor().size());
+    BENCH_RUN(suite, "msgpack_decode", msgpack.size(), bench_sink += json::jobject::parse_msgpack(msgpack).size());
+    BENCH_RUN(suite, "msgpack_encode", msgpack.size(), bench_sink += payload.as_msgpack().size());
+}
+
+int main(void)
+{
+    bench_header();
+    const json::jobject single = json::jobject::parse(bench_record);
+    run("record", single);
+
+    json::jobject records(true);
+    for(size_t i = 0; i < 100; i++) records += json::kvp("", single.as_string());
+    run("records_100", records);
+    return 0;
+}
@@ -0,0 +1,344 @@
+#include "json.h"
+#include "bench.h"
+#include <string>
+#include <vector>
+#include <string.h>
+
+/* Deterministic pseudo-random numbers, so every run measures the same corpora */
+struct generator
+{
+    uint32_t state;
+
+    generator(const uint32_t seed) : state(seed) { }
+
+    uint32_t next(const uint32_t limit)
+    {
+        this->state = this->state * 1664525u + 1013904223u;
+        return (this->state >> 8) % limit;
+    }
+
+    double real(const double low, const double high)
+    {
+        return low + (high - low) * (double)this->next(1u << 24) / (double)(1u << 24);
+    }
+};
+
+static void append_number(std::string &output, const char *format, const double value)
+{
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), format, value);
+    output += buffer;
+}
+
+static void append_integer(std::string &output, const unsigned long value)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%lu", value);
+    output += buffer;
+}
+
+static const char *words[] = {
+    "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit",
+    "\xe3\x81\x93\xe3\x82\x93\xe3\x81\xab\xe3\x81\xa1\xe3\x81\xaf", "caf\xc3\xa9", "\\u30c6\\u30b9\\u30c8", "\\\"quoted\\\"", "line\\nbreak", "http:\\/\\/t.co\\/x"
+};
+
+static void append_words(generator &random, std::string &output, const size_t count)
+{
+    output += '"';
+    for(size_t i = 0; i < count; i++)
+    {
+        if(i > 0) output += ' ';
+        output += words[random.next(sizeof(words) / sizeof(words[0]))];
+    }
+    output += '"';
+}
+
+/* Search results with short strings, UTF-8 and escapes, in the shape of twitter.json */
+static std::string twitter_like(const size_t statuses)
+{
+    generator random(1);
+    std::string output = "{\"statuses\":[";
+    for(size_t i = 0; i < statuses; i++)
+    {
+        const unsigned long id = 1874924095ul + i;
+        if(i > 0) output += ',';
+        output += "{\"metadata\":{\"result_type\":\"recent\",\"iso_language_code\":\"ja\"},\"created_at\":\"Sun Aug 31 00:29:15 +0000 2014\",\"id\":";
+        append_integer(output, id);
+        output += ",\"id_str\":\"";
+        append_integer(output, id);
+        output += "\",\"text\":";
+        append_words(random, output, 4 + random.next(16));
+        output += ",\"source\":\"<a href=\\\"http:\\/\\/twitter.com\\/download\\/iphone\\\" rel=\\\"nofollow\\\">Twitter for iPhone<\\/a>\",\"truncated\":false,\"in_reply_to_status_id\":null,\"user\":{\"id\":";
+        append_integer(output, random.next(3000000000u));
+        output += ",\"name\":";
+        append_words(random, output, 2);
+        output += ",\"screen_name\":\"user_";
+        append_integer(output, random.next(100000));
+        output += "\",\"description\":";
+        append_words(random, output, random.next(24));
+        output += ",\"followers_count\":";
+        append_integer(output, random.next(50000));
+        output += ",\"friends_count\":";
+        append_integer(output, random.next(5000));
+        output += ",\"verified\":false,\"profile_image_url\":\"http:\\/\\/pbs.twimg.com\\/profile_images\\/";
+        append_integer(output, random.next(1000000));
+        output += "\\/normal.jpeg\"},\"geo\":null,\"entities\":{\"hashtags\":[";
+        const uint32_t hashtags = random.next(3);
+        for(uint32_t h = 0; h < hashtags; h++)
+        {
+            if(h > 0) output += ',';
+            output += "{\"text\":";
+            append_words(random, output, 1);
+            output += ",\"indices\":[";
+            append_integer(output, h * 10);
+            output += ',';
+            append_integer(output, h * 10 + 8);
+            output += "]}";
+        }
+        output += "],\"urls\":[],\"user_mentions\":[]},\"retweet_count\":";
+        append_integer(output, random.next(1000));
+        output += ",\"favorite_count\":";
+        append_integer(output, random.next(1000));
+        output += random.next(2) ? ",\"favorited\":false" : ",\"favorited\":true";
+        output += ",\"retweeted\":false,\"lang\":\"ja\"}";
+    }
+    output += "],\"search_metadata\":{\"completed_in\":0.087,\"count\":";
+    append_integer(output, statuses);
+    output += ",\"query\":\"%E4%B8%80\",\"refresh_url\":\"?since_id=505874924095815681&q=%E4%B8%80&include_entities=1\"}}";
+    return output;
+}
+
+/* Polygons made of long runs of floating point coordinates, in the shape of canada.json */
+static std::string canada_like(const size_t features, const size_t rings, const size_t points)
+{
+    generator random(2);
+    std::string output = "{\"type\":\"FeatureCollection\",\"features\":[";
+    for(size_t f = 0; f < features; f++)
+    {
+        if(f > 0) output += ',';
+        output += "{\"type\":\"Feature\",\"properties\":{\"name\":\"Canada\"},\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[";
+        for(size_t r = 0; r < rings; r++)
+        {
+            if(r > 0) output += ',';
+            output += '[';
+            for(size_t p = 0; p < points; p++)
+            {
+                if(p > 0) output += ',';
+                output += '[';
+                append_number(output, "%.15f", random.real(-141.0, -52.0));
+                output += ',';
+                append_number(output, "%.15f", random.real(41.0, 83.0));
+                output += ']';
+            }
+            output += ']';
+        }
+        output += "]}}";
+    }
+    output += "]}";
+    return output;
+}
+
+/* Large maps keyed by identifiers and nested performance records, in the shape of citm_catalog.json */
+static std::string citm_like(const size_t events, const size_t performances)
+{
+    generator random(3);
+    std::string output = "{\"areaNames\":{";
+    for(size_t i = 0; i < 64; i++)
+    {
+        if(i > 0) output += ',';
+        output += '"';
+        append_integer(output, 205705993ul + i);
+        output += "\":";
+        append_words(random, output, 2);
+    }
+    output += "},\"events\":{";
+    for(size_t i = 0; i < events; i++)
+    {
+        const unsigned long id = 138586341ul + i * 7;
+        if(i > 0) output += ',';
+        output += '"';
+        append_integer(output, id);
+        output += "\":{\"description\":null,\"id\":";
+        append_integer(output, id);
+        output += ",\"logo\":null,\"name\":";
+        append_words(random, output, 3);
+        output += ",\"subTopicIds\":[337184269,337184283],\"subjectCode\":null,\"subtitle\":null,\"topicIds\":[324846099,107888604]}";
+    }
+    output += "},\"performances\":[";
+    for(size_t i = 0; i < performances; i++)
+    {
+        if(i > 0) output += ',';
+        output += "{\"eventId\":";
+        append_integer(output, 138586341ul + random.next((uint32_t)events) * 7);
+        output += ",\"id\":";
+        append_integer(output, 339887544ul + i);
+        output += ",\"logo\":null,\"name\":null,\"prices\":[";
+        const uint32_t categories = 1 + random.next(4);
+        for(uint32_t c = 0; c < categories; c++)
+        {
+            if(c > 0) output += ',';
+            output += "{\"amount\":";
+            append_integer(output, 10000 + random.next(90000));
+            output += ",\"audienceSubCategoryId\":337100890,\"seatCategoryId\":";
+            append_integer(output, 338937295ul + c);
+            output += '}';
+        }
+        output += "],\"seatCategories\":[";
+        for(uint32_t c = 0; c < categories; c++)
+        {
+            if(c > 0) output += ',';
+            output += "{\"areas\":[";
+            const uint32_t areas = 1 + random.next(6);
+            for(uint32_t a = 0; a < areas; a++)
+            {
+                if(a > 0) output += ',';
+                output += "{\"areaId\":";
+                append_integer(output, 205705993ul + random.next(64));
+                output += ",\"blockIds\":[]}";
+            }
+            output += "],\"seatCategoryId\":";
+            append_integer(output, 338937295ul + c);
+            output += '}';
+        }
+        output += "],\"seatMapImage\":null,\"start\":";
+        append_integer(output, 1372701600ul + (unsigned long)i * 3600);
+        output += "000,\"venueCode\":\"PLEYEL_PLEYEL\"}";
+    }
+    output += "],\"venueNames\":{\"PLEYEL_PLEYEL\":\"Salle Pleyel\"}}";
+    return output;
+}
+
+/* Typed views of each corpus, used to measure extraction through json::binding */
+namespace corpus
+{
+    struct twitter_user
+    {
+        std::string screen_name;
+        unsigned long followers_count;
+    };
+
+    struct status
+    {
+        double id;
+        std::string text;
+        twitter_user user;
+        unsigned long retweet_count;
+        bool favorited;
+    };
+
+    struct timeline
+    {
+        std::vector<status> statuses;
+    };
+
+    struct shape
+    {
+        std::string type;
+        std::vector<std::vector<std::vector<double> > > coordinates;
+    };
+
+    struct feature
+    {
+        shape geometry;
+    };
+
+    struct collection
+    {
+        std::vector<feature> features;
+    };
+
+    struct price
+    {
+        unsigned long amount;
+        double seatCategoryId;
+    };
+
+    struct performance
+    {
+        double id;
+        double eventId;
+        std::vector<price> prices;
+        double start;
+    };
+
+    struct catalog
+    {
+        std::vector<performance> performances;
+    };
+
+    struct person_friend
+    {
+        int id;
+        std::string name;
+    };
+
+    struct person
+    {
+        int index;
+        std::string name;
+        int age;
+        bool isActive;
+        double latitude;
+        double longitude;
+        std::vector<std::string> tags;
+        std::vector<person_friend> friends;
+    };
+}
+
+#define TWITTER_USER_FIELDS(FIELD) FIELD(screen_name) FIELD(followers_count)
+JSON_BIND_STRUCT(corpus::twitter_user, TWITTER_USER_FIELDS)
+#define STATUS_FIELDS(FIELD) FIELD(id) FIELD(text) FIELD(user) FIELD(retweet_count) FIELD(favorited)
+JSON_BIND_STRUCT(corpus::status, STATUS_FIELDS)
+#define TIMELINE_FIELDS(FIELD) FIELD(statuses)
+JSON_BIND_STRUCT(corpus::timeline, TIMELINE_FIELDS)
+#define SHAPE_FIELDS(FIELD) FIELD(type) FIELD(coordinates)
+JSON_BIND_STRUCT(corpus::shape, SHAPE_FIELDS)
+#define FEATURE_FIELDS(FIELD) FIELD(geometry)
+JSON_BIND_STRUCT(corpus::feature, FEATURE_FIELDS)
+#define COLLECTION_FIELDS(FIELD) FIELD(features)
+JSON_BIND_STRUCT(corpus::collection, COLLECTION_FIELDS)
+#define PRICE_FIELDS(FIELD) FIELD(amount) FIELD(seatCategoryId)
+JSON_BIND_STRUCT(corpus::price, PRICE_FIELDS)
+#define PERFORMANCE_FIELDS(FIELD) FIELD(id) FIELD(eventId) FIELD(prices) FIELD(start)
+JSON_BIND_STRUCT(corpus::performance, PERFORMANCE_FIELDS)
+#define CATALOG_FIELDS(FIELD) FIELD(performances)
+JSON_BIND_STRUCT(corpus::catalog, CATALOG_FIELDS)
+#define PERSON_FRIEND_FIELDS(FIELD) FIELD(id) FIELD(name)
+JSON_BIND_STRUCT(corpus::person_friend, PERSON_FRIEND_FIELDS)
+#define PERSON_FIELDS(FIELD) FIELD(index) FIELD(name) FIELD(age) FIELD(isActive) FIELD(latitude) FIELD(longitude) FIELD(tags) FIELD(friends)
+JSON_BIND_STRUCT(corpus::person, PERSON_FIELDS)
+
+/* Returns true if the suite was selected on the command line */
+static bool selected(const int argc, char **argv, const char *suite)
+{
+    if(argc < 2) return true;
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], suite) == 0) return true;
+    }
+    return false;
+}
+
+/* Measures parsing, serialization, pretty printing and typed extraction of one corpus */
+template <typename T>
+static void run(const char *suite, const std::string &text)
+{
+    const json::jobject parsed = json::jobject::parse(text);
+    const std::string compact = parsed.as_string();
+    const std::string pretty = parsed.pretty();
+
+    BENCH_RUN(suite, "parse", text.size(), bench_sink += json::jobject::parse(text).size());
+    BENCH_RUN(suite, "serialize", compact.size(), bench_sink += parsed.as_string().size());
+    BENCH_RUN(suite, "pretty", pretty.size(), bench_sink += parsed.pretty().size());
+    BENCH_RUN(suite, "extract", text.size(), T value = json::binding::parse<T>(text); bench_sink += sizeof(value));
+}
+
+int main(int argc, char **argv)
+{
+    bench_header();
+    if(selected(argc, argv, "twitter")) run<corpus::timeline>("twitter", twitter_like(800));
+    if(selected(argc, argv, "canada")) run<corpus::collection>("canada", canada_like(8, 4, 400));
+    if(selected(argc, argv, "citm")) run<corpus::catalog>("citm", citm_like(1024, 1200));
+    if(selected(argc, argv, "record")) run<corpus::person>("record", bench_record);
+    return 0;
+}
@@ -5,6 +5,17 @@
 #include "json.h"
 #include <string.h>
 #include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <algorithm>
+#if JSON_HAS_CXX11
+#include <regex>
+#endif
+#if JSON_ENABLE_STATS
+#include <atomic>
+#include <chrono>
+#include <new>
+#endif
 
 /*! \brief Checks for an empty string
  * 
@@ -33,6 +44,32 @@
  */
 #define IS_DIGIT(input) (input >= '0' && input <= '9')
 
+/*! \brief A machine word with every byte set to one */
+#define SWAR_ONES (~(size_t)0 / 255)
+
+/*! \brief A machine word with the high bit of every byte set */
+#define SWAR_HIGHS (SWAR_ONES * 0x80)
+
+/*! \brief Determines if any byte of a machine word is less than a value
+ *
+ * @param word The machine word to test
+ * @param n The value to compare against (no greater than 128)
+ */
+#define SWAR_HAS_LESS(word, n) (((word) - SWAR_ONES * (n)) & ~(word) & SWAR_HIGHS)
+
+/*! \brief Determines if any byte of a machine word is equal to a value
+ *
+ * @param word The machine word to test
+ * @param c The value to search for
+ */
+#define SWAR_HAS_BYTE(word, c) SWAR_HAS_LESS((word) ^ (SWAR_ONES * (unsigned char)(c)), 1)
+
+/*! \brief State of the UTF-8 validator when no sequence is in progress */
+#define UTF8_ACCEPT 0
+
+/*! \brief State of the UTF-8 validator after an invalid sequence is encountered */
+#define UTF8_REJECT 1
+
 /*! \brief Format used for integer to string conversion */
 const char * INT_FORMAT = "%i";
 
@@ -99,18 +136,39 @@ json::jtype::jtype json::jtype::detect(const char *input)
     return json::jtype::peek(*start);
 }
 
+#if JSON_ENABLE_STATS
+static uint64_t monotonic_ns();
+static void record_latency(const json::stats::operation op, const uint64_t elapsed);
+#endif
+
 void json::reader::clear()
 {
     std::string::clear(); 
+    #if JSON_ENABLE_STATS
+    this->stats_start = 0;
+    #endif
     if(this->sub_reader != NULL) {
         delete this->sub_reader;
         this->sub_reader = NULL;
     }
     this->read_state = 0;
+    this->utf8_state = UTF8_ACCEPT;
+}
+
+bool json::reader::utf8_error() const
+{
+    if(this->utf8_state == UTF8_REJECT) return true;
+    return this->sub_reader != NULL && this->sub_reader->utf8_error();
 }
 
 json::reader::push_result json::reader::push(const char next)
 {
+    // Pushes are timed per value rather than per character, below
+    #if JSON_ENABLE_STATS
+    const json::stats::scope json_stats_scope(json::stats::PARSE, false);
+    #endif
+    JSON_STATS_COUNT_INPUT(1);
+
     // Check for opening whitespace
     if(this->length() == 0 && std::isspace(next)) return reader::ACCEPTED;
 
@@ -159,6 +217,18 @@ json::reader::push_result json::reader::push(const char next)
     else assert(this->length() == start_length);
     #endif
 
+    // Values pushed by the application are timed from their first character until they are complete. Numbers have no closing character, so they are complete when a character is rejected after them.
+    #if JSON_ENABLE_STATS
+    if(json_stats_scope.is_outermost()) {
+        if(result == ACCEPTED && this->length() == 1) this->stats_start = monotonic_ns();
+        const bool complete = type == json::jtype::jnumber ? result == REJECTED && this->is_valid() : result == ACCEPTED && this->is_valid();
+        if(complete && this->stats_start != 0) {
+            record_latency(json::stats::PARSE, monotonic_ns() - this->stats_start);
+            this->stats_start = 0;
+        }
+    }
+    #endif
+
     // Return the result
     return result;
 }
@@ -208,6 +278,7 @@ bool is_control_character(const char input)
     case 't':
     case '"':
     case '\\':
+    case '/':
         return true;
     default:
         return false;
@@ -219,6 +290,74 @@ bool is_hex_digit(const char input)
     return IS_DIGIT(input) || (input >= 'a' && input <= 'f') || (input >= 'A' && input <= 'F');
 }
 
+/*! \brief Character classes of the bytes 0x80 to 0xFF used by the UTF-8 validator
+ *
+ * ASCII bytes are class zero. The remaining classes are continuation bytes 80-8F (1), 90-9F (2) and A0-BF (3), invalid bytes (4), two-byte leads (5), E0 (6), three-byte leads (7), ED (8), F0 (9), F1-F3 (10) and F4 (11).
+ */
+static const unsigned char UTF8_CLASSES[128] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    4, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 7,
+    9, 10, 10, 10, 11, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4
+};
+
+/*! \brief State transitions of the UTF-8 validator, indexed by state and character class
+ *
+ * States two through four expect one, two and three more continuation bytes. States five through eight expect the restricted second byte following E0, ED, F0 and F4 respectively.
+ */
+static const unsigned char UTF8_TRANSITIONS[9][12] = {
+    { 0, 1, 1, 1, 1, 2, 5, 3, 6, 7, 4, 8 },
+    { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 3, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 1, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 }
+};
+
+/*! \brief Advances the UTF-8 validator by one byte
+ *
+ * @param state The current state of the validator
+ * @param next The next byte of input
+ * @return The new state of the validator
+ */
+static inline unsigned char utf8_step(const unsigned char state, const unsigned char next)
+{
+    return UTF8_TRANSITIONS[state][next < 0x80 ? 0 : UTF8_CLASSES[next - 0x80]];
+}
+
+size_t json::parsing::validate_utf8(const char *input, const size_t length)
+{
+    unsigned char state = UTF8_ACCEPT;
+    size_t sequence_start = 0;
+    size_t i = 0;
+    while(i < length)
+    {
+        if(state == UTF8_ACCEPT) {
+            // Skip ASCII a machine word at a time
+            while(i + sizeof(size_t) <= length)
+            {
+                size_t word;
+                memcpy(&word, input + i, sizeof(word));
+                if((word & SWAR_HIGHS) != 0) break;
+                i += sizeof(size_t);
+            }
+            if(i == length) break;
+            sequence_start = i;
+        }
+        state = utf8_step(state, (unsigned char)input[i]);
+        if(state == UTF8_REJECT) return sequence_start;
+        i++;
+    }
+    return state == UTF8_ACCEPT ? length : sequence_start;
+}
+
 json::reader::push_result json::reader::push_string(const char next)
 {
     const string_reader_enum state = this->get_state<string_reader_enum>();
@@ -239,6 +378,10 @@ json::reader::push_result json::reader::push_string(const char next)
         // Fall through deliberate
     case STRING_OPEN:
         assert(this->length() > 0);
+        if(this->utf8_validation && (this->utf8_state != UTF8_ACCEPT || (unsigned char)next >= 0x80)) {
+            this->utf8_state = utf8_step(this->utf8_state, (unsigned char)next);
+            if(this->utf8_state == UTF8_REJECT) return REJECTED;
+        }
         switch (next)
         {
         case '\\':
@@ -318,7 +461,8 @@ json::reader::push_result json::reader::push_array(const char next)
         }
         begin_reading_value:
         if(json::jtype::peek(next) == json::jtype::not_valid) return REJECTED;
-        this->sub_reader = new reader();
+        this->sub_reader = new reader(this->utf8_validation);
+        JSON_STATS_COUNT(SUB_READERS, 1);
         this->set_state(ARRAY_READING_VALUE);
         // Fall-through deliberate
     case ARRAY_READING_VALUE:
@@ -389,7 +533,8 @@ json::reader::push_result json::reader::push_object(const char next)
     case OBJECT_AWAITING_NEXT_LINE:
         if(std::isspace(next)) return WHITESPACE;
         if(next != '"') return REJECTED;
-        this->sub_reader = new kvp_reader();
+        this->sub_reader = new kvp_reader(this->utf8_validation);
+        JSON_STATS_COUNT(SUB_READERS, 1);
         #if DEBUG
         assert(
         #endif
@@ -634,6 +779,11 @@ json::reader::push_result json::kvp_reader::push(const char next)
     return reader::push(next);
 }
 
+bool json::kvp_reader::utf8_error() const
+{
+    return reader::utf8_error() || this->_key.utf8_error();
+}
+
 std::string json::kvp_reader::readout() const
 {
     return this->_key.readout() + ":" + reader::readout();
@@ -672,100 +822,447 @@ std::string json::parsing::read_digits(const char *input)
     return result;
 }
 
-std::string json::parsing::decode_string(const char *input)
+/*! \brief Values of ASCII hexadecimal digits, with 0xFF marking characters that are not hexadecimal digits */
+static const unsigned char HEX_TABLE[128] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 10, 11, 12, 13, 14, 15, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 10, 11, 12, 13, 14, 15, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/*! \brief Reads the four hexadecimal digits of a `\uXXXX` escape sequence
+ *
+ * @param input Pointer to the first hexadecimal digit
+ * @return The encoded UTF-16 code unit, or a negative value if the digits are not valid
+ */
+static long read_code_unit(const char *input)
 {
-    const char *index = input;
-    std::string result;
+    long result = 0;
+    for(size_t i = 0; i < 4; i++)
+    {
+        const unsigned char next = (unsigned char)input[i];
+        const unsigned char digit = next < 0x80 ? HEX_TABLE[next] : 0xFF;
+        if(digit == 0xFF) return -1;
+        result = (result << 4) | digit;
+    }
+    return result;
+}
+
+/*! \brief Encodes a code point as UTF-8
+ *
+ * @param code_point The code point to encode
+ * @param[out] buffer Storage for at least four bytes
+ * @return The number of bytes written to the buffer
+ */
+static size_t write_utf8(const unsigned long code_point, char *buffer)
+{
+    if(code_point < 0x80) {
+        buffer[0] = (char)code_point;
+        return 1;
+    } else if(code_point < 0x800) {
+        buffer[0] = (char)(0xC0 | (code_point >> 6));
+        buffer[1] = (char)(0x80 | (code_point & 0x3F));
+        return 2;
+    } else if(code_point < 0x10000) {
+        buffer[0] = (char)(0xE0 | (code_point >> 12));
+        buffer[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        buffer[2] = (char)(0x80 | (code_point & 0x3F));
+        return 3;
+    }
+    buffer[0] = (char)(0xF0 | (code_point >> 18));
+    buffer[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+    buffer[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+    buffer[3] = (char)(0x80 | (code_point & 0x3F));
+    return 4;
+}
+
+/*! \brief Decodes a single escape sequence
+ *
+ * @param index Pointer to the character following the reverse solidus
+ * @param[out] buffer Storage for at least four bytes of decoded UTF-8
+ * @param[out] length The number of bytes written to the buffer
+ * @return A pointer to the first character after the escape sequence
+ * \exception json::parsing_error Thrown if the escape sequence is not valid
+ */
+static const char* decode_escape(const char *index, char *buffer, size_t &length)
+{
+    length = 1;
+    switch (*index)
+    {
+    case '"':
+    case '\\':
+    case '/':
+        buffer[0] = *index;
+        break;
+    case 'b':
+        buffer[0] = '\b';
+        break;
+    case 'f':
+        buffer[0] = '\f';
+        break;
+    case 'n':
+        buffer[0] = '\n';
+        break;
+    case 'r':
+        buffer[0] = '\r';
+        break;
+    case 't':
+        buffer[0] = '\t';
+        break;
+    case 'u':
+    {
+        long code_point = read_code_unit(index + 1);
+        if(code_point < 0) throw json::parsing_error("Expected four hexadecimal digits");
+        index += 4;
+        if(code_point >= 0xD800 && code_point <= 0xDBFF && index[1] == '\\' && index[2] == 'u') {
+            // Combine a surrogate pair into a single code point
+            const long low = read_code_unit(index + 3);
+            if(low >= 0xDC00 && low <= 0xDFFF) {
+                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                index += 6;
+            }
+        }
+        // Unpaired surrogates cannot be represented in UTF-8
+        if(code_point >= 0xD800 && code_point <= 0xDFFF) code_point = 0xFFFD;
+        length = write_utf8((unsigned long)code_point, buffer);
+        break;
+    }
+    default:
+        throw json::parsing_error("Expected control character");
+    }
+    return index + 1;
+}
 
+const char* json::parsing::decode_string(const char *input, std::string &output)
+{
+    const char *index = input;
     if(*index != '"') throw json::parsing_error("Expecting opening quote");
     index++;
-    bool escaped = false;
+
     // Loop until the end quote is found
-    while(!(!escaped && *index == '"'))
+    while(true)
     {
-        if(escaped)
-        {
-            switch (*index)
-            {
-            case '"':
-            case '\\':
-            case '/':
-                result += *index;
-                break;
-            case 'b':
-                result += '\b';
-                break;
-            case 'f':
-                result += '\f';
-                break;
-            case 'n':
-                result += '\n';
-                break;
-            case 'r':
-                result += '\r';
-                break;
-            case 't':
-                result += '\t';
-                break;
-            case 'u':
-                // #todo Unicode support
-                index += 4;
-                break;
-            default:
-                throw json::parsing_error("Expected control character");
+        // Copy everything up to the next quote or escape in bulk
+        const size_t run = strcspn(index, "\"\\");
+        output.append(index, run);
+        index += run;
+
+        if(*index == '"') return index + 1;
+        if(EMPTY_STRING(index)) throw json::parsing_error("Expecting closing quote");
+        assert(*index == '\\');
+
+        char buffer[4];
+        size_t length;
+        index = decode_escape(index + 1, buffer, length);
+        output.append(buffer, length);
+    }
+}
+
+std::string json::parsing::decode_string(const char *input)
+{
+    std::string result;
+    json::parsing::decode_string(input, result);
+    return result;
+}
+
+/*! \brief Escape characters used when encoding ASCII characters
+ *
+ * A zero entry means the character can be copied as-is. Otherwise, the entry is the character that follows the reverse solidus, with `u` indicating a `\uXXXX` escape.
+ */
+static const char ESCAPE_TABLE[128] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '/',
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/*! \brief Finds the length of the leading run of characters that can be copied without escaping
+ *
+ * @param input The characters to scan
+ * @param length The number of characters to scan
+ * @param ascii_only When true, characters outside of the ASCII range end the run
+ * @return The number of characters that can be copied as-is
+ */
+static size_t clean_run_length(const char *input, const size_t length, const bool ascii_only)
+{
+    const size_t high_mask = ascii_only ? SWAR_HIGHS : 0;
+    size_t i = 0;
+    while(i + sizeof(size_t) <= length)
+    {
+        size_t word;
+        memcpy(&word, input + i, sizeof(word));
+        if((SWAR_HAS_LESS(word, 0x20) | SWAR_HAS_BYTE(word, '"') | SWAR_HAS_BYTE(word, '\\') | SWAR_HAS_BYTE(word, '/') | (word & high_mask)) != 0) break;
+        i += sizeof(size_t);
+    }
+    while(i < length)
+    {
+        const unsigned char next = (unsigned char)input[i];
+        if(next >= 0x80 ? ascii_only : ESCAPE_TABLE[next] != 0) break;
+        i++;
+    }
+    return i;
+}
+
+/*! \brief Appends a `\uXXXX` escape sequence to a string
+ *
+ * @param code_unit The UTF-16 code unit to encode
+ * @param[out] output The string to append to
+ */
+static void append_code_unit(const unsigned long code_unit, std::string &output)
+{
+    const char hex[] = "0123456789abcdef";
+    char escape[6] = { '\\', 'u', 0, 0, 0, 0 };
+    escape[2] = hex[(code_unit >> 12) & 0xF];
+    escape[3] = hex[(code_unit >> 8) & 0xF];
+    escape[4] = hex[(code_unit >> 4) & 0xF];
+    escape[5] = hex[code_unit & 0xF];
+    output.append(escape, sizeof(escape));
+}
+
+/*! \brief Reads a single UTF-8 encoded code point
+ *
+ * @param input The bytes to read from
+ * @param length The number of bytes available
+ * @param[out] code_point The decoded code point
+ * @return The number of bytes consumed, or zero if the input does not start with a valid UTF-8 sequence
+ */
+static size_t read_utf8(const unsigned char *input, const size_t length, unsigned long &code_point)
+{
+    size_t count;
+    unsigned long minimum;
+    if(input[0] < 0x80) {
+        code_point = input[0];
+        return 1;
+    } else if((input[0] & 0xE0) == 0xC0) {
+        count = 2;
+        minimum = 0x80;
+        code_point = input[0] & 0x1F;
+    } else if((input[0] & 0xF0) == 0xE0) {
+        count = 3;
+        minimum = 0x800;
+        code_point = input[0] & 0x0F;
+    } else if((input[0] & 0xF8) == 0xF0) {
+        count = 4;
+        minimum = 0x10000;
+        code_point = input[0] & 0x07;
+    } else {
+        return 0;
+    }
+    if(count > length) return 0;
+    for(size_t i = 1; i < count; i++)
+    {
+        if((input[i] & 0xC0) != 0x80) return 0;
+        code_point = (code_point << 6) | (input[i] & 0x3F);
+    }
+    if(code_point < minimum || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF)) return 0;
+    return count;
+}
+
+void json::parsing::encode_string(const char *input, const size_t length, std::string &output, const bool ascii_only)
+{
+    output.reserve(output.size() + length + 2);
+    output += '"';
+    size_t i = 0;
+    while(i < length)
+    {
+        // Copy the characters that do not need escaping in bulk
+        const size_t run = clean_run_length(input + i, length - i, ascii_only);
+        output.append(input + i, run);
+        i += run;
+        if(i == length) break;
+
+        const unsigned char next = (unsigned char)input[i];
+        if(next < 0x80) {
+            const char escape = ESCAPE_TABLE[next];
+            if(escape == 'u') {
+                append_code_unit(next, output);
+            } else {
+                output += '\\';
+                output += escape;
             }
-            escaped = false;
-        } else if(*index == '\\') {
-            escaped = true;
+            i++;
+            continue;
+        }
+
+        // Non-ASCII characters only stop the run in ASCII-only mode
+        assert(ascii_only);
+        unsigned long code_point;
+        size_t consumed = read_utf8((const unsigned char *)input + i, length - i, code_point);
+        if(consumed == 0) {
+            code_point = next;
+            consumed = 1;
+        }
+        if(code_point >= 0x10000) {
+            code_point -= 0x10000;
+            append_code_unit(0xD800 | (code_point >> 10), output);
+            append_code_unit(0xDC00 | (code_point & 0x3FF), output);
         } else {
-            result += *index;
+            append_code_unit(code_point, output);
         }
-        index++;
+        i += consumed;
     }
+    output += '"';
+}
+
+std::string json::parsing::encode_string(const char *input, const bool ascii_only)
+{
+    std::string result;
+    json::parsing::encode_string(input, strlen(input), result, ascii_only);
     return result;
 }
 
-std::string json::parsing::encode_string(const char *input)
+/*! \brief Copies a serialized string, checking its escape sequences
+ *
+ * @param[in,out] input Pointer to the opening quotation, advanced past the closing quotation on success
+ * @param[out] output Appended with the string as it is serialized
+ * @param validate_utf8 When true, the string must be valid UTF-8
+ * @return False if the string is not terminated, contains an invalid escape sequence or fails validation
+ */
+static bool compact_string(const char *&input, std::string &output, const bool validate_utf8)
 {
-    std::string result = "\"";
+    const char *index = input + 1;
+    while(true)
+    {
+        index += strcspn(index, "\"\\");
+        if(*index == '"') break;
+        if(*index == '\0') return false;
+        index++;
+        if(*index == 'u') {
+            for(size_t i = 1; i <= 4; i++) if(!is_hex_digit(index[i])) return false;
+            index += 5;
+        } else if(is_control_character(*index)) {
+            index++;
+        } else {
+            return false;
+        }
+    }
+    const size_t length = (size_t)(index - input) - 1;
+    if(validate_utf8 && json::parsing::validate_utf8(input + 1, length) != length) return false;
+    output.append(input, length + 2);
+    input = index + 1;
+    return true;
+}
 
-    while (!EMPTY_STRING(input))
+/*! \brief Copies a serialized value without insignificant whitespace, in a single pass
+ *
+ * \details Accepts well-formed JSON, which json::reader reads to the same result, in time linear in the length of the value. The reader feeds every character through one sub-reader per level of nesting and copies each nested value into its parent, which makes nested values quadratic. Input that is not accepted, including every error, is left to the reader so that its results and error reporting are unchanged.
+ * @param[in,out] input The start of the value, advanced to the character after the value on success
+ * @param[out] output Appended with the compacted value
+ * @param validate_utf8 When true, strings must be valid UTF-8
+ * @return False if the input was not accepted, in which case the output is incomplete
+ */
+static bool compact_value(const char *&input, std::string &output, const bool validate_utf8)
+{
+    // The closing characters of the containers being read
+    std::string closers;
+    const char *index = input;
+    while(true)
     {
-        switch (*input)
+        // Read a value, or open a container
+        switch (*index)
         {
+        case '{':
+        case '[':
+            output += *index;
+            closers += *index == '{' ? '}' : ']';
+            index = json::parsing::tlws(index + 1);
+            if(*index == closers[closers.size() - 1]) {
+                output += *index++;
+                closers.erase(closers.size() - 1);
+                break;
+            }
+            if(closers[closers.size() - 1] == '}') {
+                if(*index != '"' || !compact_string(index, output, validate_utf8)) return false;
+                index = json::parsing::tlws(index);
+                if(*index != ':') return false;
+                output += ':';
+                index = json::parsing::tlws(index + 1);
+            }
+            continue;
         case '"':
-        case '\\':
-        case '/':
-            result += "\\";
-            result += *input;
-            break;
-        case '\b':
-            result += "\\b";
-            break;
-        case '\f':
-            result += "\\f";
-            break;
-        case '\n':
-            result += "\\n";
+            if(!compact_string(index, output, validate_utf8)) return false;
             break;
-        case '\r':
-            result += "\\r";
-            break;
-        case '\t':
-            result += "\\t";
+        case 't':
+        case 'f':
+        case 'n':
+        {
+            const char *literal = *index == 't' ? "true" : *index == 'f' ? "false" : "null";
+            const size_t length = strlen(literal);
+            if(strncmp(index, literal, length) != 0) return false;
+            output.append(index, length);
+            index += length;
             break;
+        }
         default:
-            result += *input;
+        {
+            const char *start = index;
+            if(*index == '-') index++;
+            if(*index == '0') {
+                index++;
+            } else if(IS_DIGIT(*index)) {
+                while(IS_DIGIT(*index)) index++;
+            } else {
+                return false;
+            }
+            if(*index == '.') {
+                index++;
+                if(!IS_DIGIT(*index)) return false;
+                while(IS_DIGIT(*index)) index++;
+            }
+            if(*index == 'e' || *index == 'E') {
+                index++;
+                if(*index == '+' || *index == '-') index++;
+                if(!IS_DIGIT(*index)) return false;
+                while(IS_DIGIT(*index)) index++;
+            }
+            // The reader joins digits separated by whitespace, which is left to it
+            const char *next = json::parsing::tlws(index);
+            if(next != index && (IS_DIGIT(*next) || *next == '.' || *next == 'e' || *next == 'E')) return false;
+            output.append(start, (size_t)(index - start));
+        }
+        }
+
+        // Close the containers that end after the value, and move to the next value
+        while(true)
+        {
+            if(closers.empty()) {
+                input = index;
+                return true;
+            }
+            index = json::parsing::tlws(index);
+            const char closer = closers[closers.size() - 1];
+            if(*index == closer) {
+                output += *index++;
+                closers.erase(closers.size() - 1);
+                continue;
+            }
+            if(*index != ',') return false;
+            output += ',';
+            index = json::parsing::tlws(index + 1);
+            if(closer == '}') {
+                if(*index != '"' || !compact_string(index, output, validate_utf8)) return false;
+                index = json::parsing::tlws(index);
+                if(*index != ':') return false;
+                output += ':';
+                index = json::parsing::tlws(index + 1);
+            }
             break;
         }
-        input++;
     }
-    result += '\"';
-    return result;
 }
 
-json::parsing::parse_results json::parsing::parse(const char *input)
+json::parsing::parse_results json::parsing::parse(const char *input, const bool validate_utf8)
 {
+    JSON_STATS_SCOPE(PARSE);
+
     // Strip white space
     const char *index = json::parsing::tlws(input);
 
@@ -776,20 +1273,36 @@ json::parsing::parse_results json::parsing::parse(const char *input)
     json::parsing::parse_results result;
     result.type = json::jtype::not_valid;
 
+    // Well-formed values are copied directly
+    const char *end = index;
+    if(compact_value(end, result.value, validate_utf8)) {
+        result.type = json::jtype::peek(*index);
+        result.remainder = end;
+        JSON_STATS_COUNT_INPUT(end - input);
+        return result;
+    }
+    result.value.clear();
+
     // Initialize the reader
-    json::reader stream;
+    json::reader stream(validate_utf8);
 
     // Iterate
-    while(!EMPTY_STRING(input) && stream.push(*index) != json::reader::REJECTED)
+    while(!EMPTY_STRING(index) && stream.push(*index) != json::reader::REJECTED)
     {
         index++;
     }
 
+    // Locate the start of the offending sequence only once validation has failed
+    if(validate_utf8 && stream.utf8_error()) {
+        throw json::invalid_utf8(json::parsing::validate_utf8(input, (size_t)(index - input) + 1));
+    }
+
     if(stream.is_valid()) {
         result.value = stream.readout();
         result.type = stream.type();
     }
     result.remainder = index;
+    JSON_STATS_COUNT_INPUT(index - input);
 
     return result;
 }
@@ -816,7 +1329,7 @@ std::vector<std::string> json::parsing::parse_array(const char *input)
         if(parse_results.type == json::jtype::jstring) {
             result.push_back(json::parsing::decode_string(parse_results.value.c_str()));
         } else {
-            result.push_back(parse_results.value);
+            result.push_back(JSON_MOVE(parse_results.value));
         }
         index = json::parsing::tlws(parse_results.remainder);
         if (*index == ']') break;
@@ -827,213 +1340,5318 @@ std::vector<std::string> json::parsing::parse_array(const char *input)
     return result;
 }
 
-json::jobject::entry::operator int() const { return this->get_number<int>(INT_FORMAT); }
-json::jobject::entry::operator unsigned int() const { return this->get_number<unsigned int>(UINT_FORMAT); }
-json::jobject::entry::operator long() const { return this->get_number<long>(LONG_FORMAT); }
-json::jobject::entry::operator unsigned long() const { return this->get_number<unsigned long>(ULONG_FORMAT); }
-json::jobject::entry::operator char() const { return this->get_number<char>(CHAR_FORMAT); }
-json::jobject::entry::operator float() const { return this->get_number<float>(FLOAT_FORMAT); }
-json::jobject::entry::operator double() const { return this->get_number<double>(DOUBLE_FORMAT); }
-
-json::jobject::entry::operator std::vector<int>() const { return this->get_number_array<int>(INT_FORMAT); }
-json::jobject::entry::operator std::vector<unsigned int>() const { return this->get_number_array<unsigned int>(UINT_FORMAT); }
-json::jobject::entry::operator std::vector<long>() const { return this->get_number_array<long>(LONG_FORMAT); }
-json::jobject::entry::operator std::vector<unsigned long>() const { return this->get_number_array<unsigned long>(ULONG_FORMAT); }
-json::jobject::entry::operator std::vector<char>() const { return this->get_number_array<char>(CHAR_FORMAT); }
-json::jobject::entry::operator std::vector<float>() const { return this->get_number_array<float>(FLOAT_FORMAT); }
-json::jobject::entry::operator std::vector<double>() const { return this->get_number_array<double>(DOUBLE_FORMAT); }
-
-void json::jobject::proxy::set_array(const std::vector<std::string> &values, const bool wrap)
+/*! \brief Skips a serialized string
+ *
+ * @param input Pointer to the opening quotation of the string
+ * @return A pointer to the first character after the closing quotation, or `NULL` if the string is not terminated
+ */
+static const char* skip_string(const char *input)
 {
-    std::string value = "[";
-    for (size_t i = 0; i < values.size(); i++)
+    assert(*input == '"');
+    const char *index = input + 1;
+    while(true)
     {
-        if (wrap) value += json::parsing::encode_string(values[i].c_str()) + ",";
-        else value += values[i] + ",";
+        index += strcspn(index, "\"\\");
+        switch (*index)
+        {
+        case '"':
+            return index + 1;
+        case '\\':
+            if(index[1] == '\0') return NULL;
+            index += 2;
+            break;
+        default:
+            return NULL;
+        }
     }
-    if(values.size() > 0) value.erase(value.size() - 1, 1);
-    value += "]";
-    this->sink.set(key, value);
 }
 
-json::jobject json::jobject::parse(const char *input)
+/*! \brief Skips a serialized value
+ *
+ * \details Objects and arrays are skipped by jumping between brackets and quotations without examining the characters in between
+ * @param input Pointer to the value, optionally preceded by white space
+ * @return A pointer to the first character after the value, or `NULL` if the value is not terminated
+ */
+static const char* skip_value(const char *input)
 {
-    const char error[] = "Input is not a valid object";
     const char *index = json::parsing::tlws(input);
-    json::jobject result;
-    json::reader stream;
     switch (*index)
     {
+    case '"':
+        return skip_string(index);
     case '{':
-        // Result is already an object
-        break;
     case '[':
-        result = json::jobject(true);
-        break;
+    {
+        size_t depth = 0;
+        do
+        {
+            switch (*index)
+            {
+            case '"':
+                index = skip_string(index);
+                if(index == NULL) return NULL;
+                break;
+            case '{':
+            case '[':
+                depth++;
+                index++;
+                break;
+            case '}':
+            case ']':
+                depth--;
+                index++;
+                break;
+            default:
+                return NULL;
+            }
+            if(depth > 0) index += strcspn(index, "\"{}[]");
+        } while (depth > 0);
+        return index;
+    }
+    case '\0':
+        return NULL;
     default:
-        throw json::parsing_error(error);
-        break;
+        return index + strcspn(index, ",]} \t\r\n");
     }
-    index++;
-    SKIP_WHITE_SPACE(index);
-    if (EMPTY_STRING(index)) throw json::parsing_error(error);
+}
 
-    while (!EMPTY_STRING(index) && !END_CHARACTER_ENCOUNTERED(result, index))
-    {
-        // Get key
-        kvp entry;
+/*! \brief Cursor for reading the decoded bytes of a serialized string without allocating */
+struct string_cursor
+{
+    /*! \brief The next character of the serialized string */
+    const char *index;
 
-        if(!result.is_array()) {
-            json::parsing::parse_results key = json::parsing::parse(index);
-            if (key.type != json::jtype::jstring || key.value == "") throw json::parsing_error(error);
-            entry.first = json::parsing::decode_string(key.value.c_str());
-            index = key.remainder;
+    /*! \brief The decoded bytes of the most recent escape sequence */
+    char buffer[4];
 
-            // Get value
-            SKIP_WHITE_SPACE(index);
-            if (*index != ':') throw json::parsing_error(error);
-            index++;
-        }
+    /*! \brief The number of decoded bytes in the buffer */
+    size_t length;
 
-        SKIP_WHITE_SPACE(index);
-        json::parsing::parse_results value = json::parsing::parse(index);
-        if (value.type == json::jtype::not_valid) throw json::parsing_error(error);
-        entry.second = value.value;
-        index = value.remainder;
+    /*! \brief The next byte to be read from the buffer */
+    size_t position;
 
-        // Clean up
-        SKIP_WHITE_SPACE(index);
-        if (*index != ',' && !END_CHARACTER_ENCOUNTERED(result, index)) throw json::parsing_error(error);
-        if (*index == ',') index++;
-        result += entry;
+    /*! \brief Constructor
+     *
+     * @param input Pointer to the opening quotation of the string
+     */
+    string_cursor(const char *input) : index(input + 1), length(0), position(0) { }
 
+    /*! \brief Reads the next decoded byte
+     *
+     * @return The next byte, -1 once the closing quotation is reached, or -2 if the string is not terminated
+     */
+    int next()
+    {
+        if(this->position < this->length) return (unsigned char)this->buffer[this->position++];
+        switch (*this->index)
+        {
+        case '"':
+            this->index++;
+            return -1;
+        case '\0':
+            return -2;
+        case '\\':
+            this->index = decode_escape(this->index + 1, this->buffer, this->length);
+            this->position = 1;
+            return (unsigned char)this->buffer[0];
+        default:
+            return (unsigned char)*this->index++;
+        }
     }
-    if (EMPTY_STRING(index) || !END_CHARACTER_ENCOUNTERED(result, index)) throw json::parsing_error(error);
-    index++;
-    return result;
-}
+};
 
-json::key_list_t json::jobject::list_keys() const
+/*! \brief Compares two serialized strings by their decoded content
+ *
+ * @param[in,out] lhs Pointer to the opening quotation of the first string, advanced past the closing quotation when equal
+ * @param[in,out] rhs Pointer to the opening quotation of the second string, advanced past the closing quotation when equal
+ * @return True if the decoded strings are identical
+ */
+static bool strings_equal(const char *&lhs, const char *&rhs)
 {
-    // Initialize the result
-    key_list_t result;
-
-    // Return an empty list if the object is an array
-    if(this->is_array()) return result;
+    // Fast path for strings that are byte-for-byte identical and contain no escapes
+    const char *left = lhs + 1;
+    const char *right = rhs + 1;
+    while(*left == *right && *left != '"' && *left != '\\' && *left != '\0')
+    {
+        left++;
+        right++;
+    }
+    if(*left == '"' && *right == '"') {
+        lhs = left + 1;
+        rhs = right + 1;
+        return true;
+    }
 
-    for(size_t i = 0; i < this->data.size(); i++)
+    // Compare the decoded bytes
+    string_cursor left_cursor(lhs);
+    string_cursor right_cursor(rhs);
+    while(true)
     {
-        result.push_back(this->data.at(i).first);
+        const int a = left_cursor.next();
+        const int b = right_cursor.next();
+        if(a != b) return false;
+        if(a == -1) break;
+        if(a < 0) return false;
     }
-    return result;
+    lhs = left_cursor.index;
+    rhs = right_cursor.index;
+    return true;
 }
 
-void json::jobject::set(const std::string &key, const std::string &value)
+/*! \brief Canonical view of a serialized number
+ *
+ * The value of the number is `0.D x 10^exponent`, where `D` are the significant digits with leading and trailing zeros removed
+ */
+struct number_view
 {
-    if(this->array_flag) throw json::invalid_key(key);
-    for (size_t i = 0; i < this->size(); i++)
+    /*! \brief Flag for negative numbers */
+    bool negative;
+
+    /*! \brief Pointer to the integer digits */
+    const char *integer;
+
+    /*! \brief The number of integer digits */
+    size_t integer_length;
+
+    /*! \brief Pointer to the fraction digits */
+    const char *fraction;
+
+    /*! \brief The number of leading zeros across the integer and fraction digits */
+    size_t leading;
+
+    /*! \brief The number of significant digits */
+    size_t significant;
+
+    /*! \brief The decimal exponent of the first significant digit */
+    long exponent;
+
+    /*! \brief Returns a significant digit
+     *
+     * @param i The index of the significant digit
+     */
+    char digit(const size_t i) const
     {
-        if (this->data.at(i).first == key)
+        const size_t k = this->leading + i;
+        return k < this->integer_length ? this->integer[k] : this->fraction[k - this->integer_length];
+    }
+};
+
+/*! \brief Reads a serialized number into its canonical form
+ *
+ * @param input Pointer to the number
+ * @param[out] number The canonical form of the number
+ * @return A pointer to the first character after the number
+ */
+static const char* read_number(const char *input, number_view &number)
+{
+    const char *index = input;
+    number.negative = *index == '-';
+    if(number.negative) index++;
+    number.integer = index;
+    while(IS_DIGIT(*index)) index++;
+    number.integer_length = (size_t)(index - number.integer);
+    number.fraction = index;
+    size_t fraction_length = 0;
+    if(*index == '.') {
+        index++;
+        number.fraction = index;
+        while(IS_DIGIT(*index)) index++;
+        fraction_length = (size_t)(index - number.fraction);
+    }
+    long exponent = 0;
+    if(*index == 'e' || *index == 'E') {
+        index++;
+        const bool negative_exponent = *index == '-';
+        if(*index == '-' || *index == '+') index++;
+        while(IS_DIGIT(*index))
         {
-            this->data.at(i).second = value;
-            return;
+            // Saturate rather than overflow on absurd exponents
+            if(exponent < 100000000L) exponent = exponent * 10 + (*index - '0');
+            index++;
         }
+        if(negative_exponent) exponent = -exponent;
+    }
+
+    // Strip leading and trailing zeros
+    const size_t total = number.integer_length + fraction_length;
+    number.leading = 0;
+    number.significant = total;
+    while(number.significant > 0 && number.digit(0) == '0')
+    {
+        number.leading++;
+        number.significant--;
     }
-    kvp entry;
-    entry.first = key;
-    entry.second = value;
-    this->data.push_back(entry);
+    while(number.significant > 0 && number.digit(number.significant - 1) == '0') number.significant--;
+    number.exponent = exponent + (long)number.integer_length - (long)number.leading;
+    return index;
 }
 
-void json::jobject::remove(const std::string &key)
+/*! \brief Compares two serialized numbers by value
+ *
+ * @param[in,out] lhs Pointer to the first number, advanced past the number
+ * @param[in,out] rhs Pointer to the second number, advanced past the number
+ * @return True if the numbers represent the same value
+ */
+static bool numbers_equal(const char *&lhs, const char *&rhs)
 {
-    for (size_t i = 0; i < this->size(); i++)
+    number_view left, right;
+    lhs = read_number(lhs, left);
+    rhs = read_number(rhs, right);
+    if(left.significant == 0 || right.significant == 0) return left.significant == right.significant;
+    if(left.negative != right.negative || left.exponent != right.exponent || left.significant != right.significant) return false;
+    for(size_t i = 0; i < left.significant; i++)
     {
-        if (this->data.at(i).first == key)
-        {
-            this->remove(i);
-        }
+        if(left.digit(i) != right.digit(i)) return false;
     }
+    return true;
 }
 
-json::jobject::operator std::string() const
+/*! \brief Locates the value of an object member
+ *
+ * @param key Pointer to the opening quotation of the member's key
+ * @return A pointer to the member's value, or `NULL` if the member is malformed
+ */
+static const char* member_value(const char *key)
 {
-    if (is_array()) {
-        if (this->size() == 0) return "[]";
-        std::string result = "[";
-        for (size_t i = 0; i < this->size(); i++)
-        {
-            result += this->data.at(i).second + ",";
-        }
-        result.erase(result.size() - 1, 1);
-        result += "]";
-        return result;
-    } else {
-        if (this->size() == 0) return "{}";
-        std::string result = "{";
-        for (size_t i = 0; i < this->size(); i++)
-        {
-            result += json::parsing::encode_string(this->data.at(i).first.c_str()) + ":" + this->data.at(i).second + ",";
-        }
-        result.erase(result.size() - 1, 1);
-        result += "}";
-        return result;
+    const char *index = skip_string(key);
+    if(index == NULL) return NULL;
+    index = json::parsing::tlws(index);
+    if(*index != ':') return NULL;
+    return json::parsing::tlws(index + 1);
+}
+
+/*! \brief Moves from the end of a value to the next element of an object or array
+ *
+ * @param value_end Pointer to the first character after a value
+ * @return A pointer to the next element, or to the closing bracket if there are no more elements
+ */
+static const char* next_element(const char *value_end)
+{
+    const char *index = json::parsing::tlws(value_end);
+    if(*index == ',') return json::parsing::tlws(index + 1);
+    return index;
+}
+
+static bool values_equal(const char *&lhs, const char *&rhs, const bool ignore_order);
+
+/*! \brief Compares two serialized arrays element by element
+ *
+ * @see values_equal
+ */
+static bool arrays_equal(const char *&lhs, const char *&rhs, const bool ignore_order)
+{
+    lhs = json::parsing::tlws(lhs + 1);
+    rhs = json::parsing::tlws(rhs + 1);
+    while(*lhs != ']' && *rhs != ']')
+    {
+        if(!values_equal(lhs, rhs, ignore_order)) return false;
+        lhs = next_element(lhs);
+        rhs = next_element(rhs);
     }
+    if(*lhs != ']' || *rhs != ']') return false;
+    lhs++;
+    rhs++;
+    return true;
 }
 
-std::string json::jobject::pretty(unsigned int indent_level) const
+static uint64_t hash_serialized_string(const char *&input);
+
+/*! \brief Number of members up to which objects_equal tracks matched members in a bitmap on the stack and searches them linearly */
+#define MATCH_BITMAP_MEMBERS 256
+
+/*! \brief Tests a bit of a bitmap of 64-bit words */
+#define BIT_SET(bitmap, position) (((bitmap)[(position) / 64] & ((uint64_t)1 << ((position) % 64))) != 0)
+
+/*! \brief Sets a bit of a bitmap of 64-bit words */
+#define SET_BIT(bitmap, position) ((bitmap)[(position) / 64] |= (uint64_t)1 << ((position) % 64))
+
+/*! \brief A member of an object indexed by the hash of its key, used by objects_equal for large objects */
+struct member_entry
 {
-    std::string result = "";
-    for(unsigned int i = 0; i < indent_level; i++) result += "\t";
-    if (is_array()) {
-        if(this->size() == 0) {
-            result += "[]";
-            return result;
-        }
-        result += "[\n";
-        for (size_t i = 0; i < this->size(); i++)
+    /*! \brief The hash of the decoded key */
+    uint64_t hash;
+
+    /*! \brief Pointer to the opening quotation of the key */
+    const char *key;
+
+    /*! \brief The position of the member in its object */
+    size_t position;
+
+    /*! \brief Orders entries by the hash of their key */
+    bool operator<(const member_entry &other) const { return this->hash < other.hash; }
+};
+
+/*! \brief Compares a member of one object with a member of another
+ *
+ * @param key Pointer to the key of the first member
+ * @param value Pointer to the value of the first member
+ * @param candidate Pointer to the key of the second member
+ * @param ignore_order When true, the order of object members is ignored
+ * @param[out] end Set past the value of the first member when the members are equal
+ * @param[out] candidate_end Set past the value of the second member when the members are equal
+ * @return True if both the keys and the values are equal
+ */
+static bool members_equal(const char *key, const char *value, const char *candidate, const bool ignore_order, const char *&end, const char *&candidate_end)
+{
+    const char *candidate_value = member_value(candidate);
+    if(!strings_equal(key, candidate) || !values_equal(value, candidate_value, ignore_order)) return false;
+    end = value;
+    candidate_end = candidate_value;
+    return true;
+}
+
+/*! \brief Compares two serialized objects
+ *
+ * \details When the order of the members is ignored, each member of the first object is first compared with the member following the most recent match, so that identically ordered objects are compared in a single pass. Otherwise, objects of up to #MATCH_BITMAP_MEMBERS members are searched linearly, and larger objects through an index of their keys sorted by hash.
+ * @see values_equal
+ */
+static bool objects_equal(const char *&lhs, const char *&rhs, const bool ignore_order)
+{
+    lhs = json::parsing::tlws(lhs + 1);
+    rhs = json::parsing::tlws(rhs + 1);
+
+    if(!ignore_order) {
+        while(*lhs == '"' && *rhs == '"')
         {
-            switch(json::jtype::peek(*this->data.at(i).second.c_str())) {
-                case json::jtype::jarray:
-                case json::jtype::jobject:
-                    result += json::jobject::parse(this->data.at(i).second).pretty(indent_level + 1);
+            if(!strings_equal(lhs, rhs)) return false;
+            lhs = json::parsing::tlws(lhs);
+            rhs = json::parsing::tlws(rhs);
+            if(*lhs != ':' || *rhs != ':') return false;
+            lhs = json::parsing::tlws(lhs + 1);
+            rhs = json::parsing::tlws(rhs + 1);
+            if(!values_equal(lhs, rhs, ignore_order)) return false;
+            lhs = next_element(lhs);
+            rhs = next_element(rhs);
+        }
+        if(*lhs != '}' || *rhs != '}') return false;
+        lhs++;
+        rhs++;
+        return true;
+    }
+
+    // Count the members of the second object and find its end
+    const char *rhs_first = rhs;
+    size_t rhs_count = 0;
+    while(*rhs == '"')
+    {
+        const char *value = member_value(rhs);
+        if(value == NULL) return false;
+        const char *end = skip_value(value);
+        if(end == NULL) return false;
+        rhs = next_element(end);
+        rhs_count++;
+    }
+    if(*rhs != '}') return false;
+    const char *rhs_end = rhs + 1;
+
+    // Match each member of the first object with an unused member of the second, so that duplicated keys are compared as a multiset like json::parsing::hash does
+    // Large objects need no bitmap while their members are matched in order, as exactly those before the hint are used
+    uint64_t bitmap[MATCH_BITMAP_MEMBERS / 64] = { 0 };
+    std::vector<uint64_t> large_bitmap;
+    uint64_t *used = rhs_count <= MATCH_BITMAP_MEMBERS ? bitmap : NULL;
+    std::vector<member_entry> index;
+
+    size_t lhs_count = 0;
+    const char *hint = rhs_first;
+    size_t hint_position = 0;
+    while(*lhs == '"')
+    {
+        if(++lhs_count > rhs_count) return false;
+        const char *lhs_value = member_value(lhs);
+        if(lhs_value == NULL) return false;
+
+        const char *lhs_end = NULL;
+        const char *match_end = NULL;
+        size_t match_position = 0;
+        if(*hint == '"' && (used == NULL || !BIT_SET(used, hint_position)) && members_equal(lhs, lhs_value, hint, ignore_order, lhs_end, match_end)) {
+            match_position = hint_position;
+        } else if(rhs_count <= MATCH_BITMAP_MEMBERS) {
+            const char *candidate = rhs_first;
+            for(size_t position = 0; position < rhs_count; position++)
+            {
+                if(!BIT_SET(used, position) && members_equal(lhs, lhs_value, candidate, ignore_order, lhs_end, match_end)) {
+                    match_position = position;
                     break;
-                default:
-                    for(unsigned int j = 0; j < indent_level + 1; j++) result += "\t";
-                    result += this->data.at(i).second;
+                }
+                candidate = next_element(skip_value(member_value(candidate)));
+            }
+        } else {
+            if(used == NULL) {
+                large_bitmap.resize((rhs_count + 63) / 64, 0);
+                used = &large_bitmap[0];
+                for(size_t position = 0; position < hint_position; position++) SET_BIT(used, position);
+                index.reserve(rhs_count);
+                const char *candidate = rhs_first;
+                for(size_t position = 0; position < rhs_count; position++)
+                {
+                    member_entry entry;
+                    entry.key = candidate;
+                    entry.position = position;
+                    const char *key_end = candidate;
+                    entry.hash = hash_serialized_string(key_end);
+                    index.push_back(entry);
+                    candidate = next_element(skip_value(member_value(candidate)));
+                }
+                std::sort(index.begin(), index.end());
+            }
+            member_entry wanted;
+            const char *key_end = lhs;
+            wanted.hash = hash_serialized_string(key_end);
+            for(std::vector<member_entry>::const_iterator it = std::lower_bound(index.begin(), index.end(), wanted); it != index.end() && it->hash == wanted.hash; ++it)
+            {
+                if(!BIT_SET(used, it->position) && members_equal(lhs, lhs_value, it->key, ignore_order, lhs_end, match_end)) {
+                    match_position = it->position;
                     break;
+                }
             }
-
-            result += ",\n";
         }
-        result.erase(result.size() - 2, 1);
-        for(unsigned int i = 0; i < indent_level; i++) result += "\t";
-        result += "]";
-    } else {
-        if(this->size() == 0) {
-            result += "{}";
-            return result;
+        if(lhs_end == NULL) return false;
+        if(used != NULL) SET_BIT(used, match_position);
+        hint = next_element(match_end);
+        hint_position = match_position + 1;
+        lhs = next_element(lhs_end);
+    }
+    if(*lhs != '}' || lhs_count != rhs_count) return false;
+    lhs++;
+    rhs = rhs_end;
+    return true;
+}
+
+/*! \brief Compares two serialized values structurally
+ *
+ * @param[in,out] lhs Pointer to the first value, advanced past the value when the values are equal
+ * @param[in,out] rhs Pointer to the second value, advanced past the value when the values are equal
+ * @param ignore_order When true, the order of object members is ignored
+ * @return True if the values are structurally equal
+ */
+static bool values_equal(const char *&lhs, const char *&rhs, const bool ignore_order)
+{
+    lhs = json::parsing::tlws(lhs);
+    rhs = json::parsing::tlws(rhs);
+    const json::jtype::jtype type = json::jtype::peek(*lhs);
+    if(type != json::jtype::peek(*rhs)) return false;
+    switch (type)
+    {
+    case json::jtype::jstring:
+        return strings_equal(lhs, rhs);
+    case json::jtype::jnumber:
+        return numbers_equal(lhs, rhs);
+    case json::jtype::jarray:
+        return arrays_equal(lhs, rhs, ignore_order);
+    case json::jtype::jobject:
+        return objects_equal(lhs, rhs, ignore_order);
+    case json::jtype::jbool:
+    case json::jtype::jnull:
+    {
+        const size_t length = *lhs == 'f' ? 5 : 4;
+        if(strncmp(lhs, rhs, length) != 0) return false;
+        lhs += length;
+        rhs += length;
+        return true;
+    }
+    case json::jtype::not_valid:
+        return false;
+    }
+    return false;
+}
+
+bool json::parsing::equal(const char *lhs, const char *rhs, const bool ignore_order)
+{
+    // Invalid escape sequences are only detected while decoding
+    try {
+        return values_equal(lhs, rhs, ignore_order);
+    } catch(const json::parsing_error &) {
+        return false;
+    }
+}
+
+bool json::jobject::equals(const jobject &other, const bool ignore_order) const
+{
+    if(this->array_flag != other.array_flag || this->size() != other.size()) return false;
+    const bool ordered = this->array_flag || !ignore_order;
+    for(size_t i = 0; i < this->size(); i++)
+    {
+        // Try the same position first so that identically ordered objects are compared in a single pass, then the key index
+        size_t match = i;
+        if(this->data[i].first != other.data[i].first) {
+            if(ordered) return false;
+            match = other.find_key(this->data[i].first);
+            if(match == other.size()) return false;
         }
-        result += "{\n";
-        for (size_t i = 0; i < this->size(); i++)
+        if(!json::parsing::equal(this->data[i].second.c_str(), other.data[match].second.c_str(), ignore_order)) return false;
+    }
+    return true;
+}
+
+/*! \brief Reads the next reference token of a JSON Pointer
+ *
+ * @param pointer Pointer to the solidus that starts the token
+ * @param[out] token The unescaped token
+ * @return A pointer to the solidus of the next token, or to the end of the pointer
+ * \exception std::invalid_argument Thrown if the token contains an invalid escape sequence
+ */
+static const char* read_pointer_token(const char *pointer, std::string &token)
+{
+    assert(*pointer == '/');
+    token.clear();
+    const char *index = pointer + 1;
+    while(true)
+    {
+        const size_t run = strcspn(index, "/~");
+        token.append(index, run);
+        index += run;
+        if(*index != '~') return index;
+        switch (index[1])
         {
-            for(unsigned int j = 0; j < indent_level + 1; j++) result += "\t";
-            result += "\"" + this->data.at(i).first + "\": ";
-            switch(json::jtype::peek(*this->data.at(i).second.c_str())) {
-                case json::jtype::jarray:
-                case json::jtype::jobject:
-                    result += std::string(json::parsing::tlws(json::jobject::parse(this->data.at(i).second).pretty(indent_level + 1).c_str()));
-                    break;
-                default:
-                    result += this->data.at(i).second;
+        case '0':
+            token += '~';
+            break;
+        case '1':
+            token += '/';
+            break;
+        default:
+            throw std::invalid_argument("Invalid escape sequence in JSON pointer");
+        }
+        index += 2;
+    }
+}
+
+/*! \brief Reads a JSON Pointer reference token as an array index
+ *
+ * @param token The reference token
+ * @param[out] index The array index
+ * @return True if the token is a valid array index
+ */
+static bool read_pointer_index(const std::string &token, size_t &index)
+{
+    if(token.empty() || token.size() > 19 || (token[0] == '0' && token.size() > 1)) return false;
+    index = 0;
+    for(size_t i = 0; i < token.size(); i++)
+    {
+        if(!IS_DIGIT(token[i])) return false;
+        index = index * 10 + (size_t)(token[i] - '0');
+    }
+    return true;
+}
+
+/*! \brief Compares a serialized key with decoded characters
+ *
+ * @param key Pointer to the opening quotation of the key
+ * @param input The decoded characters
+ * @param length The number of decoded characters
+ */
+static bool key_equals(const char *key, const char *input, const size_t length)
+{
+    string_cursor cursor(key);
+    for(size_t i = 0; i < length; i++)
+    {
+        if(cursor.next() != (unsigned char)input[i]) return false;
+    }
+    return cursor.next() == -1;
+}
+
+/*! \brief Resolves the remaining reference tokens of a JSON Pointer against a serialized value
+ *
+ * @param value Pointer to the serialized value
+ * @param pointer The remaining reference tokens
+ * @param token Storage reused for the reference tokens
+ * @return A pointer to the value the pointer refers to, or `NULL` if there is no such value
+ */
+static const char* resolve_pointer(const char *value, const char *pointer, std::string &token)
+{
+    while(*pointer != '\0')
+    {
+        pointer = read_pointer_token(pointer, token);
+        value = json::parsing::tlws(value);
+        const char *next = NULL;
+        if(*value == '{') {
+            const char *member = json::parsing::tlws(value + 1);
+            while(*member == '"')
+            {
+                const char *member_start = member_value(member);
+                if(member_start == NULL) return NULL;
+                if(key_equals(member, token.data(), token.size())) {
+                    next = member_start;
                     break;
+                }
+                const char *member_end = skip_value(member_start);
+                if(member_end == NULL) return NULL;
+                member = next_element(member_end);
             }
-
-            result += ",\n";
+        } else if(*value == '[') {
+            size_t index;
+            if(!read_pointer_index(token, index)) return NULL;
+            const char *element = json::parsing::tlws(value + 1);
+            for(size_t i = 0; i < index && element != NULL && *element != ']'; i++)
+            {
+                element = skip_value(element);
+                if(element != NULL) element = next_element(element);
+            }
+            if(element != NULL && *element != ']' && *element != '\0') next = element;
         }
-        result.erase(result.size() - 2, 1);
-        for(unsigned int i = 0; i < indent_level; i++) result += "\t";
-        result += "}";
+        if(next == NULL) return NULL;
+        value = next;
     }
-    return result;
-}
\ No newline at end of file
+    return json::parsing::tlws(value);
+}
+
+/*! \brief Copies the serialized value a JSON Pointer refers to
+ *
+ * @param value Pointer to the serialized value the remaining tokens are resolved against
+ * @param rest The remaining reference tokens
+ * @param pointer The complete pointer, used when reporting errors
+ * @param token Storage reused for the reference tokens
+ */
+static std::string copy_pointer_target(const char *value, const char *rest, const std::string &pointer, std::string &token)
+{
+    const char *start = resolve_pointer(value, rest, token);
+    const char *end = start == NULL ? NULL : skip_value(start);
+    if(end == NULL) throw json::invalid_key(pointer);
+    return std::string(start, end);
+}
+
+std::string json::parsing::at_pointer(const char *input, const std::string &pointer)
+{
+    if(!pointer.empty() && pointer[0] != '/') throw std::invalid_argument("JSON pointer must be empty or start with '/'");
+    std::string token;
+    return copy_pointer_target(input, pointer.c_str(), pointer, token);
+}
+
+/*! \brief Finds the entry of an object or array named by a JSON Pointer reference token
+ *
+ * @param data The entries of the object or array
+ * @param array_flag True if the entries belong to an array
+ * @param token The reference token
+ * @return The index of the entry, or the number of entries if there is no such entry
+ */
+static size_t find_pointer_entry(const std::vector<json::kvp> &data, const bool array_flag, const std::string &token)
+{
+    if(array_flag) {
+        size_t index;
+        return read_pointer_index(token, index) && index < data.size() ? index : data.size();
+    }
+    for(size_t i = 0; i < data.size(); i++) if(data[i].first == token) return i;
+    return data.size();
+}
+
+/*! \brief Copies the serialized value a non-empty JSON Pointer refers to within an object or array
+ *
+ * @see find_pointer_entry
+ * \exception json::invalid_key Thrown if the pointer does not refer to a value
+ * \exception std::invalid_argument Thrown if the pointer is malformed
+ */
+static std::string pointer_target(const std::vector<json::kvp> &data, const bool array_flag, const std::string &pointer)
+{
+    if(pointer.empty() || pointer[0] != '/') throw std::invalid_argument("JSON pointer must be empty or start with '/'");
+
+    // The first token selects an entry, and the rest of the path is resolved within its serialized value
+    std::string token;
+    const char *rest = read_pointer_token(pointer.c_str(), token);
+    const size_t entry = find_pointer_entry(data, array_flag, token);
+    if(entry == data.size()) throw json::invalid_key(pointer);
+    if(*rest == '\0') return data[entry].second;
+    return copy_pointer_target(data[entry].second.c_str(), rest, pointer, token);
+}
+
+json::jobject::const_value json::jobject::at_pointer(const std::string &pointer) const
+{
+    if(pointer.empty()) return const_value(this->as_string());
+    return const_value(pointer_target(this->data, this->array_flag, pointer));
+}
+
+/*! \brief The location of a member or element within a serialized object or array */
+struct pointer_slot
+{
+    /*! \brief The start of the existing value, or `NULL` if there is none */
+    const char *value;
+
+    /*! \brief The end of the existing value */
+    const char *value_end;
+
+    /*! \brief The span to erase when removing the member or element, including one separator */
+    const char *erase_begin;
+
+    /*! \brief The end of the span to erase */
+    const char *erase_end;
+
+    /*! \brief Where a new member or element is inserted, or `NULL` if the location cannot hold one */
+    const char *insert;
+
+    /*! \brief True if a separator precedes the inserted text, false if it follows */
+    bool separator_before;
+
+    /*! \brief True if the object or array has no entries */
+    bool empty;
+
+    /*! \brief True if the container is an object, false if it is an array */
+    bool object;
+};
+
+/*! \brief Locates a member or element within a serialized object or array
+ *
+ * @param container Pointer to the opening bracket of the object or array
+ * @param token The reference token naming the member or element
+ * @param[out] slot The location of the member or element
+ * \exception json::parsing_error Thrown if the container is malformed
+ */
+static void locate_slot(const char *container, const std::string &token, pointer_slot &slot)
+{
+    slot.value = NULL;
+    slot.insert = NULL;
+    slot.separator_before = true;
+    slot.object = *container == '{';
+    const bool object = slot.object;
+    size_t index = 0;
+    const bool append = !object && token == "-";
+    if(!object && !append && !read_pointer_index(token, index)) return;
+
+    const char *previous_end = NULL;
+    const char *entry = json::parsing::tlws(container + 1);
+    size_t position = 0;
+    for(; *entry != '}' && *entry != ']'; position++)
+    {
+        if(object && *entry != '"') throw json::parsing_error("Input is not a valid object");
+        const char *value = object ? member_value(entry) : entry;
+        const char *end = value == NULL ? NULL : skip_value(value);
+        if(end == NULL || end == value) throw json::parsing_error("Input is not a valid value");
+        if(object ? key_equals(entry, token.data(), token.size()) : !append && position == index) {
+            slot.value = value;
+            slot.value_end = end;
+            const char *after = json::parsing::tlws(end);
+            if(*after == ',') {
+                slot.erase_begin = entry;
+                slot.erase_end = json::parsing::tlws(after + 1);
+            } else {
+                slot.erase_begin = previous_end == NULL ? entry : previous_end;
+                slot.erase_end = end;
+            }
+            slot.insert = entry;
+            slot.separator_before = false;
+            slot.empty = false;
+            return;
+        }
+        previous_end = end;
+        entry = next_element(end);
+        if(*entry == '\0') throw json::parsing_error("Input is not terminated");
+    }
+
+    // New members are added at the end, and so are elements whose index is one past the last element
+    if(object || append || index == position) {
+        slot.empty = position == 0;
+        slot.insert = entry;
+    }
+}
+
+/*! \brief Records the changes made by a JSON Patch so that they can be undone */
+struct patch_journal
+{
+    /*! \brief The kinds of changes */
+    enum action
+    {
+        ENTRY_CHANGED,
+        TEXT_SPLICED,
+        ENTRY_INSERTED,
+        ENTRY_ERASED,
+        DOCUMENT_REPLACED
+    };
+
+    /*! \brief A single change */
+    struct record
+    {
+        /*! \brief The kind of change */
+        action type;
+
+        /*! \brief The index of the changed entry */
+        size_t index;
+
+        /*! \brief The entry before it was changed or erased, or the replaced text of a splice as its value */
+        json::kvp entry;
+
+        /*! \brief The position of a splice within the value of the entry */
+        size_t start;
+
+        /*! \brief The length of the text a splice inserted */
+        size_t length;
+
+        /*! \brief The entries before the whole document was replaced */
+        std::vector<json::kvp> document;
+
+        /*! \brief The array flag before the whole document was replaced */
+        bool array_flag;
+    };
+
+    /*! \brief The changes, in the order they were made */
+    std::vector<record> records;
+
+    /*! \brief Records a change to the entries
+     *
+     * @param type The kind of change
+     * @param index The index of the entry
+     * @param entry The entry before it was changed or erased
+     */
+    inline void add(const action type, const size_t index, const json::kvp &entry = json::kvp())
+    {
+        this->records.push_back(record());
+        this->records.back().type = type;
+        this->records.back().index = index;
+        this->records.back().entry = entry;
+    }
+
+    /*! \brief Replaces the value of an entry, recording the previous value
+     *
+     * @param index The index of the entry
+     * @param[in,out] text The value of the entry
+     * @param value The new value
+     */
+    inline void change(const size_t index, std::string &text, const std::string &value)
+    {
+        this->add(ENTRY_CHANGED, index);
+        this->records.back().entry.second.swap(text);
+        text = value;
+    }
+
+    /*! \brief Replaces part of the value of an entry, recording only the replaced text
+     *
+     * \details Nested values are changed by splicing the value of the entry that contains them, so the record follows the size of the change rather than the size of the entry
+     * @param index The index of the entry
+     * @param[in,out] text The value of the entry
+     * @param start The position of the text to replace
+     * @param length The length of the text to replace
+     * @param replacement The text to insert in its place
+     */
+    inline void splice(const size_t index, std::string &text, const size_t start, const size_t length, const std::string &replacement)
+    {
+        this->add(TEXT_SPLICED, index);
+        record &last = this->records.back();
+        last.entry.second.assign(text, start, length);
+        last.start = start;
+        last.length = replacement.size();
+        text.replace(start, length, replacement);
+    }
+
+    /*! \brief Replaces the whole document, recording the entries that were replaced
+     *
+     * @param[in,out] data The entries of the document, swapped with the replacement
+     * @param[in,out] array_flag The array flag of the document
+     * @param replacement The new entries
+     * @param replacement_flag The new array flag
+     */
+    inline void replace(std::vector<json::kvp> &data, bool &array_flag, std::vector<json::kvp> &replacement, const bool replacement_flag)
+    {
+        this->add(DOCUMENT_REPLACED, 0);
+        this->records.back().document.swap(data);
+        this->records.back().array_flag = array_flag;
+        data.swap(replacement);
+        array_flag = replacement_flag;
+    }
+
+    /*! \brief Undoes every recorded change, most recent first */
+    void rollback(std::vector<json::kvp> &data, bool &array_flag)
+    {
+        while(!this->records.empty())
+        {
+            record &last = this->records.back();
+            switch (last.type)
+            {
+            case ENTRY_CHANGED:
+                data[last.index].second.swap(last.entry.second);
+                break;
+            case TEXT_SPLICED:
+                data[last.index].second.replace(last.start, last.length, last.entry.second);
+                break;
+            case ENTRY_INSERTED:
+                data.erase(data.begin() + last.index);
+                break;
+            case ENTRY_ERASED:
+                data.insert(data.begin() + last.index, last.entry);
+                break;
+            case DOCUMENT_REPLACED:
+                data.swap(last.document);
+                array_flag = last.array_flag;
+                break;
+            }
+            this->records.pop_back();
+        }
+    }
+};
+
+/*! \brief A JSON Pointer split into the entry it starts at and the path within that entry */
+struct patch_target
+{
+    /*! \brief The first reference token, naming an entry of the object or array */
+    std::string first;
+
+    /*! \brief The reference tokens between the first and the last, as a pointer */
+    std::string parent;
+
+    /*! \brief The last reference token, if there is more than one */
+    std::string last;
+
+    /*! \brief True if the pointer has more than one reference token */
+    bool nested;
+
+    /*! \brief Constructor
+     *
+     * @param pointer A non-empty JSON Pointer
+     * \exception std::invalid_argument Thrown if the pointer is malformed
+     */
+    patch_target(const std::string &pointer)
+    {
+        if(pointer.empty() || pointer[0] != '/') throw std::invalid_argument("JSON pointer must be empty or start with '/'");
+        const char *rest = read_pointer_token(pointer.c_str(), this->first);
+        this->nested = *rest != '\0';
+        if(this->nested) {
+            const size_t start = (size_t)(rest - pointer.c_str());
+            const size_t last = pointer.rfind('/');
+            this->parent = pointer.substr(start, last - start);
+            read_pointer_token(pointer.c_str() + last, this->last);
+        }
+    }
+
+    /*! \brief Locates the member or element the pointer refers to within the serialized value of its entry
+     *
+     * @param text The serialized value of the entry
+     * @param pointer The pointer, used when reporting errors
+     * @param[out] slot The location of the member or element
+     * \exception json::invalid_key Thrown if the parent of the member or element does not exist
+     */
+    void locate(const std::string &text, const std::string &pointer, pointer_slot &slot) const
+    {
+        std::string token;
+        const char *container = resolve_pointer(text.c_str(), this->parent.c_str(), token);
+        if(container == NULL || (*container != '{' && *container != '[')) throw json::invalid_key(pointer);
+        locate_slot(container, this->last, slot);
+    }
+};
+
+/*! \brief Adds or replaces a value at a non-empty JSON Pointer
+ *
+ * \details Nested values are written by splicing the serialized value of the entry that contains them
+ * @param data The entries of the object or array
+ * @param array_flag True if the entries belong to an array
+ * @param pointer The location of the value
+ * @param value The serialized value
+ * @param replace True if an existing value must be replaced, false if the value is added
+ * @param journal The record of changes
+ */
+static void patch_write(std::vector<json::kvp> &data, const bool array_flag, const std::string &pointer, const std::string &value, const bool replace, patch_journal &journal)
+{
+    const patch_target target(pointer);
+    if(!target.nested && !array_flag) {
+        const size_t index = find_pointer_entry(data, false, target.first);
+        if(index < data.size()) {
+            journal.change(index, data[index].second, value);
+        } else if(replace) {
+            throw json::invalid_key(pointer);
+        } else {
+            data.push_back(json::kvp(target.first, value));
+            journal.add(patch_journal::ENTRY_INSERTED, index);
+        }
+        return;
+    } else if(!target.nested) {
+        size_t index = data.size();
+        if(target.first != "-" && (!read_pointer_index(target.first, index) || index > data.size())) throw json::invalid_key(pointer);
+        if(replace) {
+            if(index == data.size()) throw json::invalid_key(pointer);
+            journal.change(index, data[index].second, value);
+        } else {
+            data.insert(data.begin() + index, json::kvp(std::string(), value));
+            journal.add(patch_journal::ENTRY_INSERTED, index);
+        }
+        return;
+    }
+
+    const size_t index = find_pointer_entry(data, array_flag, target.first);
+    if(index == data.size()) throw json::invalid_key(pointer);
+    std::string &text = data[index].second;
+    pointer_slot slot;
+    target.locate(text, pointer, slot);
+    const size_t insert = slot.insert == NULL ? 0 : (size_t)(slot.insert - text.c_str());
+    if(slot.value != NULL && (replace || slot.object)) {
+        const size_t start = (size_t)(slot.value - text.c_str());
+        const size_t length = (size_t)(slot.value_end - slot.value);
+        journal.splice(index, text, start, length, value);
+    } else if(replace || slot.insert == NULL) {
+        throw json::invalid_key(pointer);
+    } else {
+        std::string insertion;
+        if(slot.separator_before && !slot.empty) insertion += ',';
+        if(slot.object) {
+            json::parsing::encode_string(target.last.data(), target.last.size(), insertion);
+            insertion += ':';
+        }
+        insertion += value;
+        if(!slot.separator_before) insertion += ',';
+        journal.splice(index, text, insert, 0, insertion);
+    }
+}
+
+/*! \brief Removes the value at a non-empty JSON Pointer
+ *
+ * @see patch_write
+ * @return The serialized value that was removed
+ */
+static std::string patch_remove(std::vector<json::kvp> &data, const bool array_flag, const std::string &pointer, patch_journal &journal)
+{
+    const patch_target target(pointer);
+    const size_t index = find_pointer_entry(data, array_flag, target.first);
+    if(index == data.size()) throw json::invalid_key(pointer);
+    if(!target.nested) {
+        journal.add(patch_journal::ENTRY_ERASED, index, data[index]);
+        const std::string removed = data[index].second;
+        data.erase(data.begin() + index);
+        return removed;
+    }
+
+    std::string &text = data[index].second;
+    pointer_slot slot;
+    target.locate(text, pointer, slot);
+    if(slot.value == NULL) throw json::invalid_key(pointer);
+    const std::string removed(slot.value, slot.value_end);
+    const size_t start = (size_t)(slot.erase_begin - text.c_str());
+    const size_t length = (size_t)(slot.erase_end - slot.erase_begin);
+    journal.splice(index, text, start, length, std::string());
+    return removed;
+}
+
+/*! \brief Reads a member of a JSON Patch operation
+ *
+ * @param operation The operation
+ * @param key The key of the member
+ * @param decode True if the member is a string to be decoded, false if the serialized value is returned
+ * \exception std::invalid_argument Thrown if the member is missing or is not a string when one is expected
+ */
+static std::string patch_member(const json::jobject &operation, const char *key, const bool decode)
+{
+    if(!operation.has_key(key)) throw std::invalid_argument(std::string("Operation is missing \"") + key + "\"");
+    const std::string value = operation.get(key);
+    if(!decode) return value;
+    if(json::jtype::peek(*value.c_str()) != json::jtype::jstring) throw std::invalid_argument(std::string("Operation member \"") + key + "\" must be a string");
+    return json::parsing::decode_string(value.c_str());
+}
+
+json::jobject& json::jobject::apply_patch(const jobject &operations)
+{
+    if(!operations.array_flag) throw json::patch_error(0, "Patch must be an array of operations");
+    patch_journal journal;
+    for(size_t i = 0; i < operations.size(); i++)
+    {
+        std::string failure;
+        try
+        {
+            const json::jobject operation = json::jobject::parse(operations.data[i].second);
+            if(operation.array_flag) throw std::invalid_argument("Operation must be an object");
+            const std::string op = patch_member(operation, "op", true);
+            const std::string path = patch_member(operation, "path", true);
+            std::string value;
+            bool write = true;
+            bool replace = false;
+            if(op == "add" || op == "replace") {
+                value = patch_member(operation, "value", false);
+                replace = op == "replace";
+            } else if(op == "remove") {
+                if(path.empty()) throw std::invalid_argument("The whole document cannot be removed");
+                patch_remove(this->data, this->array_flag, path, journal);
+                write = false;
+            } else if(op == "move" || op == "copy") {
+                const std::string from = patch_member(operation, "from", true);
+                if(op == "move" && from == path) {
+                    // Moving a value onto itself changes nothing, but the value must still exist
+                    if(!from.empty()) pointer_target(this->data, this->array_flag, from);
+                    continue;
+                }
+                if(op == "move" && path.compare(0, from.size() + 1, from + "/") == 0) throw std::invalid_argument("A value cannot be moved into one of its children");
+                value = op == "move" ? patch_remove(this->data, this->array_flag, from, journal) :
+                    from.empty() ? this->as_string() : pointer_target(this->data, this->array_flag, from);
+            } else if(op == "test") {
+                value = patch_member(operation, "value", false);
+                const std::string actual = path.empty() ? this->as_string() : pointer_target(this->data, this->array_flag, path);
+                if(!json::parsing::equal(actual.c_str(), value.c_str())) throw std::runtime_error("Test failed for \"" + path + "\"");
+                write = false;
+            } else {
+                throw std::invalid_argument("Unknown operation \"" + op + "\"");
+            }
+
+            if(write && path.empty()) {
+                json::jobject replacement = json::jobject::parse(value);
+                journal.replace(this->data, this->array_flag, replacement.data, replacement.array_flag);
+            } else if(write) {
+                patch_write(this->data, this->array_flag, path, value, replace, journal);
+            }
+        }
+        catch(const json::invalid_key &error)
+        {
+            failure = std::string("No value at \"") + error.what() + "\"";
+        }
+        catch(const std::logic_error &error)
+        {
+            failure = error.what();
+        }
+        catch(const std::runtime_error &error)
+        {
+            failure = error.what();
+        }
+        catch(...)
+        {
+            journal.rollback(this->data, this->array_flag);
+            this->modified();
+            throw;
+        }
+        if(!failure.empty()) {
+            journal.rollback(this->data, this->array_flag);
+            this->modified();
+            throw json::patch_error(i, failure);
+        }
+    }
+    this->modified();
+    return *this;
+}
+
+/*! \brief Multiplier used when mixing words into a hash */
+#define HASH_MULTIPLIER_1 0x87c37b91114253d5ULL
+
+/*! \brief Second multiplier used when mixing words into a hash */
+#define HASH_MULTIPLIER_2 0x4cf5ad432745937fULL
+
+/*! \brief Seeds distinguishing the hashes of the JSON types */
+enum hash_seed
+{
+    HASH_STRING = 0x5354,
+    HASH_NUMBER = 0x4e55,
+    HASH_ZERO = 0x5a45,
+    HASH_TRUE = 0x5452,
+    HASH_FALSE = 0x4641,
+    HASH_NULL = 0x4e4c,
+    HASH_ARRAY = 0x4152,
+    HASH_OBJECT = 0x4f42,
+    HASH_INVALID = 0x4956
+};
+
+/*! \brief Rotates a 64-bit value to the left
+ *
+ * @param value The value to rotate
+ * @param bits The number of bits to rotate by
+ */
+static inline uint64_t rotate_left(const uint64_t value, const unsigned int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+/*! \brief Finalizes a 64-bit hash so that every input bit affects every output bit
+ *
+ * @param value The value to finalize
+ */
+static inline uint64_t hash_finalize(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+/*! \brief Combines two hashes in an order-dependent way
+ *
+ * @param seed The hash accumulated so far
+ * @param value The hash to be combined
+ */
+static inline uint64_t hash_combine(const uint64_t seed, const uint64_t value)
+{
+    return hash_finalize(seed * HASH_MULTIPLIER_1 + value);
+}
+
+/*! \brief Streaming hash of a sequence of bytes, consumed a machine word at a time */
+struct byte_hasher
+{
+    /*! \brief The accumulated hash */
+    uint64_t state;
+
+    /*! \brief Bytes that have not yet filled a complete word */
+    uint64_t pending;
+
+    /*! \brief The number of bytes in #pending */
+    unsigned int pending_length;
+
+    /*! \brief The total number of bytes hashed */
+    uint64_t length;
+
+    /*! \brief Constructor
+     *
+     * @param seed The initial state of the hash
+     */
+    byte_hasher(const uint64_t seed) : state(seed), pending(0), pending_length(0), length(0) { }
+
+    /*! \brief Mixes a complete word into the hash */
+    void mix(uint64_t word)
+    {
+        word *= HASH_MULTIPLIER_1;
+        word = rotate_left(word, 31);
+        word *= HASH_MULTIPLIER_2;
+        this->state ^= word;
+        this->state = rotate_left(this->state, 27) * 5 + 0x52dce729;
+    }
+
+    /*! \brief Hashes a single byte */
+    void byte(const unsigned char next)
+    {
+        this->pending |= (uint64_t)next << (8 * this->pending_length);
+        this->length++;
+        if(++this->pending_length == 8) {
+            this->mix(this->pending);
+            this->pending = 0;
+            this->pending_length = 0;
+        }
+    }
+
+    /*! \brief Hashes a run of bytes
+     *
+     * @param input The bytes to hash
+     * @param count The number of bytes to hash
+     */
+    void bytes(const char *input, size_t count)
+    {
+        const unsigned char *next = (const unsigned char *)input;
+        while(count > 0 && this->pending_length > 0)
+        {
+            this->byte(*next++);
+            count--;
+        }
+        while(count >= 8)
+        {
+            // Assemble the word explicitly so the hash does not depend on the platform's byte order
+            const uint64_t word =
+                (uint64_t)next[0] | ((uint64_t)next[1] << 8) | ((uint64_t)next[2] << 16) | ((uint64_t)next[3] << 24) |
+                ((uint64_t)next[4] << 32) | ((uint64_t)next[5] << 40) | ((uint64_t)next[6] << 48) | ((uint64_t)next[7] << 56);
+            this->mix(word);
+            this->length += 8;
+            next += 8;
+            count -= 8;
+        }
+        while(count > 0)
+        {
+            this->byte(*next++);
+            count--;
+        }
+    }
+
+    /*! \brief Returns the final hash */
+    uint64_t finish()
+    {
+        if(this->pending_length > 0) this->mix(this->pending);
+        return hash_finalize(this->state ^ this->length);
+    }
+};
+
+/*! \brief Hashes the decoded content of a string
+ *
+ * @param input The characters of the string
+ * @param length The number of characters
+ */
+static uint64_t hash_string(const char *input, const size_t length)
+{
+    byte_hasher hasher(HASH_STRING);
+    hasher.bytes(input, length);
+    return hasher.finish();
+}
+
+/*! \brief Hashes a serialized string by its decoded content
+ *
+ * @param[in,out] input Pointer to the opening quotation, advanced past the closing quotation
+ */
+static uint64_t hash_serialized_string(const char *&input)
+{
+    byte_hasher hasher(HASH_STRING);
+    const char *index = input + 1;
+    while(true)
+    {
+        const size_t run = strcspn(index, "\"\\");
+        hasher.bytes(index, run);
+        index += run;
+        if(*index != '\\') break;
+        char buffer[4];
+        size_t length;
+        index = decode_escape(index + 1, buffer, length);
+        hasher.bytes(buffer, length);
+    }
+    if(*index == '"') index++;
+    input = index;
+    return hasher.finish();
+}
+
+/*! \brief Hashes a serialized number by its value
+ *
+ * @param[in,out] input Pointer to the number, advanced past the number
+ */
+static uint64_t hash_number(const char *&input)
+{
+    number_view number;
+    input = read_number(input, number);
+    if(number.significant == 0) return hash_finalize(HASH_ZERO);
+    byte_hasher hasher(HASH_NUMBER);
+    hasher.byte(number.negative ? 1 : 0);
+    for(unsigned int i = 0; i < 64; i += 8) hasher.byte((unsigned char)((uint64_t)number.exponent >> i));
+
+    for(size_t i = 0; i < number.significant; i++) hasher.byte((unsigned char)number.digit(i));
+    return hasher.finish();
+}
+
+/*! \brief Combines the hash of an object member into the hash of the object
+ *
+ * @param seed The hash of the object so far
+ * @param member The hash of the member
+ * @param ignore_order When true, members are combined commutatively
+ */
+static inline uint64_t hash_member(const uint64_t seed, const uint64_t member, const bool ignore_order)
+{
+    return ignore_order ? seed + hash_finalize(member) : hash_combine(seed, member);
+}
+
+/*! \brief Hashes a serialized value
+ *
+ * @param[in,out] input Pointer to the value, advanced past the value
+ * @param ignore_order When true, the hash of an object does not depend on the order of its members
+ */
+static uint64_t hash_value(const char *&input, const bool ignore_order)
+{
+    input = json::parsing::tlws(input);
+    switch (json::jtype::peek(*input))
+    {
+    case json::jtype::jstring:
+        return hash_serialized_string(input);
+    case json::jtype::jnumber:
+        return hash_number(input);
+    case json::jtype::jbool:
+        if(*input == 't') {
+            input += 4;
+            return hash_finalize(HASH_TRUE);
+        }
+        input += 5;
+        return hash_finalize(HASH_FALSE);
+    case json::jtype::jnull:
+        input += 4;
+        return hash_finalize(HASH_NULL);
+    case json::jtype::jarray:
+    {
+        uint64_t result = HASH_ARRAY;
+        uint64_t count = 0;
+        input = json::parsing::tlws(input + 1);
+        while(*input != ']' && *input != '\0')
+        {
+            result = hash_combine(result, hash_value(input, ignore_order));
+            input = next_element(input);
+            count++;
+        }
+        if(*input == ']') input++;
+        return hash_combine(result, count);
+    }
+    case json::jtype::jobject:
+    {
+        uint64_t result = HASH_OBJECT;
+        uint64_t count = 0;
+        input = json::parsing::tlws(input + 1);
+        while(*input == '"')
+        {
+            const uint64_t key = hash_serialized_string(input);
+            input = json::parsing::tlws(input);
+            if(*input == ':') input++;
+            result = hash_member(result, hash_combine(key, hash_value(input, ignore_order)), ignore_order);
+            input = next_element(input);
+            count++;
+        }
+        if(*input == '}') input++;
+        return hash_combine(result, count);
+    }
+    case json::jtype::not_valid:
+        break;
+    }
+    return hash_finalize(HASH_INVALID);
+}
+
+uint64_t json::parsing::hash(const char *input, const bool ignore_order)
+{
+    return hash_value(input, ignore_order);
+}
+
+uint64_t json::jobject::hash(const bool ignore_order) const
+{
+    const unsigned char flag = ignore_order ? 2 : 1;
+    cache &state = this->cached_state();
+    if((state.hash_valid & flag) != 0) return state.hashes[ignore_order ? 1 : 0];
+
+    // Mirrors hash_value so that the hash matches that of the serialized object
+    uint64_t result = this->array_flag ? HASH_ARRAY : HASH_OBJECT;
+    for(size_t i = 0; i < this->size(); i++)
+    {
+        const char *value = this->data[i].second.c_str();
+        const uint64_t value_hash = hash_value(value, ignore_order);
+        if(this->array_flag) {
+            result = hash_combine(result, value_hash);
+        } else {
+            const uint64_t key_hash = hash_string(this->data[i].first.data(), this->data[i].first.size());
+            result = hash_member(result, hash_combine(key_hash, value_hash), ignore_order);
+        }
+    }
+    result = hash_combine(result, this->size());
+
+    state.hashes[ignore_order ? 1 : 0] = result;
+    state.hash_valid |= flag;
+    return result;
+}
+
+json::jobject::entry::operator int() const { return this->get_number<int>(INT_FORMAT); }
+json::jobject::entry::operator unsigned int() const { return this->get_number<unsigned int>(UINT_FORMAT); }
+json::jobject::entry::operator long() const { return this->get_number<long>(LONG_FORMAT); }
+json::jobject::entry::operator unsigned long() const { return this->get_number<unsigned long>(ULONG_FORMAT); }
+json::jobject::entry::operator char() const { return this->get_number<char>(CHAR_FORMAT); }
+json::jobject::entry::operator float() const { return this->get_number<float>(FLOAT_FORMAT); }
+json::jobject::entry::operator double() const { return this->get_number<double>(DOUBLE_FORMAT); }
+
+json::jobject::entry::operator std::vector<int>() const { return this->get_number_array<int>(INT_FORMAT); }
+json::jobject::entry::operator std::vector<unsigned int>() const { return this->get_number_array<unsigned int>(UINT_FORMAT); }
+json::jobject::entry::operator std::vector<long>() const { return this->get_number_array<long>(LONG_FORMAT); }
+json::jobject::entry::operator std::vector<unsigned long>() const { return this->get_number_array<unsigned long>(ULONG_FORMAT); }
+json::jobject::entry::operator std::vector<char>() const { return this->get_number_array<char>(CHAR_FORMAT); }
+json::jobject::entry::operator std::vector<float>() const { return this->get_number_array<float>(FLOAT_FORMAT); }
+json::jobject::entry::operator std::vector<double>() const { return this->get_number_array<double>(DOUBLE_FORMAT); }
+
+void json::jobject::proxy::set_array(const std::vector<std::string> &values, const bool wrap)
+{
+    std::string value = "[";
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (i > 0) value += ',';
+        if (wrap) json::parsing::encode_string(values[i].data(), values[i].size(), value);
+        else value += values[i];
+    }
+    value += "]";
+    this->sink.set(key, value);
+}
+
+/*! \brief Parses a value within a document
+ *
+ * @param document The start of the document
+ * @param index The start of the value within the document
+ * @param validate_utf8 When true, strings are validated as UTF-8
+ * @return Details regarding the value encountered
+ * \exception json::invalid_utf8 Thrown with the offset relative to the start of the document
+ */
+static json::parsing::parse_results parse_document_value(const char *document, const char *index, const bool validate_utf8)
+{
+    try
+    {
+        return json::parsing::parse(index, validate_utf8);
+    }
+    catch(const json::invalid_utf8 &error)
+    {
+        throw json::invalid_utf8(error.offset + (size_t)(index - document));
+    }
+}
+
+/*! \brief Parses the entries of a serialized object or array
+ *
+ * @tparam T The container type, which must be constructible from an array flag and support appending a json::kvp
+ * @param input Serialized JSON object or array
+ * @param validate_utf8 When true, all keys and string values are validated as UTF-8 during parsing
+ * @return The parsed container
+ * \exception json::parsing_error Thrown when the input string is not valid JSON
+ */
+template<typename T>
+static T parse_container(const char *input, const bool validate_utf8)
+{
+    JSON_STATS_SCOPE(PARSE);
+    const char error[] = "Input is not a valid object";
+    const char *index = json::parsing::tlws(input);
+    if(*index != '{' && *index != '[') throw json::parsing_error(error);
+    T result(*index == '[');
+    index++;
+    SKIP_WHITE_SPACE(index);
+    if (EMPTY_STRING(index)) throw json::parsing_error(error);
+
+    while (!EMPTY_STRING(index) && !END_CHARACTER_ENCOUNTERED(result, index))
+    {
+        // Get key
+        json::kvp entry;
+
+        if(!result.is_array()) {
+            json::parsing::parse_results key = parse_document_value(input, index, validate_utf8);
+            if (key.type != json::jtype::jstring || key.value == "") throw json::parsing_error(error);
+            json::parsing::decode_string(key.value.c_str(), entry.first);
+            index = key.remainder;
+
+            // Get value
+            SKIP_WHITE_SPACE(index);
+            if (*index != ':') throw json::parsing_error(error);
+            index++;
+        }
+
+        SKIP_WHITE_SPACE(index);
+        json::parsing::parse_results value = parse_document_value(input, index, validate_utf8);
+        if (value.type == json::jtype::not_valid) throw json::parsing_error(error);
+        entry.second = JSON_MOVE(value.value);
+        index = value.remainder;
+
+        // Clean up
+        SKIP_WHITE_SPACE(index);
+        if (*index != ',' && !END_CHARACTER_ENCOUNTERED(result, index)) throw json::parsing_error(error);
+        if (*index == ',') index++;
+        result += JSON_MOVE(entry);
+
+    }
+    if (EMPTY_STRING(index) || !END_CHARACTER_ENCOUNTERED(result, index)) throw json::parsing_error(error);
+    index++;
+    JSON_STATS_COUNT_INPUT(index - input);
+    return result;
+}
+
+json::jobject json::jobject::parse(const char *input, const bool validate_utf8)
+{
+    return parse_container<json::jobject>(input, validate_utf8);
+}
+
+json::key_list_t json::jobject::list_keys() const
+{
+    // Initialize the result
+    key_list_t result;
+
+    // Return an empty list if the object is an array
+    if(this->is_array()) return result;
+
+    for(size_t i = 0; i < this->data.size(); i++)
+    {
+        result.push_back(this->data.at(i).first);
+    }
+    return result;
+}
+
+/*! \brief The number of entries from which objects look up keys through a hashed index */
+#define KEY_INDEX_MINIMUM 16
+
+size_t json::jobject::find_key(const std::string &key) const
+{
+    const size_t count = this->data.size();
+    JSON_STATS_COUNT(KEY_LOOKUPS, 1);
+    if(count < KEY_INDEX_MINIMUM) {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (this->data[i].first == key) {
+                JSON_STATS_COUNT(KEY_COMPARISONS, i + 1);
+                return i;
+            }
+        }
+        JSON_STATS_COUNT(KEY_COMPARISONS, count);
+        return count;
+    }
+
+    cache &state = this->cached_state();
+
+    // Rebuild the table once it would be more than half full, leaving room for further entries
+    if(state.key_index.size() < 2 * count || state.indexed_entries > count) {
+        size_t capacity = 2 * KEY_INDEX_MINIMUM;
+        while(capacity < 4 * count) capacity *= 2;
+        state.key_index.assign(capacity, 0);
+        state.indexed_entries = 0;
+    }
+
+    // Record the entries appended since the last lookup, keeping the first entry for a duplicated key
+    const size_t mask = state.key_index.size() - 1;
+    for (; state.indexed_entries < count; state.indexed_entries++)
+    {
+        const std::string &name = this->data[state.indexed_entries].first;
+        size_t slot = (size_t)hash_string(name.data(), name.size()) & mask;
+        while(state.key_index[slot] != 0 && this->data[state.key_index[slot] - 1].first != name) slot = (slot + 1) & mask;
+        if(state.key_index[slot] == 0) state.key_index[slot] = state.indexed_entries + 1;
+    }
+
+    for (size_t slot = (size_t)hash_string(key.data(), key.size()) & mask; state.key_index[slot] != 0; slot = (slot + 1) & mask)
+    {
+        JSON_STATS_COUNT(KEY_COMPARISONS, 1);
+        if(this->data[state.key_index[slot] - 1].first == key) return state.key_index[slot] - 1;
+    }
+    return count;
+}
+
+void json::jobject::set(const std::string &key, const std::string &value)
+{
+    JSON_STATS_SCOPE(ACCESS);
+    if(this->array_flag) throw json::invalid_key(key);
+    const size_t index = this->find_key(key);
+    this->values_modified();
+    if(index < this->size()) {
+        this->data[index].second = value;
+        return;
+    }
+    this->data.push_back(kvp(key, value));
+}
+
+#if JSON_HAS_CXX11
+void json::jobject::set(const std::string &key, std::string &&value)
+{
+    JSON_STATS_SCOPE(ACCESS);
+    if(this->array_flag) throw json::invalid_key(key);
+    const size_t index = this->find_key(key);
+    this->values_modified();
+    if(index < this->size()) {
+        this->data[index].second = std::move(value);
+        return;
+    }
+    this->data.push_back(kvp(key, std::move(value)));
+}
+#endif
+
+void json::jobject::remove(const std::string &key)
+{
+    JSON_STATS_SCOPE(ACCESS);
+    const size_t index = this->find_key(key);
+    if(index < this->size()) this->remove(index);
+}
+
+void json::jobject::remove(const key_list_t &keys)
+{
+    JSON_STATS_SCOPE(ACCESS);
+    std::vector<bool> removed(this->size(), false);
+    bool any = false;
+    for(size_t i = 0; i < keys.size(); i++)
+    {
+        const size_t index = this->find_key(keys[i]);
+        if(index < this->size()) removed[index] = any = true;
+    }
+    if(!any) return;
+
+    // Compact the remaining entries in a single pass
+    size_t kept = 0;
+    for(size_t i = 0; i < this->size(); i++)
+    {
+        if(removed[i]) continue;
+        if(kept != i) {
+            this->data[kept].first.swap(this->data[i].first);
+            this->data[kept].second.swap(this->data[i].second);
+        }
+        kept++;
+    }
+    this->data.resize(kept);
+    this->modified();
+}
+
+/*! \brief Copies a serialized object, leaving out members that are null at any depth
+ *
+ * \details This is the result of applying a merge patch to an empty object
+ * @param object Pointer to the opening brace of the object
+ * @param[out] output The string the object is appended to
+ */
+static void append_without_nulls(const char *object, std::string &output)
+{
+    output += '{';
+    bool first = true;
+    const char *member = json::parsing::tlws(object + 1);
+    while(*member == '"')
+    {
+        const char *value = member_value(member);
+        const char *end = value == NULL ? NULL : skip_value(value);
+        if(end == NULL || end == value) throw json::parsing_error("Input is not a valid object");
+        const json::jtype::jtype type = json::jtype::peek(*value);
+        if(type != json::jtype::jnull) {
+            if(!first) output += ',';
+            first = false;
+            output.append(member, skip_string(member));
+            output += ':';
+            if(type == json::jtype::jobject) append_without_nulls(value, output);
+            else output.append(value, end);
+        }
+        member = next_element(end);
+    }
+    output += '}';
+}
+
+/*! \brief A member of a serialized object being merged by merge_object */
+struct overlay_member
+{
+    /*! \brief The decoded key */
+    std::string key;
+
+    /*! \brief Pointer to the serialized value */
+    const char *value;
+
+    /*! \brief Pointer to the first character after the serialized value */
+    const char *end;
+
+    /*! \brief Set once the member has been merged with a member of the target */
+    bool matched;
+};
+
+/*! \brief Orders the positions of overlay members by their keys */
+struct overlay_order
+{
+    /*! \brief The members being ordered */
+    const std::vector<overlay_member> *members;
+
+    /*! \brief Compares the keys of two members */
+    bool operator()(const size_t lhs, const size_t rhs) const
+    {
+        return (*this->members)[lhs].key < (*this->members)[rhs].key;
+    }
+};
+
+/*! \brief Finds the member of an overlay with a key
+ *
+ * @param members The members of the overlay
+ * @param order The positions of the members, sorted by key with duplicated keys in their original order
+ * @param key The key to search for
+ * @return The position of the last member with the key, or the number of members if there is none
+ */
+static size_t find_overlay_member(const std::vector<overlay_member> &members, const std::vector<size_t> &order, const std::string &key)
+{
+    size_t low = 0;
+    size_t high = order.size();
+    while(low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        if(key < members[order[middle]].key) high = middle;
+        else low = middle + 1;
+    }
+    if(low > 0 && members[order[low - 1]].key == key) return order[low - 1];
+    return members.size();
+}
+
+/*! \brief Merges a serialized object into another serialized object
+ *
+ * \details The target is read once. Each of its members is looked up among the members of the overlay, which are sorted by key, and is then copied, replaced, merged recursively or left out. Members of the overlay that are not in the target are appended in their original order. When a key is duplicated, the first member of the target and the last member of the overlay are merged.
+ * @param target Pointer to the opening brace of the object being merged into
+ * @param overlay Pointer to the opening brace of the object to be merged
+ * @param patch True for JSON Merge Patch semantics, where null removes a member
+ * @param[out] output The string the merged object is appended to
+ * \exception json::parsing_error Thrown if either object is malformed
+ */
+static void merge_object(const char *target, const char *overlay, const bool patch, std::string &output)
+{
+    std::vector<overlay_member> members;
+    const char *member = json::parsing::tlws(overlay + 1);
+    while(*member == '"')
+    {
+        overlay_member next;
+        next.value = member_value(member);
+        next.end = next.value == NULL ? NULL : skip_value(next.value);
+        if(next.end == NULL || next.end == next.value) throw json::parsing_error("Input is not a valid object");
+        json::parsing::decode_string(member, next.key);
+        next.matched = false;
+        members.push_back(next);
+        member = next_element(next.end);
+    }
+    std::vector<size_t> order(members.size());
+    for(size_t i = 0; i < order.size(); i++) order[i] = i;
+    overlay_order compare;
+    compare.members = &members;
+    std::stable_sort(order.begin(), order.end(), compare);
+
+    output += '{';
+    bool first = true;
+    std::string key;
+    const char *entry = json::parsing::tlws(target + 1);
+    while(*entry == '"')
+    {
+        const char *value = member_value(entry);
+        const char *end = value == NULL ? NULL : skip_value(value);
+        if(end == NULL || end == value) throw json::parsing_error("Input is not a valid object");
+        key.clear();
+        json::parsing::decode_string(entry, key);
+        const size_t index = find_overlay_member(members, order, key);
+
+        if(index == members.size() || members[index].matched) {
+            if(!first) output += ',';
+            first = false;
+            output.append(entry, end);
+        } else {
+            overlay_member &match = members[index];
+            match.matched = true;
+            const json::jtype::jtype type = json::jtype::peek(*match.value);
+            if(!patch || type != json::jtype::jnull) {
+                if(!first) output += ',';
+                first = false;
+                output.append(entry, skip_string(entry));
+                output += ':';
+                if(type == json::jtype::jobject && *value == '{') merge_object(value, match.value, patch, output);
+                else if(patch && type == json::jtype::jobject) append_without_nulls(match.value, output);
+                else output.append(match.value, match.end);
+            }
+        }
+        entry = next_element(end);
+    }
+    if(*entry != '}') throw json::parsing_error("Input is not a valid object");
+
+    for(size_t i = 0; i < members.size(); i++)
+    {
+        const overlay_member &added = members[i];
+        if(added.matched || find_overlay_member(members, order, added.key) != i) continue;
+        const json::jtype::jtype type = json::jtype::peek(*added.value);
+        if(patch && type == json::jtype::jnull) continue;
+        if(!first) output += ',';
+        first = false;
+        json::parsing::encode_string(added.key.data(), added.key.size(), output);
+        output += ':';
+        if(patch && type == json::jtype::jobject) append_without_nulls(added.value, output);
+        else output.append(added.value, added.end);
+    }
+    output += '}';
+}
+
+void json::jobject::merge_members(const jobject &overlay, const bool patch)
+{
+    std::vector<size_t> removed;
+    for (size_t i = 0; i < overlay.size(); i++)
+    {
+        const std::string &key = overlay.data[i].first;
+        const char *value = json::parsing::tlws(overlay.data[i].second.c_str());
+        const json::jtype::jtype type = json::jtype::peek(*value);
+        const size_t index = this->find_key(key);
+        if(patch && type == json::jtype::jnull) {
+            if(index < this->size()) removed.push_back(index);
+            continue;
+        }
+
+        if(type == json::jtype::jobject && index < this->size()) {
+            std::string &target = this->data[index].second;
+            const size_t offset = (size_t)(json::parsing::tlws(target.c_str()) - target.c_str());
+            if(target[offset] == '{') {
+                std::string merged;
+                merged.reserve(target.size() + overlay.data[i].second.size());
+                merge_object(target.c_str() + offset, value, patch, merged);
+                target.swap(merged);
+                continue;
+            }
+        }
+
+        std::string replacement;
+        if(patch && type == json::jtype::jobject) append_without_nulls(value, replacement);
+        else replacement = overlay.data[i].second;
+        if(index < this->size()) this->data[index].second.swap(replacement);
+        else this->data.push_back(kvp(key, JSON_MOVE(replacement)));
+    }
+
+    // Removals are deferred so that entries only shift once, and only then is the key index discarded
+    if(removed.empty()) {
+        this->values_modified();
+        return;
+    }
+    std::sort(removed.begin(), removed.end());
+    size_t kept = removed.front();
+    for (size_t i = removed.front(), next = 0; i < this->size(); i++)
+    {
+        if(next < removed.size() && removed[next] == i) {
+            next++;
+            continue;
+        }
+        if(kept != i) {
+            this->data[kept].first.swap(this->data[i].first);
+            this->data[kept].second.swap(this->data[i].second);
+        }
+        kept++;
+    }
+    this->data.resize(kept);
+    this->modified();
+}
+
+json::jobject& json::jobject::merge_patch(const jobject &patch)
+{
+    if(&patch == this) {
+        const jobject copy(patch);
+        return this->merge_patch(copy);
+    }
+    if(patch.array_flag) {
+        *this = patch;
+        return *this;
+    }
+    if(this->array_flag) {
+        this->data.clear();
+        this->array_flag = false;
+        this->modified();
+    }
+    this->merge_members(patch, true);
+    return *this;
+}
+
+json::jobject& json::jobject::merge(const jobject &overlay)
+{
+    if(&overlay == this) return *this;
+    if(overlay.array_flag || this->array_flag) {
+        *this = overlay;
+        return *this;
+    }
+    this->merge_members(overlay, false);
+    return *this;
+}
+
+/*! \brief The largest table, in cells, used to align array elements by their longest common subsequence */
+#define DIFF_LCS_CELLS 262144
+
+/*! \brief Appends a reference token to a JSON Pointer, escaping `~` and `/`
+ *
+ * @param[in,out] path The pointer
+ * @param token The characters of the token
+ * @param length The number of characters
+ */
+static void append_pointer_token(std::string &path, const char *token, const size_t length)
+{
+    path += '/';
+    for(size_t i = 0; i < length; i++)
+    {
+        switch (token[i])
+        {
+        case '~':
+            path += "~0";
+            break;
+        case '/':
+            path += "~1";
+            break;
+        default:
+            path += token[i];
+        }
+    }
+}
+
+/*! \brief Appends an operation to a JSON Patch
+ *
+ * @param patch The patch
+ * @param op The name of the operation
+ * @param path The target of the operation
+ * @param value Pointer to the serialized value of the operation, or `NULL` if the operation has no value
+ */
+static void append_operation(json::jobject &patch, const char *op, const std::string &path, const char *value)
+{
+    std::string operation = "{\"op\":\"";
+    operation += op;
+    operation += "\",\"path\":";
+    json::parsing::encode_string(path.data(), path.size(), operation);
+    if(value != NULL) {
+        value = json::parsing::tlws(value);
+        operation += ",\"value\":";
+        operation.append(value, skip_value(value));
+    }
+    operation += '}';
+    patch += json::kvp(std::string(), JSON_MOVE(operation));
+}
+
+static void append_decimal(uint64_t value, std::string &output);
+
+static void diff_values(const char *from, const char *to, std::string &path, json::jobject &patch);
+
+/*! \brief Diffs the members of two objects, matched by key
+ *
+ * @param from The members of the original object as (key, serialized value) pairs
+ * @param to The members of the target object
+ * @param path The pointer to the objects, restored before returning
+ * @param patch The patch the operations are appended to
+ */
+static void diff_members(const std::vector<std::pair<std::string, const char*> > &from, const std::vector<std::pair<std::string, const char*> > &to, std::string &path, json::jobject &patch)
+{
+    std::vector<std::pair<std::string, const char*> > sorted(to);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<bool> matched(sorted.size(), false);
+    const size_t length = path.size();
+    for(size_t i = 0; i < from.size(); i++)
+    {
+        append_pointer_token(path, from[i].first.data(), from[i].first.size());
+        const std::vector<std::pair<std::string, const char*> >::const_iterator match =
+            std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(from[i].first, (const char*)NULL));
+        if(match == sorted.end() || match->first != from[i].first) {
+            append_operation(patch, "remove", path, NULL);
+        } else {
+            matched[(size_t)(match - sorted.begin())] = true;
+            diff_values(from[i].second, match->second, path, patch);
+        }
+        path.resize(length);
+    }
+    for(size_t i = 0; i < to.size(); i++)
+    {
+        const std::vector<std::pair<std::string, const char*> >::const_iterator match =
+            std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(to[i].first, (const char*)NULL));
+        if(matched[(size_t)(match - sorted.begin())]) continue;
+        append_pointer_token(path, to[i].first.data(), to[i].first.size());
+        append_operation(patch, "add", path, to[i].second);
+        path.resize(length);
+    }
+}
+
+/*! \brief Diffs the elements of two arrays
+ *
+ * \details Common leading and trailing elements are skipped, and the remaining elements are aligned by the longest common subsequence of their hashes. Elements that line up without matching are diffed recursively instead of being removed and added.
+ * @param from The serialized elements of the original array
+ * @param to The serialized elements of the target array
+ * @param path The pointer to the arrays, restored before returning
+ * @param patch The patch the operations are appended to
+ */
+static void diff_elements(const std::vector<const char*> &from, const std::vector<const char*> &to, std::string &path, json::jobject &patch)
+{
+    std::vector<uint64_t> from_hashes(from.size());
+    std::vector<uint64_t> to_hashes(to.size());
+    for(size_t i = 0; i < from.size(); i++) from_hashes[i] = json::parsing::hash(from[i], true);
+    for(size_t i = 0; i < to.size(); i++) to_hashes[i] = json::parsing::hash(to[i], true);
+
+    size_t start = 0;
+    while(start < from.size() && start < to.size() && from_hashes[start] == to_hashes[start] && json::parsing::equal(from[start], to[start])) start++;
+    size_t from_end = from.size();
+    size_t to_end = to.size();
+    while(from_end > start && to_end > start && from_hashes[from_end - 1] == to_hashes[to_end - 1] && json::parsing::equal(from[from_end - 1], to[to_end - 1]))
+    {
+        from_end--;
+        to_end--;
+    }
+
+    // Lengths of the longest common subsequences of the remaining suffixes, if the table is small enough
+    const size_t rows = from_end - start + 1;
+    const size_t columns = to_end - start + 1;
+    std::vector<uint32_t> lcs;
+    if(rows * columns <= DIFF_LCS_CELLS) {
+        lcs.assign(rows * columns, 0);
+        for(size_t i = rows - 1; i-- > 0; )
+        {
+            for(size_t j = columns - 1; j-- > 0; )
+            {
+                lcs[i * columns + j] = from_hashes[start + i] == to_hashes[start + j] ? lcs[(i + 1) * columns + j + 1] + 1 :
+                    std::max(lcs[(i + 1) * columns + j], lcs[i * columns + j + 1]);
+            }
+        }
+    }
+
+    const size_t length = path.size();
+    size_t i = 0;
+    size_t j = 0;
+    size_t position = start;
+    while(start + i < from_end || start + j < to_end)
+    {
+        const bool both = start + i < from_end && start + j < to_end;
+        const uint32_t here = lcs.empty() ? 0 : lcs[i * columns + j];
+        path.resize(length);
+        path += '/';
+        append_decimal(position, path);
+        if(both && (from_hashes[start + i] == to_hashes[start + j] || (lcs.empty() ? 0 : lcs[(i + 1) * columns + j + 1]) == here)) {
+            diff_values(from[start + i], to[start + j], path, patch);
+            i++;
+            j++;
+            position++;
+        } else if(start + j == to_end || (start + i < from_end && lcs[(i + 1) * columns + j] >= lcs[i * columns + j + 1])) {
+            append_operation(patch, "remove", path, NULL);
+            i++;
+        } else {
+            append_operation(patch, "add", path, to[start + j]);
+            j++;
+            position++;
+        }
+    }
+    path.resize(length);
+}
+
+/*! \brief Reads the members of a serialized object
+ *
+ * @param object Pointer to the opening brace of the object
+ * @param[out] members The decoded keys and the serialized values of the members
+ */
+static void read_members(const char *object, std::vector<std::pair<std::string, const char*> > &members)
+{
+    const char *member = json::parsing::tlws(object + 1);
+    while(*member == '"')
+    {
+        const char *value = member_value(member);
+        const char *end = value == NULL ? NULL : skip_value(value);
+        if(end == NULL || end == value) throw json::parsing_error("Input is not a valid object");
+        members.push_back(std::make_pair(std::string(), value));
+        json::parsing::decode_string(member, members.back().first);
+        member = next_element(end);
+    }
+}
+
+/*! \brief Reads the elements of a serialized array
+ *
+ * @param array Pointer to the opening bracket of the array
+ * @param[out] elements The serialized elements
+ */
+static void read_elements(const char *array, std::vector<const char*> &elements)
+{
+    const char *element = json::parsing::tlws(array + 1);
+    while(*element != ']' && *element != '\0')
+    {
+        const char *end = skip_value(element);
+        if(end == NULL || end == element) throw json::parsing_error("Input is not a valid array");
+        elements.push_back(element);
+        element = next_element(end);
+    }
+}
+
+/*! \brief Appends the operations that transform one serialized value into another
+ *
+ * @param from Pointer to the original value
+ * @param to Pointer to the target value
+ * @param path The pointer to the values
+ * @param patch The patch the operations are appended to
+ */
+static void diff_values(const char *from, const char *to, std::string &path, json::jobject &patch)
+{
+    from = json::parsing::tlws(from);
+    to = json::parsing::tlws(to);
+    if(json::parsing::equal(from, to)) return;
+    if(*from == '{' && *to == '{') {
+        std::vector<std::pair<std::string, const char*> > from_members;
+        std::vector<std::pair<std::string, const char*> > to_members;
+        read_members(from, from_members);
+        read_members(to, to_members);
+        diff_members(from_members, to_members, path, patch);
+    } else if(*from == '[' && *to == '[') {
+        std::vector<const char*> from_elements;
+        std::vector<const char*> to_elements;
+        read_elements(from, from_elements);
+        read_elements(to, to_elements);
+        diff_elements(from_elements, to_elements, path, patch);
+    } else {
+        append_operation(patch, "replace", path, to);
+    }
+}
+
+json::jobject json::jobject::diff(const jobject &target) const
+{
+    json::jobject patch(true);
+    std::string path;
+    if(this->array_flag != target.array_flag) {
+        append_operation(patch, "replace", path, target.as_string().c_str());
+        return patch;
+    }
+    if(this->hash(true) == target.hash(true) && this->equals(target)) return patch;
+
+    if(this->array_flag) {
+        std::vector<const char*> from(this->size());
+        std::vector<const char*> to(target.size());
+        for(size_t i = 0; i < from.size(); i++) from[i] = this->data[i].second.c_str();
+        for(size_t i = 0; i < to.size(); i++) to[i] = target.data[i].second.c_str();
+        diff_elements(from, to, path, patch);
+        return patch;
+    }
+
+    // Top-level members are matched through the key index
+    for(size_t i = 0; i < this->size(); i++)
+    {
+        const std::string &key = this->data[i].first;
+        const size_t match = target.find_key(key);
+        append_pointer_token(path, key.data(), key.size());
+        if(match == target.size()) append_operation(patch, "remove", path, NULL);
+        else diff_values(this->data[i].second.c_str(), target.data[match].second.c_str(), path, patch);
+        path.clear();
+    }
+    for(size_t i = 0; i < target.size(); i++)
+    {
+        const std::string &key = target.data[i].first;
+        if(this->find_key(key) < this->size()) continue;
+        append_pointer_token(path, key.data(), key.size());
+        append_operation(patch, "add", path, target.data[i].second.c_str());
+        path.clear();
+    }
+    return patch;
+}
+
+json::jobject::operator std::string() const
+{
+    JSON_STATS_SCOPE(SERIALIZE);
+    // Size the result up front to avoid repeated growth
+    size_t length = 2;
+    for (size_t i = 0; i < this->size(); i++)
+    {
+        length += this->data[i].first.size() + this->data[i].second.size() + 4;
+    }
+    std::string result;
+    result.reserve(length);
+
+    result += is_array() ? '[' : '{';
+    for (size_t i = 0; i < this->size(); i++)
+    {
+        if (i > 0) result += ',';
+        if (!is_array()) {
+            json::parsing::encode_string(this->data[i].first.data(), this->data[i].first.size(), result);
+            result += ':';
+        }
+        result += this->data[i].second;
+    }
+    result += is_array() ? ']' : '}';
+    return result;
+}
+
+/*! \brief Appends a pretty representation of a serialized object or array
+ *
+ * \details Produces the same layout as json::jobject::pretty() for a nested value, without a leading indent, by walking the serialized value once rather than parsing every level into a json::jobject.
+ * @param[in,out] input Pointer to the opening brace or bracket, advanced past the closing one
+ * @param indent_level The number of indents (tabs) of the value's own line
+ * @param[out] output The string to append to
+ */
+static void append_pretty(const char *&input, const unsigned int indent_level, std::string &output)
+{
+    const bool array = *input == '[';
+    const char closer = array ? ']' : '}';
+    input = json::parsing::tlws(input + 1);
+    if(*input == closer) {
+        output += array ? "[]" : "{}";
+        input++;
+        return;
+    }
+
+    output += array ? "[\n" : "{\n";
+    std::string key;
+    while(true)
+    {
+        output.append(indent_level + 1, '\t');
+        if(!array) {
+            // Keys are decoded and encoded again, as when the value is parsed
+            key.clear();
+            input = json::parsing::tlws(json::parsing::decode_string(input, key));
+            json::parsing::encode_string(key.data(), key.size(), output);
+            output += ": ";
+            input = json::parsing::tlws(input + 1);
+        }
+        if(*input == '{' || *input == '[') {
+            append_pretty(input, indent_level + 1, output);
+        } else {
+            const char *end = skip_value(input);
+            if(end == NULL || end == input) throw json::parsing_error("Input is not a valid object");
+            output.append(input, (size_t)(end - input));
+            input = end;
+        }
+        input = json::parsing::tlws(input);
+        if(*input != ',') break;
+        output += ",\n";
+        input = json::parsing::tlws(input + 1);
+    }
+    if(*input != closer) throw json::parsing_error("Input is not a valid object");
+    input++;
+    output += '\n';
+    output.append(indent_level, '\t');
+    output += closer;
+}
+
+std::string json::jobject::pretty(unsigned int indent_level) const
+{
+    JSON_STATS_SCOPE(SERIALIZE);
+    std::string result = "";
+    for(unsigned int i = 0; i < indent_level; i++) result += "\t";
+    if (is_array()) {
+        if(this->size() == 0) {
+            result += "[]";
+            return result;
+        }
+        result += "[\n";
+        for (size_t i = 0; i < this->size(); i++)
+        {
+            switch(json::jtype::peek(*this->data.at(i).second.c_str())) {
+                case json::jtype::jarray:
+                case json::jtype::jobject:
+                {
+                    for(unsigned int j = 0; j < indent_level + 1; j++) result += "\t";
+                    const char *value = this->data.at(i).second.c_str();
+                    append_pretty(value, indent_level + 1, result);
+                    break;
+                }
+                default:
+                    for(unsigned int j = 0; j < indent_level + 1; j++) result += "\t";
+                    result += this->data.at(i).second;
+                    break;
+            }
+
+            result += ",\n";
+        }
+        result.erase(result.size() - 2, 1);
+        for(unsigned int i = 0; i < indent_level; i++) result += "\t";
+        result += "]";
+    } else {
+        if(this->size() == 0) {
+            result += "{}";
+            return result;
+        }
+        result += "{\n";
+        for (size_t i = 0; i < this->size(); i++)
+        {
+            for(unsigned int j = 0; j < indent_level + 1; j++) result += "\t";
+            json::parsing::encode_string(this->data.at(i).first.data(), this->data.at(i).first.size(), result);
+            result += ": ";
+            switch(json::jtype::peek(*this->data.at(i).second.c_str())) {
+                case json::jtype::jarray:
+                case json::jtype::jobject:
+                {
+                    const char *value = this->data.at(i).second.c_str();
+                    append_pretty(value, indent_level + 1, result);
+                    break;
+                }
+                default:
+                    result += this->data.at(i).second;
+                    break;
+            }
+
+            result += ",\n";
+        }
+        result.erase(result.size() - 2, 1);
+        for(unsigned int i = 0; i < indent_level; i++) result += "\t";
+        result += "}";
+    }
+    return result;
+}
+/*! \brief Appends an unsigned integer in big-endian byte order
+ *
+ * @param value The value to append
+ * @param bytes The number of bytes to append
+ * @param output The string to append to
+ */
+static void append_big_endian(const uint64_t value, const unsigned int bytes, std::string &output)
+{
+    for(unsigned int i = bytes; i > 0; i--) output += (char)(unsigned char)(value >> (8 * (i - 1)));
+}
+
+/*! \brief Returns the bits of a single-precision floating-point value */
+static uint32_t float_bits(const float value)
+{
+    uint32_t result;
+    memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+/*! \brief Returns the bits of a double-precision floating-point value */
+static uint64_t double_bits(const double value)
+{
+    uint64_t result;
+    memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+/*! \brief Writes values in CBOR (RFC 8949) */
+struct cbor_writer
+{
+    /*! \brief The encoded bytes */
+    std::string &output;
+
+    /*! \brief Constructor
+     *
+     * @param output The string to append the encoded bytes to
+     */
+    cbor_writer(std::string &output) : output(output) { }
+
+    /*! \brief Writes the initial bytes of a data item
+     *
+     * @param major The major type
+     * @param value The argument of the data item
+     */
+    void head(const unsigned char major, const uint64_t value)
+    {
+        const unsigned char type = (unsigned char)(major << 5);
+        if(value < 24) {
+            this->output += (char)(type | value);
+        } else if(value <= 0xFF) {
+            this->output += (char)(type | 24);
+            append_big_endian(value, 1, this->output);
+        } else if(value <= 0xFFFF) {
+            this->output += (char)(type | 25);
+            append_big_endian(value, 2, this->output);
+        } else if(value <= 0xFFFFFFFFUL) {
+            this->output += (char)(type | 26);
+            append_big_endian(value, 4, this->output);
+        } else {
+            this->output += (char)(type | 27);
+            append_big_endian(value, 8, this->output);
+        }
+    }
+
+    /*! \brief Writes a null value */
+    void null() { this->output += (char)0xF6; }
+
+    /*! \brief Writes a boolean value */
+    void boolean(const bool value) { this->output += (char)(value ? 0xF5 : 0xF4); }
+
+    /*! \brief Writes an integer
+     *
+     * @param negative When true, the value is -1 - magnitude
+     * @param magnitude The magnitude of the value
+     */
+    void integer(const bool negative, const uint64_t magnitude) { this->head(negative ? 1 : 0, magnitude); }
+
+    /*! \brief Writes a floating-point value, using single precision when it is exact */
+    void floating(const double value)
+    {
+        const float narrow = (float)value;
+        if((double)narrow == value) {
+            this->output += (char)0xFA;
+            append_big_endian(float_bits(narrow), 4, this->output);
+        } else {
+            this->output += (char)0xFB;
+            append_big_endian(double_bits(value), 8, this->output);
+        }
+    }
+
+    /*! \brief Writes a text string */
+    void string(const char *input, const size_t length)
+    {
+        this->head(3, length);
+        this->output.append(input, length);
+    }
+
+    /*! \brief Writes the header of an array */
+    void array(const size_t count) { this->head(4, count); }
+
+    /*! \brief Writes the header of a map */
+    void map(const size_t count) { this->head(5, count); }
+};
+
+/*! \brief Writes values in MessagePack */
+struct msgpack_writer
+{
+    /*! \brief The encoded bytes */
+    std::string &output;
+
+    /*! \brief Constructor
+     *
+     * @param output The string to append the encoded bytes to
+     */
+    msgpack_writer(std::string &output) : output(output) { }
+
+    /*! \brief Writes a format byte followed by a big-endian length
+     *
+     * @param format The format byte
+     * @param value The length
+     * @param bytes The number of bytes used for the length
+     */
+    void head(const unsigned char format, const uint64_t value, const unsigned int bytes)
+    {
+        this->output += (char)format;
+        append_big_endian(value, bytes, this->output);
+    }
+
+    /*! \brief Writes the header of a string, array or map
+     *
+     * @param fixed The format byte for lengths that fit in the format byte itself
+     * @param fixed_limit The exclusive upper bound of lengths using the fixed format
+     * @param format The format bytes for 8-, 16- and 32-bit lengths, where zero means the width is not supported
+     * @param length The length
+     */
+    void length_head(const unsigned char fixed, const size_t fixed_limit, const unsigned char format[3], const uint64_t length)
+    {
+        if(length < fixed_limit) this->output += (char)(fixed | length);
+        else if(length <= 0xFF && format[0] != 0) this->head(format[0], length, 1);
+        else if(length <= 0xFFFF) this->head(format[1], length, 2);
+        else if(length <= 0xFFFFFFFFUL) this->head(format[2], length, 4);
+        else throw std::length_error("Value is too large for MessagePack");
+    }
+
+    /*! \brief Writes a null value */
+    void null() { this->output += (char)0xC0; }
+
+    /*! \brief Writes a boolean value */
+    void boolean(const bool value) { this->output += (char)(value ? 0xC3 : 0xC2); }
+
+    /*! \brief Writes an integer
+     *
+     * @param negative When true, the value is -1 - magnitude
+     * @param magnitude The magnitude of the value
+     */
+    void integer(const bool negative, const uint64_t magnitude)
+    {
+        if(!negative) {
+            if(magnitude < 0x80) this->output += (char)magnitude;
+            else if(magnitude <= 0xFF) this->head(0xCC, magnitude, 1);
+            else if(magnitude <= 0xFFFF) this->head(0xCD, magnitude, 2);
+            else if(magnitude <= 0xFFFFFFFFUL) this->head(0xCE, magnitude, 4);
+            else this->head(0xCF, magnitude, 8);
+            return;
+        }
+
+        // The two's complement representation of -1 - magnitude is the complement of the magnitude
+        if(magnitude < 32) this->output += (char)(0xFF - magnitude);
+        else if(magnitude < 0x80) this->head(0xD0, ~magnitude, 1);
+        else if(magnitude < 0x8000) this->head(0xD1, ~magnitude, 2);
+        else if(magnitude < 0x80000000UL) this->head(0xD2, ~magnitude, 4);
+        else if(magnitude < ((uint64_t)1 << 63)) this->head(0xD3, ~magnitude, 8);
+        else this->floating(-1.0 - (double)magnitude);
+    }
+
+    /*! \brief Writes a floating-point value, using single precision when it is exact */
+    void floating(const double value)
+    {
+        const float narrow = (float)value;
+        if((double)narrow == value) this->head(0xCA, float_bits(narrow), 4);
+        else this->head(0xCB, double_bits(value), 8);
+    }
+
+    /*! \brief Writes a string */
+    void string(const char *input, const size_t length)
+    {
+        static const unsigned char formats[3] = { 0xD9, 0xDA, 0xDB };
+        this->length_head(0xA0, 32, formats, length);
+        this->output.append(input, length);
+    }
+
+    /*! \brief Writes the header of an array */
+    void array(const size_t count)
+    {
+        static const unsigned char formats[3] = { 0, 0xDC, 0xDD };
+        this->length_head(0x90, 16, formats, count);
+    }
+
+    /*! \brief Writes the header of a map */
+    void map(const size_t count)
+    {
+        static const unsigned char formats[3] = { 0, 0xDE, 0xDF };
+        this->length_head(0x80, 16, formats, count);
+    }
+};
+
+/*! \brief Counts the members or elements of a serialized object or array
+ *
+ * @param input Pointer to the opening bracket
+ * \exception json::parsing_error Thrown if the object or array is malformed
+ */
+static size_t count_elements(const char *input)
+{
+    const bool is_object = *input == '{';
+    const char close = is_object ? '}' : ']';
+    size_t result = 0;
+    const char *index = json::parsing::tlws(input + 1);
+    while(*index != close)
+    {
+        if(is_object) index = member_value(index);
+        if(index != NULL) index = skip_value(index);
+        if(index == NULL) throw json::parsing_error("Input is not a valid object");
+        index = next_element(index);
+        result++;
+    }
+    return result;
+}
+
+/*! \brief The deepest nesting of arrays and maps that is encoded or decoded in a binary format
+ *
+ * \details Values are encoded and decoded recursively, so deeper input is rejected rather than allowed to exhaust the stack
+ */
+#define BINARY_NESTING_LIMIT 1024
+
+/*! \brief Writes a serialized number as an integer when it is one and fits in 64 bits, and as a floating-point value otherwise
+ *
+ * @param input Pointer to the number
+ * @param writer The binary writer
+ * @return A pointer to the first character after the number
+ * \exception json::parsing_error Thrown if the number is too large for a double-precision floating-point value
+ */
+template<typename W>
+static const char* encode_binary_number(const char *input, W &writer)
+{
+    const char *index = input;
+    const bool negative = *index == '-';
+    if(negative) index++;
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    for(; IS_DIGIT(*index); index++)
+    {
+        const unsigned int digit = (unsigned int)(*index - '0');
+        if(magnitude > (~(uint64_t)0 - digit) / 10) overflow = true;
+        else magnitude = magnitude * 10 + digit;
+    }
+    if(!overflow && *index != '.' && *index != 'e' && *index != 'E') {
+        if(negative && magnitude > 0) writer.integer(true, magnitude - 1);
+        else writer.integer(false, magnitude);
+        return index;
+    }
+    char *end;
+    const double value = strtod(input, &end);
+    if(value - value != 0) throw json::parsing_error("Number is too large to be encoded");
+    writer.floating(value);
+    return end;
+}
+
+/*! \brief Writes a serialized value in a binary format
+ *
+ * @tparam W The binary writer
+ * @param input Pointer to the value
+ * @param writer The binary writer
+ * @param scratch Storage reused for decoding strings
+ * @param depth The nesting depth of the value, where the entries of the encoded object or array are at depth one
+ * @return A pointer to the first character after the value
+ * \exception json::parsing_error Thrown if the value is malformed, nested too deeply or contains a number that is too large
+ */
+template<typename W>
+static const char* encode_binary_value(const char *input, W &writer, std::string &scratch, const size_t depth)
+{
+    const char *index = json::parsing::tlws(input);
+    switch (json::jtype::peek(*index))
+    {
+    case json::jtype::jstring:
+        scratch.clear();
+        index = json::parsing::decode_string(index, scratch);
+        writer.string(scratch.data(), scratch.size());
+        return index;
+    case json::jtype::jnumber:
+        return encode_binary_number(index, writer);
+    case json::jtype::jbool:
+        writer.boolean(*index == 't');
+        return index + (*index == 't' ? 4 : 5);
+    case json::jtype::jnull:
+        writer.null();
+        return index + 4;
+    case json::jtype::jarray:
+        if(depth >= BINARY_NESTING_LIMIT) throw json::parsing_error("Input is nested too deeply");
+        writer.array(count_elements(index));
+        index = json::parsing::tlws(index + 1);
+        while(*index != ']')
+        {
+            index = next_element(encode_binary_value(index, writer, scratch, depth + 1));
+        }
+        return index + 1;
+    case json::jtype::jobject:
+        if(depth >= BINARY_NESTING_LIMIT) throw json::parsing_error("Input is nested too deeply");
+        writer.map(count_elements(index));
+        index = json::parsing::tlws(index + 1);
+        while(*index != '}')
+        {
+            scratch.clear();
+            index = json::parsing::decode_string(index, scratch);
+            writer.string(scratch.data(), scratch.size());
+            index = json::parsing::tlws(index) + 1;
+            index = next_element(encode_binary_value(index, writer, scratch, depth + 1));
+        }
+        return index + 1;
+    case json::jtype::not_valid:
+        break;
+    }
+    throw json::parsing_error("Input is not a valid value");
+}
+
+/*! \brief Writes the entries of an object or array in a binary format
+ *
+ * @param data The entries
+ * @param array True if the entries are the elements of an array
+ * @param writer The binary writer
+ */
+template<typename W>
+static void encode_binary_object(const std::vector<json::kvp> &data, const bool array, W &writer)
+{
+    std::string scratch;
+    if(array) writer.array(data.size());
+    else writer.map(data.size());
+    for(size_t i = 0; i < data.size(); i++)
+    {
+        if(!array) writer.string(data[i].first.data(), data[i].first.size());
+        encode_binary_value(data[i].second.c_str(), writer, scratch, 1);
+    }
+}
+
+std::string json::jobject::as_cbor() const
+{
+    JSON_STATS_SCOPE(SERIALIZE);
+    std::string result;
+    cbor_writer writer(result);
+    encode_binary_object(this->data, this->array_flag, writer);
+    return result;
+}
+
+std::string json::jobject::as_msgpack() const
+{
+    JSON_STATS_SCOPE(SERIALIZE);
+    std::string result;
+    msgpack_writer writer(result);
+    encode_binary_object(this->data, this->array_flag, writer);
+    return result;
+}
+
+/*! \brief Kinds of data items shared by the binary formats */
+enum binary_type
+{
+    BINARY_NULL,
+    BINARY_BOOLEAN,
+    BINARY_UNSIGNED,
+    BINARY_NEGATIVE,
+    BINARY_FLOAT,
+    BINARY_STRING,
+    BINARY_ARRAY,
+    BINARY_MAP,
+    BINARY_BREAK
+};
+
+/*! \brief The header of a data item in a binary format */
+struct binary_item
+{
+    /*! \brief The kind of data item */
+    binary_type type;
+
+    /*! \brief The value of a boolean, the magnitude of an integer, or the length of a string, array or map
+     *
+     * \note The value of a negative integer is -1 - value
+     */
+    uint64_t value;
+
+    /*! \brief The value of a floating-point number */
+    double floating;
+
+    /*! \brief True if the length of a string, array or map is not known up front */
+    bool indefinite;
+
+    /*! \brief Constructor
+     *
+     * @param type The kind of data item
+     * @param value The value or length of the data item
+     */
+    binary_item(const binary_type type = BINARY_NULL, const uint64_t value = 0)
+        : type(type), value(value), floating(0), indefinite(false)
+    { }
+};
+
+/*! \brief Bounds-checked reading of encoded bytes */
+struct binary_input
+{
+    /*! \brief The next byte */
+    const unsigned char *index;
+
+    /*! \brief The end of the input */
+    const unsigned char *end;
+
+    /*! \brief Constructor
+     *
+     * @param input The encoded bytes
+     * @param length The number of bytes
+     */
+    binary_input(const char *input, const size_t length)
+        : index((const unsigned char *)input), end((const unsigned char *)input + length)
+    { }
+
+    /*! \brief Throws if fewer than the requested number of bytes remain */
+    void require(const uint64_t bytes) const
+    {
+        if(bytes > (uint64_t)(this->end - this->index)) throw json::parsing_error("Unexpected end of input");
+    }
+
+    /*! \brief Reads a single byte */
+    unsigned char byte()
+    {
+        this->require(1);
+        return *this->index++;
+    }
+
+    /*! \brief Reads a big-endian unsigned integer
+     *
+     * @param bytes The width of the integer in bytes
+     */
+    uint64_t big_endian(const unsigned int bytes)
+    {
+        this->require(bytes);
+        uint64_t result = 0;
+        for(unsigned int i = 0; i < bytes; i++) result = (result << 8) | *this->index++;
+        return result;
+    }
+
+    /*! \brief Reads a single-precision floating-point value */
+    double read_float()
+    {
+        const uint32_t bits = (uint32_t)this->big_endian(4);
+        float result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    /*! \brief Reads a double-precision floating-point value */
+    double read_double()
+    {
+        const uint64_t bits = this->big_endian(8);
+        double result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    /*! \brief Appends raw bytes to a string
+     *
+     * @param length The number of bytes
+     * @param output The string to append to
+     */
+    void read_bytes(const uint64_t length, std::string &output)
+    {
+        this->require(length);
+        output.append((const char *)this->index, (size_t)length);
+        this->index += length;
+    }
+};
+
+/*! \brief Converts an IEEE 754 half-precision value to a double */
+static double half_to_double(const unsigned int half)
+{
+    const int exponent = (int)((half >> 10) & 0x1F);
+    const unsigned int mantissa = half & 0x3FF;
+    if(exponent == 0x1F) throw json::parsing_error("Non-finite numbers cannot be represented in JSON");
+    const double result = exponent == 0 ? ldexp((double)mantissa, -24) : ldexp((double)(mantissa + 0x400), exponent - 25);
+    return (half & 0x8000) != 0 ? -result : result;
+}
+
+/*! \brief Reads data items in CBOR (RFC 8949) */
+struct cbor_reader : public binary_input
+{
+    /*! \brief Constructor
+     *
+     * @param input The encoded bytes
+     * @param length The number of bytes
+     */
+    cbor_reader(const char *input, const size_t length) : binary_input(input, length) { }
+
+    /*! \brief Reads the header of the next data item
+     *
+     * \exception json::parsing_error Thrown if the data item is malformed or cannot be represented in JSON
+     */
+    binary_item next()
+    {
+        // Tags are skipped iteratively, and chains longer than the nesting limit are rejected
+        for(size_t tags = 0; ; tags++)
+        {
+            if(tags > BINARY_NESTING_LIMIT) throw json::parsing_error("Too many tags");
+            const unsigned char initial = this->byte();
+            const unsigned char major = initial >> 5;
+            const unsigned char info = initial & 0x1F;
+            if(major == 7) {
+                binary_item result(BINARY_FLOAT);
+                switch (info)
+                {
+                case 20:
+                    return binary_item(BINARY_BOOLEAN, 0);
+                case 21:
+                    return binary_item(BINARY_BOOLEAN, 1);
+                case 22:
+                case 23:
+                    // Undefined has no JSON equivalent, so it is treated as null
+                    return binary_item(BINARY_NULL);
+                case 25:
+                    result.floating = half_to_double((unsigned int)this->big_endian(2));
+                    return result;
+                case 26:
+                    result.floating = this->read_float();
+                    return result;
+                case 27:
+                    result.floating = this->read_double();
+                    return result;
+                case 31:
+                    return binary_item(BINARY_BREAK);
+                default:
+                    throw json::parsing_error("Unsupported simple value");
+                }
+            }
+
+            binary_item result;
+            if(info < 24) result.value = info;
+            else if(info <= 27) result.value = this->big_endian(1U << (info - 24));
+            else if(info == 31 && major >= 2 && major <= 5) result.indefinite = true;
+            else throw json::parsing_error("Invalid additional information");
+
+            switch (major)
+            {
+            case 0:
+                result.type = BINARY_UNSIGNED;
+                return result;
+            case 1:
+                result.type = BINARY_NEGATIVE;
+                return result;
+            case 3:
+                result.type = BINARY_STRING;
+                return result;
+            case 4:
+                result.type = BINARY_ARRAY;
+                return result;
+            case 5:
+                result.type = BINARY_MAP;
+                return result;
+            case 6:
+                // Tags carry no meaning in JSON, so the tagged value is used as-is
+                continue;
+            default:
+                throw json::parsing_error("Byte strings cannot be represented in JSON");
+            }
+        }
+    }
+
+    /*! \brief Reads the content of a text string
+     *
+     * @param item The header of the string
+     * @param output The string to append the content to
+     */
+    void string(const binary_item &item, std::string &output)
+    {
+        if(!item.indefinite) {
+            this->read_bytes(item.value, output);
+            return;
+        }
+
+        // Indefinite-length strings are a sequence of definite-length chunks
+        while(true)
+        {
+            const binary_item chunk = this->next();
+            if(chunk.type == BINARY_BREAK) return;
+            if(chunk.type != BINARY_STRING || chunk.indefinite) throw json::parsing_error("Invalid string chunk");
+            this->read_bytes(chunk.value, output);
+        }
+    }
+};
+
+/*! \brief Reads data items in MessagePack */
+struct msgpack_reader : public binary_input
+{
+    /*! \brief Constructor
+     *
+     * @param input The encoded bytes
+     * @param length The number of bytes
+     */
+    msgpack_reader(const char *input, const size_t length) : binary_input(input, length) { }
+
+    /*! \brief Reads a signed integer
+     *
+     * @param bytes The width of the integer in bytes
+     */
+    binary_item read_signed(const unsigned int bytes)
+    {
+        const uint64_t raw = this->big_endian(bytes);
+        const uint64_t sign = (uint64_t)1 << (8 * bytes - 1);
+        if((raw & sign) == 0) return binary_item(BINARY_UNSIGNED, raw);
+
+        // The magnitude of a negative value is the complement of its two's complement representation
+        return binary_item(BINARY_NEGATIVE, ~raw & (sign | (sign - 1)));
+    }
+
+    /*! \brief Reads the header of the next data item
+     *
+     * \exception json::parsing_error Thrown if the data item is malformed or cannot be represented in JSON
+     */
+    binary_item next()
+    {
+        const unsigned char format = this->byte();
+        if(format < 0x80) return binary_item(BINARY_UNSIGNED, format);
+        if(format < 0x90) return binary_item(BINARY_MAP, format & 0x0F);
+        if(format < 0xA0) return binary_item(BINARY_ARRAY, format & 0x0F);
+        if(format < 0xC0) return binary_item(BINARY_STRING, format & 0x1F);
+        if(format >= 0xE0) return binary_item(BINARY_NEGATIVE, 0xFF - format);
+
+        binary_item result(BINARY_FLOAT);
+        switch (format)
+        {
+        case 0xC0:
+            return binary_item(BINARY_NULL);
+        case 0xC2:
+            return binary_item(BINARY_BOOLEAN, 0);
+        case 0xC3:
+            return binary_item(BINARY_BOOLEAN, 1);
+        case 0xCA:
+            result.floating = this->read_float();
+            return result;
+        case 0xCB:
+            result.floating = this->read_double();
+            return result;
+        case 0xCC:
+        case 0xCD:
+        case 0xCE:
+        case 0xCF:
+            return binary_item(BINARY_UNSIGNED, this->big_endian(1U << (format - 0xCC)));
+        case 0xD0:
+        case 0xD1:
+        case 0xD2:
+        case 0xD3:
+            return this->read_signed(1U << (format - 0xD0));
+        case 0xD9:
+        case 0xDA:
+        case 0xDB:
+            return binary_item(BINARY_STRING, this->big_endian(1U << (format - 0xD9)));
+        case 0xDC:
+        case 0xDD:
+            return binary_item(BINARY_ARRAY, this->big_endian(2U << (format - 0xDC)));
+        case 0xDE:
+        case 0xDF:
+            return binary_item(BINARY_MAP, this->big_endian(2U << (format - 0xDE)));
+        default:
+            throw json::parsing_error("Binary and extension types cannot be represented in JSON");
+        }
+    }
+
+    /*! \brief Reads the content of a string
+     *
+     * @param item The header of the string
+     * @param output The string to append the content to
+     */
+    void string(const binary_item &item, std::string &output)
+    {
+        this->read_bytes(item.value, output);
+    }
+};
+
+/*! \brief Appends the decimal representation of an unsigned integer */
+static void append_decimal(uint64_t value, std::string &output)
+{
+    char buffer[20];
+    size_t length = 0;
+    do
+    {
+        buffer[sizeof(buffer) - ++length] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    output.append(buffer + sizeof(buffer) - length, length);
+}
+
+/*! \brief Appends the shortest representation of a floating-point value that reads back exactly */
+static void append_floating(const double value, std::string &output)
+{
+    if(value != value || value - value != 0) throw json::parsing_error("Non-finite numbers cannot be represented in JSON");
+    char buffer[32];
+    for(int precision = 1; precision <= 17; precision++)
+    {
+        JSON_STATS_COUNT(FORMAT_CALLS, 1);
+        std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+        if(strtod(buffer, NULL) == value) break;
+    }
+    output += buffer;
+
+    // Keep integral values floating-point numbers so they encode the same way again
+    if(strpbrk(buffer, ".eE") == NULL) output += ".0";
+}
+
+/*! \brief Serializes a data item read from a binary format
+ *
+ * @tparam R The binary reader
+ * @param reader The binary reader
+ * @param item The header of the data item
+ * @param output The string to append the serialized value to
+ * @param scratch Storage reused for decoding strings
+ * @param depth The nesting depth of the data item, where the entries of the root map or array are at depth one
+ * \exception json::parsing_error Thrown if the data item is malformed, nested too deeply or cannot be represented in JSON
+ */
+template<typename R>
+static void decode_binary_value(R &reader, const binary_item &item, std::string &output, std::string &scratch, const size_t depth)
+{
+    switch (item.type)
+    {
+    case BINARY_NULL:
+        output += "null";
+        return;
+    case BINARY_BOOLEAN:
+        output += item.value != 0 ? "true" : "false";
+        return;
+    case BINARY_UNSIGNED:
+        append_decimal(item.value, output);
+        return;
+    case BINARY_NEGATIVE:
+        output += '-';
+        if(item.value == ~(uint64_t)0) output += "18446744073709551616";
+        else append_decimal(item.value + 1, output);
+        return;
+    case BINARY_FLOAT:
+        append_floating(item.floating, output);
+        return;
+    case BINARY_STRING:
+        scratch.clear();
+        reader.string(item, scratch);
+        json::parsing::encode_string(scratch.data(), scratch.size(), output);
+        return;
+    case BINARY_ARRAY:
+    case BINARY_MAP:
+    {
+        if(depth >= BINARY_NESTING_LIMIT) throw json::parsing_error("Input is nested too deeply");
+        const bool is_map = item.type == BINARY_MAP;
+        output += is_map ? '{' : '[';
+        for(uint64_t i = 0; item.indefinite || i < item.value; i++)
+        {
+            binary_item next = reader.next();
+            if(next.type == BINARY_BREAK && item.indefinite) break;
+            if(i > 0) output += ',';
+            if(is_map) {
+                if(next.type != BINARY_STRING) throw json::parsing_error("Map keys must be strings");
+                scratch.clear();
+                reader.string(next, scratch);
+                json::parsing::encode_string(scratch.data(), scratch.size(), output);
+                output += ':';
+                next = reader.next();
+            }
+            decode_binary_value(reader, next, output, scratch, depth + 1);
+        }
+        output += is_map ? '}' : ']';
+        return;
+    }
+    case BINARY_BREAK:
+        break;
+    }
+    throw json::parsing_error("Unexpected break");
+}
+
+/*! \brief Parses a map or array read from a binary format
+ *
+ * @tparam R The binary reader
+ * @param reader The binary reader
+ * @return JSON object or array
+ */
+template<typename R>
+static json::jobject decode_binary_object(R &reader)
+{
+    const binary_item root = reader.next();
+    if(root.type != BINARY_MAP && root.type != BINARY_ARRAY) throw json::parsing_error("Input is not a valid object");
+    json::jobject result(root.type == BINARY_ARRAY);
+    std::string scratch;
+    for(uint64_t i = 0; root.indefinite || i < root.value; i++)
+    {
+        binary_item next = reader.next();
+        if(next.type == BINARY_BREAK && root.indefinite) break;
+        json::kvp entry;
+        if(root.type == BINARY_MAP) {
+            if(next.type != BINARY_STRING) throw json::parsing_error("Map keys must be strings");
+            reader.string(next, entry.first);
+            next = reader.next();
+        }
+        decode_binary_value(reader, next, entry.second, scratch, 1);
+        result += JSON_MOVE(entry);
+    }
+    if(reader.index != reader.end) throw json::parsing_error("Unexpected data after value");
+    return result;
+}
+
+json::jobject json::jobject::parse_cbor(const char *input, const size_t length)
+{
+    JSON_STATS_SCOPE(PARSE);
+    cbor_reader reader(input, length);
+    return decode_binary_object(reader);
+}
+
+json::jobject json::jobject::parse_msgpack(const char *input, const size_t length)
+{
+    JSON_STATS_SCOPE(PARSE);
+    msgpack_reader reader(input, length);
+    return decode_binary_object(reader);
+}
+
+json::packed_object::packed_object(const json::jobject &source)
+    : array_flag(source.array_flag), indexed_entries(0)
+{
+    size_t length = 0;
+    for(size_t i = 0; i < source.size(); i++) length += source.data[i].first.size() + source.data[i].second.size();
+    this->reserve(source.size(), length);
+    for(size_t i = 0; i < source.size(); i++) this->append(source.data[i].first, source.data[i].second);
+}
+
+json::packed_object json::packed_object::parse(const char *input, const bool validate_utf8)
+{
+    return parse_container<json::packed_object>(input, validate_utf8);
+}
+
+uint32_t json::packed_object::store(const char *input, const size_t length)
+{
+    const size_t offset = this->buffer.size();
+    if(length > (uint32_t)-1 - offset) throw std::length_error("Packed object is too large");
+    this->buffer.append(input, length);
+    return (uint32_t)offset;
+}
+
+void json::packed_object::append(const std::string &key, const std::string &value)
+{
+    slot next;
+    next.key_length = (uint32_t)key.size();
+    next.key_offset = this->store(key.data(), key.size());
+    next.value_length = (uint32_t)value.size();
+    next.value_offset = this->store(value.data(), value.size());
+    this->slots.push_back(next);
+}
+
+bool json::packed_object::key_equals(const size_t index, const char *key, const size_t length) const
+{
+    const slot &target = this->slots[index];
+    return target.key_length == length && memcmp(this->buffer.data() + target.key_offset, key, length) == 0;
+}
+
+size_t json::packed_object::find(const char *key, const size_t length) const
+{
+    const size_t count = this->slots.size();
+    if(count < KEY_INDEX_MINIMUM) {
+        for(size_t i = 0; i < count; i++)
+        {
+            if(this->key_equals(i, key, length)) return i;
+        }
+        return count;
+    }
+
+    // Indexed like json::jobject::find_key, so that appending while checking for conflicts stays linear
+    if(this->key_index.size() < 2 * count || this->indexed_entries > count) {
+        size_t capacity = 2 * KEY_INDEX_MINIMUM;
+        while(capacity < 4 * count) capacity *= 2;
+        this->key_index.assign(capacity, 0);
+        this->indexed_entries = 0;
+    }
+    const size_t mask = this->key_index.size() - 1;
+    for(; this->indexed_entries < count; this->indexed_entries++)
+    {
+        const slot &target = this->slots[this->indexed_entries];
+        const char *name = this->buffer.data() + target.key_offset;
+        size_t position = (size_t)hash_string(name, target.key_length) & mask;
+        while(this->key_index[position] != 0 && !this->key_equals(this->key_index[position] - 1, name, target.key_length)) position = (position + 1) & mask;
+        if(this->key_index[position] == 0) this->key_index[position] = (uint32_t)this->indexed_entries + 1;
+    }
+
+    for(size_t position = (size_t)hash_string(key, length) & mask; this->key_index[position] != 0; position = (position + 1) & mask)
+    {
+        if(this->key_equals(this->key_index[position] - 1, key, length)) return this->key_index[position] - 1;
+    }
+    return count;
+}
+
+json::packed_object& json::packed_object::operator+=(const json::kvp &other)
+{
+    if(this->array_flag && other.first != "") throw json::parsing_error("Array cannot have key");
+    if(!this->array_flag && other.first == "") throw json::parsing_error("Missing key");
+    if(!this->array_flag && this->has_key(other.first)) throw json::parsing_error("Key conflict");
+    this->append(other.first, other.second);
+    return *this;
+}
+
+json::key_list_t json::packed_object::list_keys() const
+{
+    json::key_list_t result;
+    if(this->array_flag) return result;
+    result.reserve(this->size());
+    for(size_t i = 0; i < this->size(); i++) result.push_back(this->key(i));
+    return result;
+}
+
+std::string json::packed_object::get(const std::string &key) const
+{
+    const size_t index = this->array_flag ? this->size() : this->find(key.data(), key.length());
+    if(index == this->size()) throw json::invalid_key(key);
+    return this->get(index);
+}
+
+json::jobject json::packed_object::as_object() const
+{
+    json::jobject result(this->array_flag);
+    for(size_t i = 0; i < this->size(); i++)
+    {
+        const slot &target = this->slots[i];
+        result += json::kvp(
+            this->buffer.substr(target.key_offset, target.key_length),
+            this->buffer.substr(target.value_offset, target.value_length));
+    }
+    return result;
+}
+
+std::string json::packed_object::as_string() const
+{
+    // The buffer holds every key and value, so only the punctuation needs to be added
+    std::string result;
+    result.reserve(this->buffer.size() + 4 * this->size() + 2);
+    const char *base = this->buffer.data();
+    result += this->array_flag ? '[' : '{';
+    for(size_t i = 0; i < this->size(); i++)
+    {
+        const slot &target = this->slots[i];
+        if(i > 0) result += ',';
+        if(!this->array_flag) {
+            json::parsing::encode_string(base + target.key_offset, target.key_length, result);
+            result += ':';
+        }
+        result.append(base + target.value_offset, target.value_length);
+    }
+    result += this->array_flag ? ']' : '}';
+    return result;
+}
+
+/*! \brief Types with the strictest alignment requirements of the values stored in an arena */
+union arena_alignment
+{
+    double floating;
+    uint64_t integer;
+    void *pointer;
+};
+
+/*! \brief Alignment of memory allocated from an arena */
+#define ARENA_ALIGNMENT sizeof(arena_alignment)
+
+/*! \brief Rounds a size up to a multiple of the arena alignment */
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1))
+
+json::arena::arena(const size_t chunk_size)
+    : chunks(NULL), buffer(NULL), buffer_size(0), cursor(NULL), remaining(0), chunk_size(ARENA_ALIGN(chunk_size)), allocated(0)
+{ }
+
+json::arena::arena(void *buffer, const size_t size, const size_t chunk_size)
+    : chunks(NULL), buffer((char*)buffer), buffer_size(size), cursor(NULL), remaining(0), chunk_size(ARENA_ALIGN(chunk_size)), allocated(0)
+{
+    this->rewind();
+}
+
+json::arena::~arena()
+{
+    this->reset();
+}
+
+void json::arena::rewind()
+{
+    this->cursor = NULL;
+    this->remaining = 0;
+    if(this->buffer == NULL) return;
+    const size_t padding = (ARENA_ALIGNMENT - (size_t)((uintptr_t)this->buffer % ARENA_ALIGNMENT)) % ARENA_ALIGNMENT;
+    if(padding >= this->buffer_size) return;
+    this->cursor = this->buffer + padding;
+    this->remaining = this->buffer_size - padding;
+}
+
+void* json::arena::allocate(const size_t size)
+{
+    const size_t aligned = ARENA_ALIGN(size > 0 ? size : 1);
+    if(aligned > this->remaining) {
+        const size_t header = ARENA_ALIGN(sizeof(chunk));
+        const size_t chunk_bytes = aligned > this->chunk_size ? aligned : this->chunk_size;
+        chunk *next = (chunk*)::operator new(header + chunk_bytes);
+        next->size = chunk_bytes;
+        next->next = this->chunks;
+        this->chunks = next;
+        this->allocated += aligned;
+
+        // Oversized requests get a dedicated chunk so the free space following the cursor is not lost
+        if(aligned > this->chunk_size) return (char*)next + header;
+        this->cursor = (char*)next + header + aligned;
+        this->remaining = chunk_bytes - aligned;
+        return (char*)next + header;
+    }
+    void *result = this->cursor;
+    this->cursor += aligned;
+    this->remaining -= aligned;
+    this->allocated += aligned;
+    return result;
+}
+
+char* json::arena::copy(const char *input, const size_t length)
+{
+    char *result = (char*)this->allocate(length + 1);
+    memcpy(result, input, length);
+    result[length] = '\0';
+    return result;
+}
+
+void json::arena::reset()
+{
+    while(this->chunks != NULL)
+    {
+        chunk *next = this->chunks->next;
+        ::operator delete(this->chunks);
+        this->chunks = next;
+    }
+    this->allocated = 0;
+    this->rewind();
+}
+
+size_t json::arena::capacity() const
+{
+    size_t result = this->buffer_size;
+    for(const chunk *index = this->chunks; index != NULL; index = index->next) result += index->size;
+    return result;
+}
+
+/*! \brief The initial size of the hash table of a key pool */
+#define KEY_POOL_INITIAL_SIZE 16
+
+json::key_pool::key_pool(const size_t chunk_size)
+    : memory(chunk_size), count(0)
+{ }
+
+json::key_pool& json::key_pool::global()
+{
+    static json::key_pool instance;
+    return instance;
+}
+
+size_t json::key_pool::find_slot(const char *input, const size_t length, const uint64_t hash) const
+{
+    assert(!this->table.empty());
+    const size_t mask = this->table.size() - 1;
+    size_t index = (size_t)hash & mask;
+    while(true)
+    {
+        const slot &candidate = this->table[index];
+        if(candidate.text == NULL) return index;
+        if(candidate.hash == hash && candidate.length == length && memcmp(candidate.text, input, length) == 0) return index;
+        index = (index + 1) & mask;
+    }
+}
+
+void json::key_pool::grow()
+{
+    slot empty;
+    empty.text = NULL;
+    empty.length = 0;
+    empty.hash = 0;
+    std::vector<slot> previous(this->table.empty() ? KEY_POOL_INITIAL_SIZE : this->table.size() * 2, empty);
+    previous.swap(this->table);
+    for(size_t i = 0; i < previous.size(); i++)
+    {
+        if(previous[i].text == NULL) continue;
+        this->table[this->find_slot(previous[i].text, previous[i].length, previous[i].hash)] = previous[i];
+    }
+}
+
+json::key_pool::key json::key_pool::intern(const char *input, const size_t length)
+{
+    // Keep the table at most half full
+    if((this->count + 1) * 2 > this->table.size()) this->grow();
+    const uint64_t hash = hash_string(input, length);
+    slot &target = this->table[this->find_slot(input, length, hash)];
+    if(target.text == NULL) {
+        target.text = this->memory.copy(input, length);
+        target.length = length;
+        target.hash = hash;
+        this->count++;
+    }
+    return key(this, target.text, target.length);
+}
+
+json::key_pool::key json::key_pool::find(const char *input, const size_t length) const
+{
+    if(this->table.empty()) return key();
+    const slot &target = this->table[this->find_slot(input, length, hash_string(input, length))];
+    if(target.text == NULL) return key();
+    return key(this, target.text, target.length);
+}
+
+void json::key_pool::clear()
+{
+    this->table.clear();
+    this->count = 0;
+    this->memory.reset();
+}
+
+json::document::document(const size_t chunk_size, json::key_pool *keys)
+    : memory(new json::arena(chunk_size)), owns_memory(true), keys(keys), root_node(NULL)
+{ }
+
+json::document::document(json::arena &memory, json::key_pool *keys)
+    : memory(&memory), owns_memory(false), keys(keys), root_node(NULL)
+{ }
+
+json::document::~document()
+{
+    if(this->owns_memory) delete this->memory;
+}
+
+void json::document::clear()
+{
+    this->root_node = NULL;
+    if(this->owns_memory) this->memory->reset();
+}
+
+void json::document::parse(const char *input, const bool validate_utf8)
+{
+    JSON_STATS_SCOPE(PARSE);
+    this->clear();
+    const size_t length = strlen(input);
+    if(validate_utf8) {
+        const size_t offset = json::parsing::validate_utf8(input, length);
+        if(offset != length) throw json::invalid_utf8(offset);
+    }
+
+    // Values refer to a copy of the input so the document does not depend on the caller's buffer
+    const char *index = this->memory->copy(input, length);
+    node *result = this->parse_value(index);
+    index = json::parsing::tlws(index);
+    if(!EMPTY_STRING(index)) throw json::parsing_error("Unexpected characters after value");
+    this->root_node = result;
+    JSON_STATS_COUNT_INPUT(length);
+}
+
+json::document::value json::document::root() const
+{
+    if(this->root_node == NULL) throw std::logic_error("Nothing has been parsed");
+    return value(this->root_node, this->keys);
+}
+
+/*! \brief Skips a serialized number
+ *
+ * @param input Pointer to the number
+ * @return A pointer to the first character after the number, or `NULL` if the number is not valid
+ */
+static const char* skip_number(const char *input)
+{
+    const char *index = input;
+    if(*index == '-') index++;
+    if(*index == '0') {
+        index++;
+    } else if(IS_DIGIT(*index)) {
+        while(IS_DIGIT(*index)) index++;
+    } else {
+        return NULL;
+    }
+    if(*index == '.') {
+        index++;
+        if(!IS_DIGIT(*index)) return NULL;
+        while(IS_DIGIT(*index)) index++;
+    }
+    if(*index == 'e' || *index == 'E') {
+        index++;
+        if(*index == '+' || *index == '-') index++;
+        if(!IS_DIGIT(*index)) return NULL;
+        while(IS_DIGIT(*index)) index++;
+    }
+    return index;
+}
+
+const char* json::document::parse_string(const char *&index, size_t &length)
+{
+    assert(*index == '"');
+    const char *end = skip_string(index);
+    if(end == NULL) throw json::parsing_error("Expecting closing quote");
+
+    // Decoding never lengthens a string, so the serialized length is enough
+    char *result = (char*)this->memory->allocate((size_t)(end - index) - 1);
+    const char *next = index + 1;
+    length = 0;
+    while(true)
+    {
+        const size_t run = strcspn(next, "\"\\");
+        memcpy(result + length, next, run);
+        length += run;
+        next += run;
+        if(*next == '"') break;
+        assert(*next == '\\');
+        size_t decoded;
+        next = decode_escape(next + 1, result + length, decoded);
+        length += decoded;
+    }
+    result[length] = '\0';
+    index = end;
+    return result;
+}
+
+const char* json::document::parse_key(const char *&index, size_t &length)
+{
+    if(this->keys == NULL) return this->parse_string(index, length);
+
+    // Keys without escapes are interned straight from the input
+    const size_t run = strcspn(index + 1, "\"\\");
+    if(index[run + 1] == '"') {
+        const json::key_pool::key result = this->keys->intern(index + 1, run);
+        index += run + 2;
+        length = run;
+        return result.c_str();
+    }
+    const char *decoded = this->parse_string(index, length);
+    return this->keys->intern(decoded, length).c_str();
+}
+
+json::document::node* json::document::parse_value(const char *&index)
+{
+    index = json::parsing::tlws(index);
+    node *result = (node*)this->memory->allocate(sizeof(node));
+    result->type = json::jtype::peek(*index);
+    result->key = NULL;
+    result->key_length = 0;
+    result->text = index;
+    result->length = 0;
+    result->size = 0;
+    result->first_child = NULL;
+    result->next_sibling = NULL;
+
+    const char *start = index;
+    switch (result->type)
+    {
+    case json::jtype::jstring:
+        result->text = this->parse_string(index, result->length);
+        return result;
+    case json::jtype::jnumber:
+        index = skip_number(index);
+        if(index == NULL) throw json::parsing_error("Invalid number");
+        break;
+    case json::jtype::jbool:
+        if(strncmp(index, "true", 4) == 0) index += 4;
+        else if(strncmp(index, "false", 5) == 0) index += 5;
+        else throw json::parsing_error("Invalid boolean");
+        break;
+    case json::jtype::jnull:
+        if(strncmp(index, "null", 4) != 0) throw json::parsing_error("Invalid null value");
+        index += 4;
+        break;
+    case json::jtype::jarray:
+    case json::jtype::jobject:
+    {
+        const bool is_object = result->type == json::jtype::jobject;
+        const char close = is_object ? '}' : ']';
+        node **tail = &result->first_child;
+        index = json::parsing::tlws(index + 1);
+        if(*index != close) {
+            while(true)
+            {
+                const char *key = NULL;
+                size_t key_length = 0;
+                if(is_object) {
+                    index = json::parsing::tlws(index);
+                    if(*index != '"') throw json::parsing_error("Expected key");
+                    key = this->parse_key(index, key_length);
+                    index = json::parsing::tlws(index);
+                    if(*index != ':') throw json::parsing_error("Expected ':'");
+                    index++;
+                }
+                node *child = this->parse_value(index);
+                child->key = key;
+                child->key_length = key_length;
+                *tail = child;
+                tail = &child->next_sibling;
+                result->size++;
+                index = json::parsing::tlws(index);
+                if(*index == ',') {
+                    index++;
+                } else if(*index == close) {
+                    break;
+                } else {
+                    throw json::parsing_error(is_object ? "Expected ',' or '}'" : "Expected ',' or ']'");
+                }
+            }
+        }
+        index++;
+        break;
+    }
+    case json::jtype::not_valid:
+        throw json::parsing_error("Unexpected character");
+    }
+    result->length = (size_t)(index - start);
+    return result;
+}
+
+const json::document::node& json::document::value::get_node() const
+{
+    if(this->target == NULL) throw std::logic_error("View does not refer to a value");
+    return *this->target;
+}
+
+const json::document::node* json::document::value::find(const char *key, const size_t length) const
+{
+    if(this->keys != NULL) return this->find(this->keys->find(key, length));
+    const node &source = this->get_node();
+    if(source.type != json::jtype::jobject) return NULL;
+    for(const node *index = source.first_child; index != NULL; index = index->next_sibling)
+    {
+        if(index->key_length == length && memcmp(index->key, key, length) == 0) return index;
+    }
+    return NULL;
+}
+
+const json::document::node* json::document::value::find(const json::key_pool::key &key) const
+{
+    if(this->keys == NULL || key.pool() != this->keys) {
+        if(!key.exists()) return NULL;
+        const json::document::value unpooled(this->target, NULL);
+        return unpooled.find(key.c_str(), key.length());
+    }
+
+    // Keys interned in the document's pool can be compared by address
+    const node &source = this->get_node();
+    if(!key.exists() || source.type != json::jtype::jobject) return NULL;
+    for(const node *index = source.first_child; index != NULL; index = index->next_sibling)
+    {
+        if(index->key == key.c_str()) return index;
+    }
+    return NULL;
+}
+
+bool json::document::value::has_key(const json::key_pool::key &key) const
+{
+    return this->find(key) != NULL;
+}
+
+json::document::value json::document::value::get(const json::key_pool::key &key) const
+{
+    const node *result = this->find(key);
+    if(result == NULL) throw json::invalid_key(key.exists() ? key.c_str() : "");
+    return value(result, this->keys);
+}
+
+json::document::value json::document::value::get(const std::string &key) const
+{
+    const node *result = this->find(key.data(), key.length());
+    if(result == NULL) throw json::invalid_key(key);
+    return value(result, this->keys);
+}
+
+json::document::value json::document::value::array(const size_t index) const
+{
+    const node &source = this->get_node();
+    if(index >= source.size) throw std::out_of_range("Index is out of range");
+    const node *result = source.first_child;
+    for(size_t i = 0; i < index; i++) result = result->next_sibling;
+    return value(result, this->keys);
+}
+
+json::document::value::operator int() const { return this->get_number<int>(INT_FORMAT); }
+json::document::value::operator unsigned int() const { return this->get_number<unsigned int>(UINT_FORMAT); }
+json::document::value::operator long() const { return this->get_number<long>(LONG_FORMAT); }
+json::document::value::operator unsigned long() const { return this->get_number<unsigned long>(ULONG_FORMAT); }
+json::document::value::operator float() const { return this->get_number<float>(FLOAT_FORMAT); }
+json::document::value::operator double() const { return this->get_number<double>(DOUBLE_FORMAT); }
+
+/*! \brief Identifies snapshots */
+#define SNAPSHOT_MAGIC "SJSN"
+
+/*! \brief The version of the snapshot format */
+#define SNAPSHOT_VERSION 1
+
+/*! \brief The size of the snapshot header: magic, version, total size and root offset */
+#define SNAPSHOT_HEADER_SIZE 16
+
+/*! \brief Types of values stored in a snapshot */
+enum snapshot_type
+{
+    SNAPSHOT_NULL = 0,
+    SNAPSHOT_FALSE = 1,
+    SNAPSHOT_TRUE = 2,
+    SNAPSHOT_NUMBER = 3,
+    SNAPSHOT_STRING = 4,
+    SNAPSHOT_ARRAY = 5,
+    SNAPSHOT_OBJECT = 6
+};
+
+/*! \brief Returns the current size of a snapshot as an offset
+ *
+ * \exception std::length_error Thrown if the snapshot exceeds the range of 32-bit offsets
+ */
+static uint32_t snapshot_offset(const std::string &output)
+{
+    if(output.size() > 0xFFFFFFFFUL) throw std::length_error("Snapshot is too large");
+    return (uint32_t)output.size();
+}
+
+/*! \brief Overwrites a 32-bit little-endian word in a snapshot */
+static void set_snapshot_word(std::string &output, const size_t offset, const uint32_t value)
+{
+    for(unsigned int i = 0; i < 4; i++) output[offset + i] = (char)(unsigned char)(value >> (8 * i));
+}
+
+/*! \brief Appends a 32-bit little-endian word to a snapshot */
+static void put_snapshot_word(std::string &output, const uint32_t value)
+{
+    output.append(4, '\0');
+    set_snapshot_word(output, output.size() - 4, value);
+}
+
+/*! \brief Appends a string or number to a snapshot
+ *
+ * @return The offset of the value
+ */
+static uint32_t write_snapshot_text(std::string &output, const snapshot_type type, const char *input, const size_t length)
+{
+    const uint32_t result = snapshot_offset(output);
+    put_snapshot_word(output, type);
+    put_snapshot_word(output, (uint32_t)length);
+    output.append(input, length);
+
+    // Terminate the characters and keep the next value aligned to a word
+    output.append(4 - length % 4, '\0');
+    return result;
+}
+
+/*! \brief Orders the members of an object by key */
+struct snapshot_key_order
+{
+    /*! \brief The members of the object */
+    const std::vector<json::document::value> &members;
+
+    /*! \brief Constructor */
+    snapshot_key_order(const std::vector<json::document::value> &members) : members(members) { }
+
+    /*! \brief Compares the keys of two members */
+    bool operator()(const uint32_t lhs, const uint32_t rhs) const
+    {
+        const json::document::value &left = this->members[lhs];
+        const json::document::value &right = this->members[rhs];
+        const size_t length = left.key_length() < right.key_length() ? left.key_length() : right.key_length();
+        const int comparison = memcmp(left.key(), right.key(), length);
+        return comparison < 0 || (comparison == 0 && left.key_length() < right.key_length());
+    }
+};
+
+/*! \brief Appends a value to a snapshot
+ *
+ * @return The offset of the value
+ */
+static uint32_t write_snapshot_value(const json::document::value &input, std::string &output)
+{
+    switch (input.type())
+    {
+    case json::jtype::jstring:
+        return write_snapshot_text(output, SNAPSHOT_STRING, input.data(), input.length());
+    case json::jtype::jnumber:
+        return write_snapshot_text(output, SNAPSHOT_NUMBER, input.data(), input.length());
+    case json::jtype::jbool:
+    case json::jtype::jnull:
+    {
+        const uint32_t result = snapshot_offset(output);
+        put_snapshot_word(output, input.is_null() ? SNAPSHOT_NULL : input.is_true() ? SNAPSHOT_TRUE : SNAPSHOT_FALSE);
+        return result;
+    }
+    case json::jtype::jarray:
+    case json::jtype::jobject:
+    {
+        const bool is_object = input.is_object();
+        const uint32_t result = snapshot_offset(output);
+        const uint32_t count = (uint32_t)input.size();
+        put_snapshot_word(output, is_object ? SNAPSHOT_OBJECT : SNAPSHOT_ARRAY);
+        put_snapshot_word(output, count);
+
+        // Reserve the offset tables, which are filled in as the members are written
+        const size_t table = output.size();
+        output.append((size_t)count * (is_object ? 12 : 4), '\0');
+        std::vector<json::document::value> members;
+        members.reserve(count);
+        for(json::document::value member = input.first(); member.exists(); member = member.next()) members.push_back(member);
+        for(uint32_t i = 0; i < count; i++)
+        {
+            if(is_object) {
+                set_snapshot_word(output, table + 8 * i, write_snapshot_text(output, SNAPSHOT_STRING, members[i].key(), members[i].key_length()));
+                set_snapshot_word(output, table + 8 * i + 4, write_snapshot_value(members[i], output));
+            } else {
+                set_snapshot_word(output, table + 4 * i, write_snapshot_value(members[i], output));
+            }
+        }
+
+        if(is_object) {
+            // Members sorted by key allow lookups by binary search, with duplicate keys kept in their original order
+            std::vector<uint32_t> order(count);
+            for(uint32_t i = 0; i < count; i++) order[i] = i;
+            std::stable_sort(order.begin(), order.end(), snapshot_key_order(members));
+            for(uint32_t i = 0; i < count; i++) set_snapshot_word(output, table + 8 * (size_t)count + 4 * i, order[i]);
+        }
+        return result;
+    }
+    case json::jtype::not_valid:
+        break;
+    }
+    throw json::parsing_error("Input is not a valid value");
+}
+
+std::string json::snapshot::create(const char *input)
+{
+    json::document source;
+    source.parse(input);
+    std::string result(SNAPSHOT_MAGIC);
+    put_snapshot_word(result, SNAPSHOT_VERSION);
+    put_snapshot_word(result, 0);
+    put_snapshot_word(result, 0);
+    assert(result.size() == SNAPSHOT_HEADER_SIZE);
+    const uint32_t root = write_snapshot_value(source.root(), result);
+    set_snapshot_word(result, 8, snapshot_offset(result));
+    set_snapshot_word(result, 12, root);
+    return result;
+}
+
+json::snapshot::snapshot(const void *data, const size_t length)
+    : bytes((const unsigned char *)data), length(length)
+{
+    if(length < SNAPSHOT_HEADER_SIZE || memcmp(data, SNAPSHOT_MAGIC, 4) != 0) throw json::parsing_error("Input is not a snapshot");
+    if(this->word(4) != SNAPSHOT_VERSION) throw json::parsing_error("Unsupported snapshot version");
+
+    // Memory mapped files may be padded beyond the end of the snapshot
+    const uint32_t total = this->word(8);
+    if(total < SNAPSHOT_HEADER_SIZE || total > length) throw json::parsing_error("Snapshot is truncated");
+    this->length = total;
+    if(this->word(12) < SNAPSHOT_HEADER_SIZE) throw json::parsing_error("Snapshot is corrupt");
+    this->word(this->word(12));
+}
+
+uint32_t json::snapshot::word(const size_t offset) const
+{
+    if(offset > this->length || this->length - offset < 4) throw json::parsing_error("Snapshot is corrupt");
+    const unsigned char *index = this->bytes + offset;
+    return (uint32_t)index[0] | ((uint32_t)index[1] << 8) | ((uint32_t)index[2] << 16) | ((uint32_t)index[3] << 24);
+}
+
+const char* json::snapshot::text(const size_t offset, size_t &size) const
+{
+    size = this->word(offset + 4);
+    if(this->length - offset - 8 <= size || this->bytes[offset + 8 + size] != '\0') throw json::parsing_error("Snapshot is corrupt");
+    return (const char *)this->bytes + offset + 8;
+}
+
+json::snapshot::value json::snapshot::root() const
+{
+    return value(this, this->word(12), 0, 0);
+}
+
+const json::snapshot& json::snapshot::value::get_source() const
+{
+    if(this->source == NULL) throw std::logic_error("View does not refer to a value");
+    return *this->source;
+}
+
+json::jtype::jtype json::snapshot::value::type() const
+{
+    if(this->source == NULL) return json::jtype::not_valid;
+    switch (this->source->word(this->offset))
+    {
+    case SNAPSHOT_NULL:
+        return json::jtype::jnull;
+    case SNAPSHOT_FALSE:
+    case SNAPSHOT_TRUE:
+        return json::jtype::jbool;
+    case SNAPSHOT_NUMBER:
+        return json::jtype::jnumber;
+    case SNAPSHOT_STRING:
+        return json::jtype::jstring;
+    case SNAPSHOT_ARRAY:
+        return json::jtype::jarray;
+    case SNAPSHOT_OBJECT:
+        return json::jtype::jobject;
+    default:
+        throw json::parsing_error("Snapshot is corrupt");
+    }
+}
+
+bool json::snapshot::value::is_true() const
+{
+    return this->source != NULL && this->source->word(this->offset) == SNAPSHOT_TRUE;
+}
+
+size_t json::snapshot::value::size() const
+{
+    const json::jtype::jtype type = this->type();
+    if(type != json::jtype::jobject && type != json::jtype::jarray) return 0;
+    return this->source->word(this->offset + 4);
+}
+
+const char* json::snapshot::value::key() const
+{
+    if(this->parent == 0) return NULL;
+    const snapshot &target = this->get_source();
+    if(target.word(this->parent) != SNAPSHOT_OBJECT) return NULL;
+    size_t size;
+    return target.text(target.word(this->parent + 8 + 8 * (size_t)this->index), size);
+}
+
+const char* json::snapshot::value::data() const
+{
+    const json::jtype::jtype type = this->type();
+    if(type != json::jtype::jstring && type != json::jtype::jnumber) throw std::invalid_argument("Value is not a string or number");
+    size_t size;
+    return this->source->text(this->offset, size);
+}
+
+size_t json::snapshot::value::length() const
+{
+    const json::jtype::jtype type = this->type();
+    if(type != json::jtype::jstring && type != json::jtype::jnumber) throw std::invalid_argument("Value is not a string or number");
+    size_t result;
+    this->source->text(this->offset, result);
+    return result;
+}
+
+json::snapshot::value json::snapshot::value::child(const uint32_t position) const
+{
+    const size_t table = this->offset + 8;
+    const bool is_object = this->source->word(this->offset) == SNAPSHOT_OBJECT;
+    const uint32_t target = is_object ? this->source->word(table + 8 * (size_t)position + 4) : this->source->word(table + 4 * (size_t)position);
+
+    // Children are written after the tables of their container, so an offset pointing back would make a corrupt snapshot cyclic
+    const size_t count = this->source->word(this->offset + 4);
+    if(target < table + count * (is_object ? 12 : 4)) throw json::parsing_error("Snapshot is corrupt");
+    return value(this->source, target, this->offset, position);
+}
+
+uint32_t json::snapshot::value::find(const char *key, const size_t length) const
+{
+    const snapshot &target = this->get_source();
+    const uint32_t count = (uint32_t)this->size();
+    const size_t sorted = this->offset + 8 + 8 * (size_t)count;
+
+    // Find the first member whose key is not less than the requested key
+    uint32_t low = 0;
+    uint32_t high = count;
+    while(low < high)
+    {
+        const uint32_t middle = low + (high - low) / 2;
+        size_t candidate_length;
+        const char *candidate = target.text(target.word(this->offset + 8 + 8 * (size_t)target.word(sorted + 4 * (size_t)middle)), candidate_length);
+        const int comparison = memcmp(candidate, key, candidate_length < length ? candidate_length : length);
+        if(comparison < 0 || (comparison == 0 && candidate_length < length)) low = middle + 1;
+        else high = middle;
+    }
+    if(low == count) return count;
+    const uint32_t position = target.word(sorted + 4 * (size_t)low);
+    size_t found_length;
+    const char *found = target.text(target.word(this->offset + 8 + 8 * (size_t)position), found_length);
+    return found_length == length && memcmp(found, key, length) == 0 ? position : count;
+}
+
+json::snapshot::value json::snapshot::value::get(const std::string &key) const
+{
+    if(!this->is_object()) throw json::invalid_key(key);
+    const uint32_t position = this->find(key.data(), key.length());
+    if(position == this->size()) throw json::invalid_key(key);
+    return this->child(position);
+}
+
+json::snapshot::value json::snapshot::value::array(const size_t index) const
+{
+    if(index >= this->size()) throw std::out_of_range("Index is out of range");
+    return this->child((uint32_t)index);
+}
+
+json::snapshot::value json::snapshot::value::first() const
+{
+    if(this->size() == 0) return value();
+    return this->child(0);
+}
+
+json::snapshot::value json::snapshot::value::next() const
+{
+    if(this->parent == 0) return value();
+    const value container(this->source, this->parent, 0, 0);
+    if(this->index + 1 >= container.size()) return value();
+    return container.child(this->index + 1);
+}
+
+void json::snapshot::value::serialize(std::string &output) const
+{
+    switch (this->type())
+    {
+    case json::jtype::jstring:
+        json::parsing::encode_string(this->data(), this->length(), output);
+        return;
+    case json::jtype::jnumber:
+        output.append(this->data(), this->length());
+        return;
+    case json::jtype::jbool:
+        output += this->is_true() ? "true" : "false";
+        return;
+    case json::jtype::jnull:
+        output += "null";
+        return;
+    case json::jtype::jarray:
+    case json::jtype::jobject:
+    {
+        const bool is_object = this->is_object();
+        output += is_object ? '{' : '[';
+        for(value member = this->first(); member.exists(); member = member.next())
+        {
+            if(member.index > 0) output += ',';
+            if(is_object) {
+                size_t size;
+                const char *key = this->source->text(this->source->word(this->offset + 8 + 8 * (size_t)member.index), size);
+                json::parsing::encode_string(key, size, output);
+                output += ':';
+            }
+            member.serialize(output);
+        }
+        output += is_object ? '}' : ']';
+        return;
+    }
+    case json::jtype::not_valid:
+        break;
+    }
+    throw std::logic_error("View does not refer to a value");
+}
+
+std::string json::snapshot::value::as_string() const
+{
+    if(this->is_string() || this->is_number()) return std::string(this->data(), this->length());
+    std::string result;
+    this->serialize(result);
+    return result;
+}
+
+json::snapshot::value::operator int() const { return this->get_number<int>(INT_FORMAT); }
+json::snapshot::value::operator unsigned int() const { return this->get_number<unsigned int>(UINT_FORMAT); }
+json::snapshot::value::operator long() const { return this->get_number<long>(LONG_FORMAT); }
+json::snapshot::value::operator unsigned long() const { return this->get_number<unsigned long>(ULONG_FORMAT); }
+json::snapshot::value::operator float() const { return this->get_number<float>(FLOAT_FORMAT); }
+json::snapshot::value::operator double() const { return this->get_number<double>(DOUBLE_FORMAT); }
+
+/*! \brief Moves from the start of a member value or element to the next member or element
+ *
+ * @param value Pointer to the start of the value
+ * @return A pointer to the next key or element, or to the closing bracket
+ * \exception json::parsing_error Thrown if the value is malformed or not terminated
+ */
+static const char* lazy_advance(const char *value)
+{
+    const char *end = skip_value(value);
+    if(end == NULL || end == value) throw json::parsing_error("Input is not a valid value");
+    const char *next = next_element(end);
+    if(*next == '\0') throw json::parsing_error("Input is not terminated");
+    return next;
+}
+
+/*! \brief Locates the value of a member during on-demand access
+ *
+ * \exception json::parsing_error Thrown if the member is malformed
+ */
+static const char* lazy_member_value(const char *key)
+{
+    const char *value = member_value(key);
+    if(value == NULL || *value == '\0') throw json::parsing_error("Input is not a valid object");
+    return value;
+}
+
+json::lazy_value::lazy_value(const char *input) : input(json::parsing::tlws(input)), name(NULL)
+{
+    if(*this->input == '\0') throw json::parsing_error("Input was only whitespace");
+}
+
+const char* json::lazy_value::get_input() const
+{
+    if(this->input == NULL) throw std::logic_error("View does not refer to a value");
+    return this->input;
+}
+
+json::lazy_value json::lazy_value::find(const char *key, const size_t length) const
+{
+    if(!this->is_object()) throw std::invalid_argument("Value is not an object");
+    const char *member = json::parsing::tlws(this->input + 1);
+    while(*member == '"')
+    {
+        const char *value = lazy_member_value(member);
+        if(key_equals(member, key, length)) return lazy_value(value, member);
+        member = lazy_advance(value);
+    }
+    return lazy_value();
+}
+
+size_t json::lazy_value::size() const
+{
+    size_t result = 0;
+    for(lazy_value entry = this->first(); entry.exists(); entry = entry.next()) result++;
+    return result;
+}
+
+std::string json::lazy_value::key() const
+{
+    this->get_input();
+    return this->name == NULL ? std::string() : json::parsing::decode_string(this->name);
+}
+
+size_t json::lazy_value::length() const
+{
+    const char *end = skip_value(this->get_input());
+    if(end == NULL) throw json::parsing_error("Input is not terminated");
+    return (size_t)(end - this->input);
+}
+
+std::string json::lazy_value::as_string() const
+{
+    if(this->is_string()) return json::parsing::decode_string(this->input);
+    return this->raw();
+}
+
+json::lazy_value json::lazy_value::get(const std::string &key) const
+{
+    const lazy_value result = this->find(key.data(), key.size());
+    if(!result.exists()) throw json::invalid_key(key);
+    return result;
+}
+
+json::lazy_value json::lazy_value::array(const size_t index) const
+{
+    if(!this->is_array()) throw std::invalid_argument("Value is not an array");
+    lazy_value element = this->first();
+    for(size_t i = 0; i < index && element.exists(); i++) element = element.next();
+    if(!element.exists()) throw std::out_of_range("Array index is out of range");
+    return element;
+}
+
+json::lazy_value json::lazy_value::first() const
+{
+    const char *index = json::parsing::tlws(this->get_input() + 1);
+    switch (*this->input)
+    {
+    case '{':
+        return *index == '"' ? lazy_value(lazy_member_value(index), index) : lazy_value();
+    case '[':
+        if(*index == ']') return lazy_value();
+        if(*index == '\0') throw json::parsing_error("Input is not terminated");
+        return lazy_value(index, NULL);
+    default:
+        throw std::invalid_argument("Value is not an object or array");
+    }
+}
+
+json::lazy_value json::lazy_value::next() const
+{
+    const char *end = skip_value(this->get_input());
+    if(end == NULL || end == this->input) throw json::parsing_error("Input is not a valid value");
+    const char *index = next_element(end);
+    switch (*index)
+    {
+    case '\0':
+        // A root value is followed by the end of the input, while members and elements are followed by a closing bracket
+        if(this->name == NULL) return lazy_value();
+        throw json::parsing_error("Input is not terminated");
+    case '"':
+        if(this->name != NULL) return lazy_value(lazy_member_value(index), index);
+        break;
+    case '}':
+    case ']':
+        return lazy_value();
+    }
+    return this->name == NULL ? lazy_value(index, NULL) : lazy_value();
+}
+
+json::lazy_value::operator int() const { return this->get_number<int>(INT_FORMAT); }
+json::lazy_value::operator unsigned int() const { return this->get_number<unsigned int>(UINT_FORMAT); }
+json::lazy_value::operator long() const { return this->get_number<long>(LONG_FORMAT); }
+json::lazy_value::operator unsigned long() const { return this->get_number<unsigned long>(ULONG_FORMAT); }
+json::lazy_value::operator float() const { return this->get_number<float>(FLOAT_FORMAT); }
+json::lazy_value::operator double() const { return this->get_number<double>(DOUBLE_FORMAT); }
+
+json::projection::projection(const std::vector<std::string> &paths) : paths(paths)
+{
+    node root;
+    root.parent = 0;
+    root.pending = 0;
+    this->nodes.push_back(root);
+    for(size_t i = 0; i < paths.size(); i++)
+    {
+        if(paths[i].empty()) throw std::invalid_argument("Projection paths cannot be empty");
+        size_t current = 0;
+        size_t start = 0;
+        while(true)
+        {
+            const size_t end = std::min(paths[i].find('.', start), paths[i].size());
+            const std::string key = paths[i].substr(start, end - start);
+            size_t child = 0;
+            for(size_t j = 0; j < this->nodes[current].children.size() && child == 0; j++)
+            {
+                if(this->nodes[this->nodes[current].children[j]].key == key) child = this->nodes[current].children[j];
+            }
+            if(child == 0) {
+                node segment;
+                segment.key = key;
+                segment.parent = current;
+                segment.pending = 0;
+                child = this->nodes.size();
+                this->nodes.push_back(segment);
+                this->nodes[current].children.push_back(child);
+            }
+            current = child;
+            if(end == paths[i].size()) break;
+            start = end + 1;
+        }
+        if(this->nodes[current].targets.empty()) {
+            for(size_t index = current; index != 0; index = this->nodes[index].parent) this->nodes[index].pending++;
+            this->nodes[0].pending++;
+        }
+        this->nodes[current].targets.push_back(i);
+    }
+}
+
+void json::projection::settle(size_t index, const size_t count, std::vector<size_t> &pending) const
+{
+    while(true)
+    {
+        pending[index] -= count;
+        if(index == 0) return;
+        index = this->nodes[index].parent;
+    }
+}
+
+const char* json::projection::scan(const char *input, const size_t index, std::vector<size_t> &pending, std::vector<json::lazy_value> &views) const
+{
+    const node &parent = this->nodes[index];
+    const char *element = json::parsing::tlws(input + 1);
+    size_t position = 0;
+    while(*element != '}' && *element != ']')
+    {
+        const char *key = NULL;
+        const char *value = element;
+        if(*input == '{') {
+            if(*element != '"') throw json::parsing_error("Input is not a valid object");
+            key = element;
+            value = lazy_member_value(element);
+        }
+
+        // Look for a requested segment, unless everything below this node has been resolved
+        size_t child = 0;
+        for(size_t i = 0; i < parent.children.size() && child == 0 && pending[index] > 0; i++)
+        {
+            const node &candidate = this->nodes[parent.children[i]];
+            if(pending[parent.children[i]] == 0) continue;
+            size_t candidate_index;
+            if(key != NULL ? key_equals(key, candidate.key.data(), candidate.key.size()) :
+                read_pointer_index(candidate.key, candidate_index) && candidate_index == position) {
+                child = parent.children[i];
+            }
+        }
+
+        const char *end;
+        if(child != 0) {
+            const node &match = this->nodes[child];
+            if(!match.targets.empty()) {
+                for(size_t i = 0; i < match.targets.size(); i++) views[match.targets[i]] = json::lazy_value(value, key);
+                this->settle(child, 1, pending);
+                if(pending[0] == 0) return NULL;
+            }
+            if(pending[child] > 0 && (*value == '{' || *value == '[')) {
+                end = this->scan(value, child, pending, views);
+                if(end == NULL) return NULL;
+            } else {
+                end = skip_value(value);
+            }
+            // Later members with the same key are ignored, so paths that were not found below this one are missing
+            if(pending[child] > 0) {
+                this->settle(child, pending[child], pending);
+                if(pending[0] == 0) return NULL;
+            }
+        } else {
+            end = skip_value(value);
+        }
+        if(end == NULL || end == value) throw json::parsing_error("Input is not a valid value");
+        element = next_element(end);
+        if(*element == '\0') throw json::parsing_error("Input is not terminated");
+        position++;
+    }
+    return element + 1;
+}
+
+void json::projection::apply(const char *input, std::vector<json::lazy_value> &views) const
+{
+    views.assign(this->paths.size(), json::lazy_value());
+    const char *root = json::parsing::tlws(input);
+    if(*root != '{' && *root != '[') return;
+    std::vector<size_t> pending(this->nodes.size());
+    for(size_t i = 0; i < this->nodes.size(); i++) pending[i] = this->nodes[i].pending;
+    if(pending[0] > 0) this->scan(root, 0, pending, views);
+}
+
+json::jobject json::projection::extract(const char *input) const
+{
+    std::vector<json::lazy_value> views;
+    this->apply(input, views);
+    json::jobject result;
+    for(size_t i = 0; i < views.size(); i++)
+    {
+        if(!views[i].exists() || result.has_key(this->paths[i])) continue;
+        result += json::kvp(this->paths[i], views[i].raw());
+    }
+    return result;
+}
+
+bool json::binding::matches(const char *key, const size_t length, const char *name, const size_t name_length)
+{
+    return length == name_length && memcmp(key, name, length) == 0;
+}
+
+void json::binding::begin_object(const char *&input)
+{
+    input = json::parsing::tlws(input);
+    if(*input != '{') throw json::parsing_error("Input is not a valid object");
+    input++;
+}
+
+bool json::binding::next_key(const char *&input, const char *&key, size_t &length, std::string &scratch)
+{
+    input = json::parsing::tlws(input);
+    if(*input == ',') input = json::parsing::tlws(input + 1);
+    if(*input == '}') {
+        input++;
+        return false;
+    }
+    if(*input != '"') throw json::parsing_error("Input is not a valid object");
+
+    // Keys without escape sequences are read in place
+    const size_t run = strcspn(input + 1, "\"\\");
+    if(input[1 + run] == '"') {
+        key = input + 1;
+        length = run;
+        input += run + 2;
+    } else {
+        scratch.clear();
+        input = json::parsing::decode_string(input, scratch);
+        key = scratch.data();
+        length = scratch.size();
+    }
+    input = json::parsing::tlws(input);
+    if(*input != ':') throw json::parsing_error("Input is not a valid object");
+    input = json::parsing::tlws(input + 1);
+    return true;
+}
+
+void json::binding::begin_array(const char *&input)
+{
+    input = json::parsing::tlws(input);
+    if(*input != '[') throw json::parsing_error("Input is not an array");
+    input++;
+}
+
+bool json::binding::next_element(const char *&input, const bool first)
+{
+    input = json::parsing::tlws(input);
+    if(*input == ']') {
+        input++;
+        return false;
+    }
+    if(!first) {
+        if(*input != ',') throw json::parsing_error("Input is not an array");
+        input = json::parsing::tlws(input + 1);
+    }
+    if(*input == '\0') throw json::parsing_error("Input is not terminated");
+    return true;
+}
+
+void json::binding::skip(const char *&input)
+{
+    const char *end = skip_value(input);
+    if(end == NULL || end == json::parsing::tlws(input)) throw json::parsing_error("Input is not a valid value");
+    input = end;
+}
+
+void json::binding::end(const char *input)
+{
+    if(!EMPTY_STRING(json::parsing::tlws(input))) throw json::parsing_error("Unexpected characters after value");
+}
+
+bool json::binding::skip_null(const char *&input)
+{
+    input = json::parsing::tlws(input);
+    if(strncmp(input, "null", 4) != 0) return false;
+    input += 4;
+    return true;
+}
+
+/*! \brief Reads a number for a bound field
+ *
+ * @tparam T The type the number is converted to
+ * @tparam S The type returned by the conversion function
+ * @param input The position of the value, advanced past it
+ * @param value The field, left unchanged if the value is null
+ * @param convert The conversion function
+ * \exception json::parsing_error Thrown if the value is not an integer or is out of the range of the field
+ */
+template<typename T, typename S>
+static void read_bound_integer(const char *&input, T &value, S (*convert)(const char*, char**, int))
+{
+    if(json::binding::skip_null(input)) return;
+    if(json::jtype::peek(*input) != json::jtype::jnumber) throw json::parsing_error("Value is not a number");
+    char *end;
+    errno = 0;
+    const S result = convert(input, &end, 10);
+    if(*end == '.' || *end == 'e' || *end == 'E') throw json::parsing_error("Value is not an integer");
+
+    // The conversion of a negative number to an unsigned type wraps around, and a narrower field cannot hold every result
+    const bool wrapped = *input == '-' && result != 0 && (T)-1 > (T)0;
+    if(errno == ERANGE || wrapped || (S)(T)result != result) throw json::parsing_error("Value is out of range");
+    value = (T)result;
+    input = end;
+}
+
+/*! \copydoc read_bound_integer */
+template<typename T>
+static void read_bound_floating(const char *&input, T &value)
+{
+    if(json::binding::skip_null(input)) return;
+    if(json::jtype::peek(*input) != json::jtype::jnumber) throw json::parsing_error("Value is not a number");
+    char *end;
+    value = (T)strtod(input, &end);
+    input = end;
+}
+
+void json::binding::read(const char *&input, int &value) { read_bound_integer(input, value, strtol); }
+void json::binding::read(const char *&input, unsigned int &value) { read_bound_integer(input, value, strtoul); }
+void json::binding::read(const char *&input, long &value) { read_bound_integer(input, value, strtol); }
+void json::binding::read(const char *&input, unsigned long &value) { read_bound_integer(input, value, strtoul); }
+void json::binding::read(const char *&input, float &value) { read_bound_floating(input, value); }
+void json::binding::read(const char *&input, double &value) { read_bound_floating(input, value); }
+
+void json::binding::read(const char *&input, bool &value)
+{
+    if(skip_null(input)) return;
+    if(strncmp(input, "true", 4) == 0) {
+        value = true;
+        input += 4;
+    } else if(strncmp(input, "false", 5) == 0) {
+        value = false;
+        input += 5;
+    } else {
+        throw json::parsing_error("Value is not a boolean");
+    }
+}
+
+void json::binding::read(const char *&input, std::string &value)
+{
+    if(skip_null(input)) return;
+    if(*input != '"') throw json::parsing_error("Value is not a string");
+    value.clear();
+    input = json::parsing::decode_string(input, value);
+}
+
+void json::binding::read(const char *&input, json::jobject &value)
+{
+    if(skip_null(input)) return;
+    value = json::jobject::parse(input);
+    skip(input);
+}
+
+/*! \brief Appends a signed integer for a bound field */
+static void write_bound_integer(std::string &output, const long value)
+{
+    if(value < 0) {
+        output += '-';
+        append_decimal(0 - (uint64_t)value, output);
+    } else {
+        append_decimal((uint64_t)value, output);
+    }
+}
+
+void json::binding::write(std::string &output, const int value) { write_bound_integer(output, value); }
+void json::binding::write(std::string &output, const unsigned int value) { append_decimal(value, output); }
+void json::binding::write(std::string &output, const long value) { write_bound_integer(output, value); }
+void json::binding::write(std::string &output, const unsigned long value) { append_decimal(value, output); }
+void json::binding::write(std::string &output, const double value) { append_floating(value, output); }
+void json::binding::write(std::string &output, const bool value) { output += value ? "true" : "false"; }
+void json::binding::write(std::string &output, const std::string &value) { json::parsing::encode_string(value.data(), value.size(), output); }
+void json::binding::write(std::string &output, const json::jobject &value) { output += value.as_string(); }
+
+void json::binding::write(std::string &output, const float value)
+{
+    if(value != value || value - value != 0) throw json::parsing_error("Non-finite numbers cannot be represented in JSON");
+    char buffer[32];
+    for(int precision = 1; precision <= 9; precision++)
+    {
+        JSON_STATS_COUNT(FORMAT_CALLS, 1);
+        std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+        if((float)strtod(buffer, NULL) == value) break;
+    }
+    output += buffer;
+    if(strpbrk(buffer, ".eE") == NULL) output += ".0";
+}
+
+/*! \brief Type flags of a compiled schema node */
+enum schema_types
+{
+    SCHEMA_NULL = 1,
+    SCHEMA_BOOLEAN = 2,
+    SCHEMA_OBJECT = 4,
+    SCHEMA_ARRAY = 8,
+    SCHEMA_NUMBER = 16,
+    SCHEMA_INTEGER = 32,
+    SCHEMA_STRING = 64,
+    SCHEMA_ANY = 127
+};
+
+/*! \brief Flags for the numeric bounds of a compiled schema node */
+enum schema_bounds
+{
+    SCHEMA_MINIMUM = 1,
+    SCHEMA_MAXIMUM = 2,
+    SCHEMA_EXCLUSIVE_MINIMUM = 4,
+    SCHEMA_EXCLUSIVE_MAXIMUM = 8
+};
+
+/*! \brief Node index for subschemas that accept any value */
+static const size_t SCHEMA_UNCONSTRAINED = (size_t)-1;
+
+/*! \brief A compiled schema or subschema */
+struct schema_node
+{
+    /*! \brief Set by the `false` schema, which rejects every value */
+    bool reject;
+
+    /*! \brief Accepted types as a combination of schema_types */
+    unsigned int types;
+
+    /*! \brief Combination of schema_bounds that are set */
+    unsigned int bounds;
+
+    /*! \brief Numeric bounds, indexed by the position of the flag in schema_bounds */
+    double limits[4];
+
+    /*! \brief Keys that must be present */
+    std::vector<std::string> required;
+
+    /*! \brief Subschemas of named properties, sorted by key */
+    std::vector<std::pair<std::string, size_t> > properties;
+
+    /*! \brief Subschema of properties not listed in properties */
+    size_t additional;
+
+    /*! \brief Subschema of array elements */
+    size_t items;
+
+    /*! \brief Serialized values accepted by `enum` and `const` */
+    std::vector<std::string> enumeration;
+
+    /*! \brief Bounds on the number of code points in a string */
+    size_t min_length, max_length;
+
+    /*! \brief Bounds on the number of elements in an array */
+    size_t min_items, max_items;
+
+#if JSON_HAS_CXX11
+    /*! \brief Set if the node has a pattern */
+    bool has_pattern;
+
+    /*! \brief Pattern that strings must contain a match for */
+    std::regex pattern;
+#endif
+
+    /*! \brief Constructor for a node that accepts any value */
+    schema_node() :
+        reject(false),
+        types(SCHEMA_ANY),
+        bounds(0),
+        additional(SCHEMA_UNCONSTRAINED),
+        items(SCHEMA_UNCONSTRAINED),
+        min_length(0),
+        max_length((size_t)-1),
+        min_items(0),
+        max_items((size_t)-1)
+#if JSON_HAS_CXX11
+        , has_pattern(false)
+#endif
+    {
+        for(size_t i = 0; i < 4; i++) this->limits[i] = 0;
+    }
+};
+
+/*! \brief Orders properties by key */
+static bool property_less(const std::pair<std::string, size_t> &lhs, const std::pair<std::string, size_t> &rhs)
+{
+    return lhs.first < rhs.first;
+}
+
+struct json::schema::program
+{
+    /*! \brief The compiled nodes, with the root schema first */
+    std::vector<schema_node> nodes;
+
+    /*! \brief Compiles a schema and its subschemas
+     *
+     * @param definition The schema
+     * @return The index of the compiled node
+     */
+    size_t compile(const json::lazy_value &definition);
+};
+
+/*! \brief Converts the name of a JSON type to its schema flag */
+static unsigned int schema_type(const std::string &name)
+{
+    if(name == "null") return SCHEMA_NULL;
+    if(name == "boolean") return SCHEMA_BOOLEAN;
+    if(name == "object") return SCHEMA_OBJECT;
+    if(name == "array") return SCHEMA_ARRAY;
+    if(name == "number") return SCHEMA_NUMBER;
+    if(name == "integer") return SCHEMA_INTEGER;
+    if(name == "string") return SCHEMA_STRING;
+    throw std::invalid_argument("Unknown schema type \"" + name + "\"");
+}
+
+/*! \brief Reads a non-negative integer keyword of a schema */
+static size_t schema_count(const json::lazy_value &value)
+{
+    if(!value.is_number() || *value.data() == '-') throw std::invalid_argument("Schema keyword \"" + value.key() + "\" must be a non-negative integer");
+    return (unsigned long)value;
+}
+
+size_t json::schema::program::compile(const json::lazy_value &definition)
+{
+    // Reserve the slot first so that subschemas are numbered after their parent
+    const size_t index = this->nodes.size();
+    this->nodes.push_back(schema_node());
+    schema_node node;
+
+    if(definition.is_bool()) {
+        node.reject = !definition.is_true();
+        this->nodes[index] = node;
+        return index;
+    }
+    if(!definition.is_object()) throw std::invalid_argument("A schema must be an object or a boolean");
+
+    for(json::lazy_value entry = definition.first(); entry.exists(); entry = entry.next())
+    {
+        const std::string keyword = entry.key();
+        if(keyword == "type") {
+            node.types = 0;
+            if(entry.is_array()) {
+                for(json::lazy_value name = entry.first(); name.exists(); name = name.next()) node.types |= schema_type(name.as_string());
+            } else {
+                node.types = schema_type(entry.as_string());
+            }
+        } else if(keyword == "required") {
+            if(!entry.is_array()) throw std::invalid_argument("Schema keyword \"required\" must be an array");
+            for(json::lazy_value key = entry.first(); key.exists(); key = key.next()) node.required.push_back(key.as_string());
+        } else if(keyword == "properties") {
+            if(!entry.is_object()) throw std::invalid_argument("Schema keyword \"properties\" must be an object");
+            for(json::lazy_value property = entry.first(); property.exists(); property = property.next())
+            {
+                const std::string key = property.key();
+                node.properties.push_back(std::make_pair(key, this->compile(property)));
+            }
+            std::sort(node.properties.begin(), node.properties.end(), property_less);
+        } else if(keyword == "additionalProperties") {
+            node.additional = this->compile(entry);
+        } else if(keyword == "items") {
+            node.items = this->compile(entry);
+        } else if(keyword == "enum") {
+            if(!entry.is_array()) throw std::invalid_argument("Schema keyword \"enum\" must be an array");
+            for(json::lazy_value value = entry.first(); value.exists(); value = value.next()) node.enumeration.push_back(value.raw());
+        } else if(keyword == "const") {
+            node.enumeration.assign(1, entry.raw());
+        } else if(keyword == "minimum" || keyword == "maximum" || keyword == "exclusiveMinimum" || keyword == "exclusiveMaximum") {
+            if(!entry.is_number()) throw std::invalid_argument("Schema keyword \"" + keyword + "\" must be a number");
+            const size_t bound = keyword == "minimum" ? 0 : keyword == "maximum" ? 1 : keyword == "exclusiveMinimum" ? 2 : 3;
+            node.bounds |= 1u << bound;
+            node.limits[bound] = (double)entry;
+        } else if(keyword == "minLength") {
+            node.min_length = schema_count(entry);
+        } else if(keyword == "maxLength") {
+            node.max_length = schema_count(entry);
+        } else if(keyword == "minItems") {
+            node.min_items = schema_count(entry);
+        } else if(keyword == "maxItems") {
+            node.max_items = schema_count(entry);
+        } else if(keyword == "pattern") {
+            const std::string pattern = entry.as_string();
+#if JSON_HAS_CXX11
+            try
+            {
+                node.pattern = std::regex(pattern, std::regex::ECMAScript);
+            }
+            catch(const std::regex_error &)
+            {
+                throw std::invalid_argument("Invalid schema pattern \"" + pattern + "\"");
+            }
+            node.has_pattern = true;
+#else
+            throw std::invalid_argument("Schema keyword \"pattern\" requires C++11");
+#endif
+        }
+    }
+
+    this->nodes[index] = node;
+    return index;
+}
+
+/*! \brief State of a single validation pass */
+struct schema_validation
+{
+    /*! \brief The compiled nodes */
+    const std::vector<schema_node> &nodes;
+
+    /*! \brief JSON Pointer to the value being validated */
+    std::string path;
+
+    /*! \brief Description of the first violation */
+    std::string error;
+
+    /*! \brief Decoded content of the string being matched against a pattern */
+    std::string scratch;
+
+    /*! \brief Constructor */
+    schema_validation(const std::vector<schema_node> &nodes) : nodes(nodes) { }
+
+    /*! \brief Records a violation at the current path
+     *
+     * @return False, for convenience
+     */
+    bool fail(const std::string &message)
+    {
+        this->error = message + " at \"" + this->path + "\"";
+        return false;
+    }
+
+    /*! \brief Validates the value at the input
+     *
+     * @param[in,out] input The start of the value, advanced past it if it is valid
+     * @param index The node of the subschema, or SCHEMA_UNCONSTRAINED
+     * @return True if the value is valid
+     */
+    bool value(const char *&input, const size_t index);
+
+    /*! \brief Validates the members of an object */
+    bool object(const char *&input, const schema_node *node);
+
+    /*! \brief Validates the elements of an array */
+    bool array(const char *&input, const schema_node *node);
+
+    /*! \brief Validates a string */
+    bool text(const char *&input, const schema_node *node);
+
+    /*! \brief Validates a number */
+    bool number(const char *&input, const schema_node *node);
+};
+
+/*! \brief Checks the grammar of a number
+ *
+ * @param input The start of the number
+ * @return The end of the number, or NULL if it is malformed
+ */
+static const char* scan_number(const char *input)
+{
+    if(*input == '-') input++;
+    if(*input == '0') {
+        input++;
+    } else if(IS_DIGIT(*input)) {
+        while(IS_DIGIT(*input)) input++;
+    } else {
+        return NULL;
+    }
+    if(*input == '.') {
+        input++;
+        if(!IS_DIGIT(*input)) return NULL;
+        while(IS_DIGIT(*input)) input++;
+    }
+    if(*input == 'e' || *input == 'E') {
+        input++;
+        if(*input == '+' || *input == '-') input++;
+        if(!IS_DIGIT(*input)) return NULL;
+        while(IS_DIGIT(*input)) input++;
+    }
+    return input;
+}
+
+bool schema_validation::value(const char *&input, const size_t index)
+{
+    static const schema_node unconstrained;
+    const schema_node *node = index == SCHEMA_UNCONSTRAINED ? &unconstrained : &this->nodes[index];
+    if(node->reject) return this->fail("Value is not allowed");
+
+    input = json::parsing::tlws(input);
+    const char *start = input;
+    bool valid;
+    switch(*input)
+    {
+    case '{':
+        if(!(node->types & SCHEMA_OBJECT)) return this->fail("Unexpected object");
+        valid = this->object(input, node);
+        break;
+    case '[':
+        if(!(node->types & SCHEMA_ARRAY)) return this->fail("Unexpected array");
+        valid = this->array(input, node);
+        break;
+    case '"':
+        if(!(node->types & SCHEMA_STRING)) return this->fail("Unexpected string");
+        valid = this->text(input, node);
+        break;
+    case 't':
+    case 'f':
+        if(strncmp(input, *input == 't' ? "true" : "false", *input == 't' ? 4 : 5) != 0) return this->fail("Invalid literal");
+        if(!(node->types & SCHEMA_BOOLEAN)) return this->fail("Unexpected boolean");
+        input += *input == 't' ? 4 : 5;
+        valid = true;
+        break;
+    case 'n':
+        if(strncmp(input, "null", 4) != 0) return this->fail("Invalid literal");
+        if(!(node->types & SCHEMA_NULL)) return this->fail("Unexpected null");
+        input += 4;
+        valid = true;
+        break;
+    default:
+        valid = this->number(input, node);
+        break;
+    }
+    if(!valid || node->enumeration.empty()) return valid;
+
+    for(size_t i = 0; i < node->enumeration.size(); i++)
+    {
+        if(json::parsing::equal(node->enumeration[i].c_str(), start, true)) return true;
+    }
+    return this->fail("Value is not one of the enumerated values");
+}
+
+bool schema_validation::object(const char *&input, const schema_node *node)
+{
+    std::vector<bool> seen(node->required.size(), false);
+    const size_t depth = this->path.size();
+    std::string key;
+    input = json::parsing::tlws(input + 1);
+    if(*input == '}') {
+        input++;
+    } else {
+        for(;;)
+        {
+            if(*input != '"') return this->fail("Expected a key");
+            key.clear();
+            input = json::parsing::tlws(json::parsing::decode_string(input, key));
+            if(*input != ':') return this->fail("Expected ':'");
+            input++;
+
+            size_t child = node->additional;
+            std::vector<std::pair<std::string, size_t> >::const_iterator property = std::lower_bound(node->properties.begin(), node->properties.end(), std::make_pair(key, (size_t)0), property_less);
+            if(property != node->properties.end() && property->first == key) child = property->second;
+            for(size_t i = 0; i < node->required.size(); i++)
+            {
+                if(node->required[i] == key) seen[i] = true;
+            }
+
+            append_pointer_token(this->path, key.data(), key.size());
+            if(!this->value(input, child)) return false;
+            this->path.resize(depth);
+
+            input = json::parsing::tlws(input);
+            if(*input == '}') {
+                input++;
+                break;
+            }
+            if(*input != ',') return this->fail("Expected ',' or '}'");
+            input = json::parsing::tlws(input + 1);
+        }
+    }
+
+    for(size_t i = 0; i < seen.size(); i++)
+    {
+        if(!seen[i]) return this->fail("Missing required property \"" + node->required[i] + "\"");
+    }
+    return true;
+}
+
+bool schema_validation::array(const char *&input, const schema_node *node)
+{
+    const size_t depth = this->path.size();
+    size_t count = 0;
+    input = json::parsing::tlws(input + 1);
+    if(*input == ']') {
+        input++;
+    } else {
+        for(;;)
+        {
+            this->path += '/';
+            append_decimal(count, this->path);
+            if(!this->value(input, node->items)) return false;
+            this->path.resize(depth);
+            count++;
+
+            input = json::parsing::tlws(input);
+            if(*input == ']') {
+                input++;
+                break;
+            }
+            if(*input != ',') return this->fail("Expected ',' or ']'");
+            input++;
+        }
+    }
+
+    if(count < node->min_items) return this->fail("Too few elements");
+    if(count > node->max_items) return this->fail("Too many elements");
+    return true;
+}
+
+bool schema_validation::text(const char *&input, const schema_node *node)
+{
+#if JSON_HAS_CXX11
+    const bool capture = node->has_pattern;
+    this->scratch.clear();
+#endif
+    string_cursor cursor(input);
+    size_t length = 0;
+    for(int next = cursor.next(); next != -1; next = cursor.next())
+    {
+        if(next == -2) return this->fail("Unterminated string");
+        // Count code points rather than bytes
+        if((next & 0xC0) != 0x80) length++;
+#if JSON_HAS_CXX11
+        if(capture) this->scratch += (char)next;
+#endif
+    }
+    input = cursor.index;
+
+    if(length < node->min_length) return this->fail("String is too short");
+    if(length > node->max_length) return this->fail("String is too long");
+#if JSON_HAS_CXX11
+    if(capture && !std::regex_search(this->scratch, node->pattern)) return this->fail("String does not match the pattern");
+#endif
+    return true;
+}
+
+bool schema_validation::number(const char *&input, const schema_node *node)
+{
+    const char *end = scan_number(input);
+    if(end == NULL) return this->fail("Invalid value");
+
+    const double value = strtod(input, NULL);
+    input = end;
+    if(!(node->types & SCHEMA_NUMBER)) {
+        if(!(node->types & SCHEMA_INTEGER)) return this->fail("Unexpected number");
+        if(value != floor(value)) return this->fail("Expected an integer");
+    }
+    if((node->bounds & SCHEMA_MINIMUM) && value < node->limits[0]) return this->fail("Number is below the minimum");
+    if((node->bounds & SCHEMA_MAXIMUM) && value > node->limits[1]) return this->fail("Number is above the maximum");
+    if((node->bounds & SCHEMA_EXCLUSIVE_MINIMUM) && value <= node->limits[2]) return this->fail("Number is not above the exclusive minimum");
+    if((node->bounds & SCHEMA_EXCLUSIVE_MAXIMUM) && value >= node->limits[3]) return this->fail("Number is not below the exclusive maximum");
+    return true;
+}
+
+void json::schema::compile(const char *definition)
+{
+    this->compiled = new program();
+    try
+    {
+        this->compiled->compile(json::lazy_value(definition));
+    }
+    catch(...)
+    {
+        delete this->compiled;
+        throw;
+    }
+}
+
+json::schema::schema(const char *definition)
+{
+    this->compile(definition);
+}
+
+json::schema::schema(const std::string &definition)
+{
+    this->compile(definition.c_str());
+}
+
+json::schema::schema(const json::jobject &definition)
+{
+    this->compile(definition.as_string().c_str());
+}
+
+json::schema::~schema()
+{
+    delete this->compiled;
+}
+
+bool json::schema::validate(const char *input, std::string &error) const
+{
+    schema_validation validation(this->compiled->nodes);
+    bool valid;
+    try
+    {
+        valid = validation.value(input, 0);
+        if(valid && *json::parsing::tlws(input) != '\0') valid = validation.fail("Unexpected trailing characters");
+    }
+    catch(const json::parsing_error &e)
+    {
+        valid = validation.fail(e.what());
+    }
+    if(!valid) error = validation.error;
+    return valid;
+}
+
+bool json::schema::validate(const char *input) const
+{
+    std::string error;
+    return this->validate(input, error);
+}
+
+#if JSON_ENABLE_STATS
+/*! \brief Number of allocations made for each operation by all threads */
+static std::atomic<uint64_t> allocation_counts[json::stats::OPERATION_COUNT];
+
+/*! \brief Number of bytes allocated for each operation by all threads */
+static std::atomic<uint64_t> allocation_bytes[json::stats::OPERATION_COUNT];
+
+/*! \brief Process-wide values of the counters */
+static std::atomic<uint64_t> counters[json::stats::COUNTER_COUNT];
+
+/*! \brief Process-wide latency buckets of each operation */
+static std::atomic<uint64_t> latency_buckets[json::stats::OPERATION_COUNT][json::stats::histogram::BUCKETS];
+
+/*! \brief Number of timed calls of each operation */
+static std::atomic<uint64_t> latency_counts[json::stats::OPERATION_COUNT];
+
+/*! \brief Total duration of the timed calls of each operation, in nanoseconds */
+static std::atomic<uint64_t> latency_totals[json::stats::OPERATION_COUNT];
+
+/*! \brief Returns a monotonic time in nanoseconds */
+static uint64_t monotonic_ns()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*! \brief The operation running on the thread, or -1 outside of simpleson */
+static thread_local int current_operation = -1;
+
+/*! \brief The most recently constructed collector on the thread */
+static thread_local json::stats::collector *active_collector = NULL;
+#endif
+
+const char* json::stats::name(const operation op)
+{
+    static const char *names[OPERATION_COUNT] = { "parse", "serialize", "access" };
+    return names[op];
+}
+
+json::stats::allocations json::stats::allocated(const operation op)
+{
+    allocations result;
+#if JSON_ENABLE_STATS
+    result.count = allocation_counts[op].load(std::memory_order_relaxed);
+    result.bytes = allocation_bytes[op].load(std::memory_order_relaxed);
+#else
+    (void)op;
+#endif
+    return result;
+}
+
+void json::stats::reset()
+{
+#if JSON_ENABLE_STATS
+    for(size_t i = 0; i < OPERATION_COUNT; i++)
+    {
+        allocation_counts[i].store(0, std::memory_order_relaxed);
+        allocation_bytes[i].store(0, std::memory_order_relaxed);
+        latency_counts[i].store(0, std::memory_order_relaxed);
+        latency_totals[i].store(0, std::memory_order_relaxed);
+        for(size_t j = 0; j < histogram::BUCKETS; j++) latency_buckets[i][j].store(0, std::memory_order_relaxed);
+    }
+    for(size_t i = 0; i < COUNTER_COUNT; i++) counters[i].store(0, std::memory_order_relaxed);
+#endif
+}
+
+const char* json::stats::name(const counter c)
+{
+    static const char *names[COUNTER_COUNT] = { "input_characters", "sub_readers", "reparses", "format_calls", "key_lookups", "key_comparisons" };
+    return names[c];
+}
+
+void json::stats::increment(const counter c, const uint64_t amount)
+{
+#if JSON_ENABLE_STATS
+    counters[c].fetch_add(amount, std::memory_order_relaxed);
+#else
+    (void)c;
+    (void)amount;
+#endif
+}
+
+uint64_t json::stats::counted(const counter c)
+{
+#if JSON_ENABLE_STATS
+    return counters[c].load(std::memory_order_relaxed);
+#else
+    (void)c;
+    return 0;
+#endif
+}
+
+json::stats::histogram json::stats::latency(const operation op)
+{
+    histogram result;
+#if JSON_ENABLE_STATS
+    result.count = latency_counts[op].load(std::memory_order_relaxed);
+    result.total_ns = latency_totals[op].load(std::memory_order_relaxed);
+    for(size_t i = 0; i < histogram::BUCKETS; i++) result.buckets[i] = latency_buckets[op][i].load(std::memory_order_relaxed);
+#else
+    (void)op;
+#endif
+    return result;
+}
+
+/*! \brief Serializes an unsigned 64-bit integer exactly */
+static std::string stats_number(const uint64_t value)
+{
+    std::string result;
+    append_decimal(value, result);
+    return result;
+}
+
+json::jobject json::stats::dump()
+{
+    json::jobject result;
+    result.set("enabled", JSON_ENABLE_STATS ? "true" : "false");
+
+    json::jobject allocations_by_operation;
+    json::jobject latency_by_operation;
+    for(size_t i = 0; i < OPERATION_COUNT; i++)
+    {
+        const operation op = (operation)i;
+        const allocations counts = allocated(op);
+        json::jobject entry;
+        entry.set("count", stats_number(counts.count));
+        entry.set("bytes", stats_number(counts.bytes));
+        allocations_by_operation[name(op)] = entry;
+
+        const histogram timings = latency(op);
+        std::string buckets = "[";
+        for(size_t j = 0; j < histogram::BUCKETS; j++)
+        {
+            if(j > 0) buckets += ',';
+            append_decimal(timings.buckets[j], buckets);
+        }
+        buckets += ']';
+        json::jobject timing;
+        timing.set("count", stats_number(timings.count));
+        timing.set("total_ns", stats_number(timings.total_ns));
+        timing.set("buckets", buckets);
+        latency_by_operation[name(op)] = timing;
+    }
+    result["allocations"] = allocations_by_operation;
+
+    json::jobject counter_values;
+    for(size_t i = 0; i < COUNTER_COUNT; i++) counter_values.set(name((counter)i), stats_number(counted((counter)i)));
+    result["counters"] = counter_values;
+    result["latency"] = latency_by_operation;
+    return result;
+}
+
+void json::stats::record_allocation(const size_t size)
+{
+#if JSON_ENABLE_STATS
+    if(current_operation < 0) return;
+    allocation_counts[current_operation].fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes[current_operation].fetch_add(size, std::memory_order_relaxed);
+    for(collector *active = active_collector; active != NULL; active = active->previous)
+    {
+        active->counts[current_operation].count++;
+        active->counts[current_operation].bytes += size;
+    }
+#else
+    (void)size;
+#endif
+}
+
+json::stats::collector::collector() : previous(NULL)
+{
+#if JSON_ENABLE_STATS
+    this->previous = active_collector;
+    active_collector = this;
+#endif
+}
+
+json::stats::collector::~collector()
+{
+#if JSON_ENABLE_STATS
+    active_collector = this->previous;
+#endif
+}
+
+json::stats::allocations json::stats::collector::total() const
+{
+    allocations result;
+    for(size_t i = 0; i < OPERATION_COUNT; i++)
+    {
+        result.count += this->counts[i].count;
+        result.bytes += this->counts[i].bytes;
+    }
+    return result;
+}
+
+#if JSON_ENABLE_STATS
+json::stats::scope::scope(const operation op, const bool timed) : outermost(current_operation < 0), op(op), timed(timed), start(0)
+{
+    if(!this->outermost) return;
+    current_operation = op;
+    if(this->timed) this->start = monotonic_ns();
+}
+
+json::stats::scope::~scope()
+{
+    if(!this->outermost) return;
+    current_operation = -1;
+    if(this->timed) record_latency(this->op, monotonic_ns() - this->start);
+}
+
+/*! \brief Adds a sample to the latency histogram of an operation
+ *
+ * @param op The operation that was timed
+ * @param elapsed Its duration, in nanoseconds
+ */
+static void record_latency(const json::stats::operation op, const uint64_t elapsed)
+{
+    size_t bucket = 0;
+    while(bucket + 1 < json::stats::histogram::BUCKETS && (elapsed >> bucket) != 0) bucket++;
+    latency_buckets[op][bucket].fetch_add(1, std::memory_order_relaxed);
+    latency_counts[op].fetch_add(1, std::memory_order_relaxed);
+    latency_totals[op].fetch_add(elapsed, std::memory_order_relaxed);
+}
+
+void* json::stats::allocate(const size_t size)
+{
+    void *memory = json::stats::allocate(size, std::nothrow);
+    if(memory == NULL) throw std::bad_alloc();
+    return memory;
+}
+
+void* json::stats::allocate(const size_t size, const std::nothrow_t &) noexcept
+{
+    record_allocation(size);
+    return malloc(size == 0 ? 1 : size);
+}
+
+void json::stats::deallocate(void *memory) noexcept
+{
+    free(memory);
+}
+#endif
@@ -12,6 +12,112 @@
 #include <utility>
 #include <stdexcept>
 #include <cctype>
+#include <stdint.h>
+
+/*! \brief Set to 1 when the compiler supports C++11 features such as move semantics
+ *
+ * Simpleson remains C++98 compatible. Features that require C++11 are only enabled when this flag is set.
+ */
+#ifndef JSON_HAS_CXX11
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define JSON_HAS_CXX11 1
+#else
+#define JSON_HAS_CXX11 0
+#endif
+#endif
+
+/*! \brief Set to 1 if the compiler supports C++14
+ *
+ * \details Enables features that rely on relaxed constexpr functions.
+ */
+#ifndef JSON_HAS_CXX14
+#if __cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+#define JSON_HAS_CXX14 1
+#else
+#define JSON_HAS_CXX14 0
+#endif
+#endif
+
+/*! \brief Set to 1 to compile in the instrumentation of json::stats
+ *
+ * \details The flag must have the same value for the library and all code including json.h, and requires C++11.
+ */
+#ifndef JSON_ENABLE_STATS
+#define JSON_ENABLE_STATS 0
+#endif
+#if JSON_ENABLE_STATS && !JSON_HAS_CXX11
+#error "JSON_ENABLE_STATS requires C++11"
+#endif
+#if JSON_ENABLE_STATS
+#include <new>
+#endif
+
+/*! \brief Moves a value when move semantics are available and copies it otherwise
+ *
+ * @param value The value to be moved
+ */
+#if JSON_HAS_CXX11
+#define JSON_MOVE(value) std::move(value)
+#else
+#define JSON_MOVE(value) (value)
+#endif
+
+/*! \brief Attributes the allocations made in the enclosing block to a json::stats::operation
+ *
+ * @param op The name of the operation, such as `PARSE`
+ */
+#if JSON_ENABLE_STATS
+#define JSON_STATS_SCOPE(op) const json::stats::scope json_stats_scope(json::stats::op)
+#else
+#define JSON_STATS_SCOPE(op)
+#endif
+
+/*! \brief Defines replacements of the global allocation functions that report to json::stats::record_allocation()
+ *
+ * \details The library does not replace the global allocator itself. An application that wants allocations counted expands this macro once, at global scope in one of its source files. The plain, array, nothrow and sized forms are all replaced so that every allocation is paired with a matching deallocation. Over-aligned allocations are left to the default implementation and are not counted. Without JSON_ENABLE_STATS the macro expands to nothing.
+ */
+#if JSON_ENABLE_STATS
+#if defined(__cpp_sized_deallocation)
+#define JSON_STATS_DEFINE_SIZED_DELETE \
+	void operator delete(void *memory, std::size_t) noexcept { json::stats::deallocate(memory); } \
+	void operator delete[](void *memory, std::size_t) noexcept { json::stats::deallocate(memory); }
+#else
+#define JSON_STATS_DEFINE_SIZED_DELETE
+#endif
+#define JSON_STATS_DEFINE_NEW \
+	void* operator new(std::size_t size) { return json::stats::allocate(size); } \
+	void* operator new[](std::size_t size) { return json::stats::allocate(size); } \
+	void* operator new(std::size_t size, const std::nothrow_t &) noexcept { return json::stats::allocate(size, std::nothrow); } \
+	void* operator new[](std::size_t size, const std::nothrow_t &) noexcept { return json::stats::allocate(size, std::nothrow); } \
+	void operator delete(void *memory) noexcept { json::stats::deallocate(memory); } \
+	void operator delete[](void *memory) noexcept { json::stats::deallocate(memory); } \
+	void operator delete(void *memory, const std::nothrow_t &) noexcept { json::stats::deallocate(memory); } \
+	void operator delete[](void *memory, const std::nothrow_t &) noexcept { json::stats::deallocate(memory); } \
+	JSON_STATS_DEFINE_SIZED_DELETE
+#else
+#define JSON_STATS_DEFINE_NEW
+#endif
+
+/*! \brief Counts characters of input consumed by the operation of the enclosing #JSON_STATS_SCOPE, if the application invoked it directly
+ *
+ * @param amount The number of characters, which is not evaluated without JSON_ENABLE_STATS
+ */
+#if JSON_ENABLE_STATS
+#define JSON_STATS_COUNT_INPUT(amount) if(json_stats_scope.is_outermost()) json::stats::increment(json::stats::INPUT_CHARACTERS, amount)
+#else
+#define JSON_STATS_COUNT_INPUT(amount) ((void)0)
+#endif
+
+/*! \brief Adds to a json::stats::counter
+ *
+ * @param counter The name of the counter, such as `REPARSES`
+ * @param amount The amount to add, which is not evaluated without JSON_ENABLE_STATS
+ */
+#if JSON_ENABLE_STATS
+#define JSON_STATS_COUNT(counter, amount) json::stats::increment(json::stats::counter, amount)
+#else
+#define JSON_STATS_COUNT(counter, amount) ((void)0)
+#endif
 
 /*! \brief Base namespace for simpleson */
 namespace json
@@ -53,6 +159,248 @@ namespace json
 		inline virtual ~parsing_error() throw() { }
 	};
 
+	/*! \brief Exception used when a string is not valid UTF-8 */
+	class invalid_utf8 : public parsing_error
+	{
+	public:
+		/*! \brief The byte offset of the first invalid UTF-8 sequence */
+		const size_t offset;
+
+		/*! \brief Constructor
+		 *
+		 * @param offset The byte offset of the first invalid UTF-8 sequence
+		 */
+		inline invalid_utf8(const size_t offset) : parsing_error("Invalid UTF-8 sequence"), offset(offset) { }
+
+		/*! \brief Destructor */
+		inline virtual ~invalid_utf8() throw() { }
+	};
+
+	/*! \brief Exception used when a JSON Patch cannot be applied */
+	class patch_error : public std::runtime_error
+	{
+	public:
+		/*! \brief The index of the operation that failed */
+		const size_t operation;
+
+		/*! \brief Constructor
+		 *
+		 * @param operation The index of the operation that failed
+		 * @param message Details regarding the failure
+		 */
+		inline patch_error(const size_t operation, const std::string &message) : std::runtime_error(message), operation(operation) { }
+
+		/*! \brief Destructor */
+		inline virtual ~patch_error() throw() { }
+	};
+
+	class jobject;
+
+	/*! \brief Namespace for the opt-in instrumentation
+	 *
+	 * \details Instrumentation is compiled in when JSON_ENABLE_STATS is set to 1. Heap allocations are counted when the application routes its global `operator new` through json::stats::record_allocation(), either with #JSON_STATS_DEFINE_NEW or from its own replacement; the library never replaces the global allocator itself. Each allocation is attributed to the outermost simpleson operation running on the thread, such as a parse, a serialization or an accessor call, and allocations made outside of simpleson are not counted.
+	 *
+	 * Without JSON_ENABLE_STATS the API is still available, but every counter stays at zero.
+	 */
+	namespace stats
+	{
+		/*! \brief Operations that allocations are attributed to */
+		enum operation
+		{
+			PARSE, ///< Parsing text or binary input, including json::reader
+			SERIALIZE, ///< Serializing to text or binary output
+			ACCESS, ///< Reading or writing a value through an accessor
+			OPERATION_COUNT ///< The number of operations
+		};
+
+		/*! \brief Heap allocations counted for an operation */
+		struct allocations
+		{
+			/*! \brief The number of allocations */
+			uint64_t count;
+
+			/*! \brief The number of bytes requested */
+			uint64_t bytes;
+
+			/*! \brief Constructor */
+			allocations() : count(0), bytes(0) { }
+		};
+
+		/*! \brief Returns the name of an operation */
+		const char* name(const operation op);
+
+		/*! \brief Returns the allocations made for an operation by all threads since the program started or the last reset */
+		allocations allocated(const operation op);
+
+		/*! \brief Resets the process-wide counters */
+		void reset();
+
+		/*! \brief Counts a heap allocation made on the current thread
+		 *
+		 * \details Called from the application's replacement `operator new`. Allocations made outside of a simpleson operation are ignored.
+		 * @param size The number of bytes requested
+		 */
+		void record_allocation(const size_t size);
+
+		#if JSON_ENABLE_STATS
+		/*! \brief Allocates memory and records the allocation, for the replacements defined by #JSON_STATS_DEFINE_NEW
+		 *
+		 * \exception std::bad_alloc Thrown if the memory cannot be allocated
+		 */
+		void* allocate(const size_t size);
+
+		/*! \brief Allocates memory and records the allocation, returning `NULL` on failure */
+		void* allocate(const size_t size, const std::nothrow_t &) noexcept;
+
+		/*! \brief Releases memory obtained from json::stats::allocate() */
+		void deallocate(void *memory) noexcept;
+		#endif
+
+		/*! \class collector
+		 * \brief Collects the allocations made by simpleson on the current thread while it is in scope
+		 *
+		 * \details Collectors may be nested, and an allocation is added to every collector active on the thread. Collectors must be destroyed in the reverse order of their construction, which holds when they are used as local variables.
+		 */
+		class collector
+		{
+		private:
+			/*! \brief The allocations counted for each operation */
+			allocations counts[OPERATION_COUNT];
+
+			/*! \brief The collector that was active when this one was constructed */
+			collector *previous;
+
+			/*! \brief Copying is not supported */
+			collector(const collector &other);
+
+			/*! \brief Copying is not supported */
+			collector& operator=(const collector &other);
+
+			friend void record_allocation(const size_t size);
+
+		public:
+			/*! \brief Starts collecting on the current thread */
+			collector();
+
+			/*! \brief Stops collecting */
+			~collector();
+
+			/*! \brief Returns the allocations collected for an operation */
+			inline const allocations& operator[](const operation op) const
+			{
+				return this->counts[op];
+			}
+
+			/*! \brief Returns the allocations collected for all operations */
+			allocations total() const;
+		};
+
+		/*! \brief Events counted on the hot paths of the library */
+		enum counter
+		{
+			INPUT_CHARACTERS, ///< Characters of JSON text consumed by the parse the application invoked, or pushed into a json::reader by the application
+			SUB_READERS, ///< Readers created by json::reader for nested values
+			REPARSES, ///< Stored values parsed again by accessors and type checks
+			FORMAT_CALLS, ///< Calls to `sscanf` and `snprintf` for number conversions
+			KEY_LOOKUPS, ///< Keys looked up in a json::jobject
+			KEY_COMPARISONS, ///< Keys compared while looking up keys, the total scan length of KEY_LOOKUPS
+			COUNTER_COUNT ///< The number of counters
+		};
+
+		/*! \brief A histogram of operation latencies with power-of-two buckets */
+		struct histogram
+		{
+			/*! \brief The number of buckets */
+			static const size_t BUCKETS = 32;
+
+			/*! \brief Bucket `i` counts operations that took less than 2^i nanoseconds and, except for the first, at least 2^(i-1). The last bucket also counts longer operations. */
+			uint64_t buckets[BUCKETS];
+
+			/*! \brief The number of operations */
+			uint64_t count;
+
+			/*! \brief The total duration of the operations in nanoseconds */
+			uint64_t total_ns;
+
+			/*! \brief Constructor */
+			histogram() : count(0), total_ns(0)
+			{
+				for(size_t i = 0; i < BUCKETS; i++) this->buckets[i] = 0;
+			}
+		};
+
+		/*! \brief Returns the name of a counter */
+		const char* name(const counter c);
+
+		/*! \brief Adds to a counter
+		 *
+		 * \details Called by the library through JSON_STATS_COUNT
+		 * @param c The counter
+		 * @param amount The amount to add
+		 */
+		void increment(const counter c, const uint64_t amount = 1);
+
+		/*! \brief Returns the value of a counter across all threads since the program started or the last reset */
+		uint64_t counted(const counter c);
+
+		/*! \brief Returns the latencies of an operation across all threads since the program started or the last reset
+		 *
+		 * \details Only the outermost operation on a thread is timed, so the latency of a parse includes the accessors it calls internally. A value streamed into a json::reader is timed once, from its first character to the character that completes it.
+		 */
+		histogram latency(const operation op);
+
+		/*! \brief Returns all process-wide statistics as an object
+		 *
+		 * \details The object has the members `enabled`, `allocations` (count and bytes for each operation), `counters` and `latency` (count, total_ns and buckets for each operation), so that it can be serialized for a metrics agent.
+		 */
+		json::jobject dump();
+
+		#if JSON_ENABLE_STATS
+		/*! \brief Attributes the allocations on the current thread to an operation while in scope, and times it
+		 *
+		 * \details Only the outermost scope on a thread takes effect, so the allocations and latency of nested library calls are attributed to the operation that the application invoked.
+		 */
+		class scope
+		{
+		private:
+			/*! \brief Set if this scope selected the operation */
+			bool outermost;
+
+			/*! \brief The operation being performed */
+			operation op;
+
+			/*! \brief Set if the latency of the operation is recorded */
+			bool timed;
+
+			/*! \brief The time at which the operation started, in nanoseconds */
+			uint64_t start;
+
+			/*! \brief Copying is not supported */
+			scope(const scope &other);
+
+			/*! \brief Copying is not supported */
+			scope& operator=(const scope &other);
+
+		public:
+			/*! \brief Constructor
+			 *
+			 * @param op The operation being performed
+			 * @param timed When false, allocations are attributed to the operation but its latency is not recorded
+			 */
+			explicit scope(const operation op, const bool timed = true);
+
+			/*! \brief Destructor */
+			~scope();
+
+			/*! \brief Returns true if this is the outermost scope on the thread */
+			inline bool is_outermost() const
+			{
+				return this->outermost;
+			}
+		};
+		#endif
+	}
+
 	/*\brief Alias for a list of keys */
 	typedef std::vector<std::string> key_list_t;
 
@@ -93,8 +441,11 @@ namespace json
 			WHITESPACE ///< The character was whitespace. Reading should continue but the whtiespace was not stored. 
 		};
 
-		/*! \brief Reader constructor */
-		inline reader() : std::string(), sub_reader(NULL) { this->clear(); }
+		/*! \brief Reader constructor
+		 *
+		 * @param validate_utf8 When true, strings are validated as UTF-8 as they are read and invalid sequences are rejected
+		 */
+		inline reader(const bool validate_utf8 = false) : std::string(), sub_reader(NULL), utf8_validation(validate_utf8) { this->clear(); }
 
 		/*! \brief Resets the reader */
 		virtual void clear();
@@ -135,6 +486,12 @@ namespace json
 		 */
 		virtual bool is_valid() const;
 
+		/*! \brief Checks if reading stopped because of an invalid UTF-8 sequence
+		 *
+		 * \returns `true` if UTF-8 validation is enabled and an invalid sequence was rejected, `false` otherwise
+		 */
+		virtual bool utf8_error() const;
+
 		/*! \brief Returns the stored value 
 		 *
 		 * \returns A string containing the stored value
@@ -152,6 +509,11 @@ namespace json
 		 */
 		reader *sub_reader;
 
+		#if JSON_ENABLE_STATS
+		/*! \brief The time at which the application pushed the first character of the value, in nanoseconds, or zero if the value is not being timed */
+		uint64_t stats_start;
+		#endif
+
 		/*! \brief Pushes a character to a string value */
 		push_result push_string(const char next);
 
@@ -237,14 +599,23 @@ namespace json
 	private:
 		/*! \brief Storage for the current state of the reader */
 		char read_state;
+
+		/*! \brief Flag for validating strings as UTF-8 */
+		bool utf8_validation;
+
+		/*! \brief Storage for the state of the UTF-8 validator */
+		unsigned char utf8_state;
 	};
 
 	/*! \brief Class for reading object key value pairs */
 	class kvp_reader : public reader
 	{
 	public:
-		/*! \brief Constructor */
-		inline kvp_reader() : reader()
+		/*! \brief Constructor
+		 *
+		 * @param validate_utf8 When true, the key and value are validated as UTF-8
+		 */
+		inline kvp_reader(const bool validate_utf8 = false) : reader(validate_utf8), _key(validate_utf8)
 		{ 
 			this->clear();
 		}
@@ -272,6 +643,9 @@ namespace json
 			return reader::is_valid() && this->_key.is_valid();
 		}
 
+		/*! \brief Checks if reading stopped because of an invalid UTF-8 sequence in the key or value */
+		virtual bool utf8_error() const;
+
 		/*! \brief Reads out the key value pair
 		 *
 		 * \returns JSON-encoded key and JSON-encoded value seperated by a colon (:)
@@ -312,20 +686,54 @@ namespace json
 		 * \details The quotation mark ("), reverse solidus (\), solidus (/), backspace (b), formfeed (f), linefeed (n), carriage return (r), horizontal tab (t), and Unicode character will be unescaped
 		 * @param input A string, encapsulated in quotations ("), potentially containing escaped control characters
 		 * @return A string with control characters un-escaped
-		 * \note This function will strip leading and trailing quotations. 
+		 * \note This function will strip leading and trailing quotations.
+		 * \note Escaped Unicode characters (including surrogate pairs) are decoded to UTF-8. Unpaired surrogates are replaced by U+FFFD.
 		 * @see encode_string
 		 */
 		std::string decode_string(const char * input);
 
+		/*! \brief Decodes a string in JSON format and appends the result to an existing string
+		 *
+		 * \details Runs of characters without escape sequences are copied in bulk
+		 * @param input A string, encapsulated in quotations ("), potentially containing escaped control characters
+		 * @param[out] output The string the decoded value is appended to
+		 * @return A pointer to the first character after the closing quotation
+		 * \exception json::parsing_error Thrown if the input is not a valid string
+		 * @see decode_string(const char*)
+		 */
+		const char* decode_string(const char *input, std::string &output);
+
 		/*! \brief Encodes a string in JSON format
 		 *
-		 * \details The quotation mark ("), reverse solidus (\), solidus (/), backspace (b), formfeed (f), linefeed (n), carriage return (r), horizontal tab (t), and Unicode character will be escaped
+		 * \details The quotation mark ("), reverse solidus (\), solidus (/), backspace (b), formfeed (f), linefeed (n), carriage return (r), horizontal tab (t), and Unicode character will be escaped. All other control characters are escaped as `\uXXXX`.
 		 * @param input A string potentially containing control characters
+		 * @param ascii_only When true, characters outside of the ASCII range are escaped as `\uXXXX` so that the output is pure ASCII
 		 * @return A string that has all control characters escaped with a reverse solidus (\)
-		 * \note This function will add leading and trailing quotations. 
+		 * \note This function will add leading and trailing quotations.
 		 * @see decode_string
 		 */
-		std::string encode_string(const char *input);
+		std::string encode_string(const char *input, const bool ascii_only = false);
+
+		/*! \brief Encodes a string in JSON format and appends the result to an existing string
+		 *
+		 * \details Runs of characters that do not require escaping are located a machine word at a time and copied in bulk
+		 * @param input The characters to be encoded
+		 * @param length The number of characters to be encoded
+		 * @param[out] output The string the encoded value (including the leading and trailing quotations) is appended to
+		 * @param ascii_only When true, characters outside of the ASCII range are escaped as `\uXXXX` so that the output is pure ASCII
+		 * \note When `ascii_only` is true, the input is expected to be UTF-8. Bytes that are not part of a valid UTF-8 sequence are escaped as the equivalent Latin-1 character.
+		 * @see encode_string(const char*, const bool)
+		 */
+		void encode_string(const char *input, const size_t length, std::string &output, const bool ascii_only = false);
+
+		/*! \brief Validates UTF-8 encoded text
+		 *
+		 * \details ASCII text is skipped a machine word at a time, and all other text is checked with a table-driven state machine
+		 * @param input The text to validate
+		 * @param length The number of bytes to validate
+		 * @return The byte offset of the first invalid (or truncated) UTF-8 sequence, or `length` if the text is valid
+		 */
+		size_t validate_utf8(const char *input, const size_t length);
 
 		/*! \brief Structure for capturing the results of parsing */
 		struct parse_results
@@ -343,10 +751,12 @@ namespace json
 		/*! \brief Parses the first value encountered in a JSON string
 		 *
 		 * @param input The string to be parsed
+		 * @param validate_utf8 When true, strings are validated as UTF-8 while they are read
 		 * @return Details regarding the first value encountered 
 		 * \exception json::parsing_error Exception thrown when the input is not valid JSON
+		 * \exception json::invalid_utf8 Exception thrown when validation is enabled and a string is not valid UTF-8
 		 */
-		parse_results parse(const char *input);
+		parse_results parse(const char *input, const bool validate_utf8 = false);
 		
 		/*! \brief Template for reading a numeric value 
 		 * 
@@ -359,6 +769,7 @@ namespace json
 		T get_number(const char *input, const char* format)
 		{
 			T result;
+			JSON_STATS_COUNT(FORMAT_CALLS, 1);
 			std::sscanf(input, format, &result);
 			return result;
 		}
@@ -374,17 +785,50 @@ namespace json
 		std::string get_number_string(const T &number, const char *format)
 		{
 			std::vector<char> cstr(6);
+			JSON_STATS_COUNT(FORMAT_CALLS, 1);
 			int remainder = std::snprintf(&cstr[0], cstr.size(), format, number);
 			if(remainder < 0) {
 				return std::string();
 			} else if(remainder >= (int)cstr.size()) {
 				cstr.resize(remainder + 1);
+				JSON_STATS_COUNT(FORMAT_CALLS, 1);
 				std::snprintf(&cstr[0], cstr.size(), format, number);
 			}
 			std::string result(&cstr[0]);
 			return result;
 		}
 
+		/*! \brief Compares two serialized JSON values structurally
+		 *
+		 * \details Strings are compared by their decoded content, numbers by their value (`1.0`, `1e0` and `1` are equal), and objects and arrays member by member. The comparison stops at the first difference and does not allocate memory, except to index the keys of objects with more than 256 members whose members are in a different order.
+		 * @param lhs The first serialized value
+		 * @param rhs The second serialized value
+		 * @param ignore_order When true, objects with the same members in a different order are considered equal
+		 * @return True if the values are structurally equal, false otherwise
+		 * \note Malformed input is never considered equal
+		 */
+		bool equal(const char *lhs, const char *rhs, const bool ignore_order = true);
+
+		/*! \brief Computes a structural hash of a serialized JSON value
+		 *
+		 * \details The hash is computed in a single traversal and is consistent with json::parsing::equal, meaning structurally equal values hash to the same value regardless of white space, escaping, or number formatting. String content is hashed a machine word at a time.
+		 * @param input The serialized value
+		 * @param ignore_order When true, the hash of an object does not depend on the order of its members
+		 * @return A 64-bit hash of the value
+		 */
+		uint64_t hash(const char *input, const bool ignore_order = true);
+
+		/*! \brief Evaluates a JSON Pointer (RFC 6901) against a serialized JSON value
+		 *
+		 * \details The serialized text is walked directly. Members and elements that are not on the path are skipped by bracket matching without being parsed or copied, and only the final value is copied.
+		 * @param input The serialized value
+		 * @param pointer The JSON Pointer, such as `/a/b/3/c`
+		 * @return The serialized value the pointer refers to
+		 * \exception json::invalid_key Thrown if the pointer does not refer to a value
+		 * \exception std::invalid_argument Thrown if the pointer is malformed
+		 */
+		std::string at_pointer(const char *input, const std::string &pointer);
+
 		/*! \brief Parses a JSON array
 		 *
 		 * \details Converts a serialized JSON array into a vector of the values in the array
@@ -397,6 +841,8 @@ namespace json
 	/*! \brief (k)ey (v)alue (p)air */
 	typedef std::pair<std::string, std::string> kvp;
 
+	class packed_object;
+
 	/*! \class jobject
 	 * \brief The class used for manipulating JSON objects and arrays
 	 *
@@ -421,23 +867,118 @@ namespace json
 		 */
 		bool array_flag;
 
+		/*! \brief State derived from the entries to speed up hashing and lookups */
+		struct cache
+		{
+			/*! \brief Cached hashes of the object, indexed by whether the order of members is ignored */
+			uint64_t hashes[2];
+
+			/*! \brief Bit flags marking which entries of #hashes are valid */
+			unsigned char hash_valid;
+
+			/*! \brief Open addressing table of entry positions, offset by one, keyed by the hash of their keys
+			 *
+			 * \details The table is built on demand once an object is large enough for lookups to benefit, and entries appended since are added on the next lookup
+			 */
+			std::vector<size_t> key_index;
+
+			/*! \brief The number of leading entries recorded in #key_index */
+			size_t indexed_entries;
+
+			/*! \brief Constructor */
+			cache() : hash_valid(0), indexed_entries(0) { }
+		};
+
+		/*! \brief The cached state, allocated the first time the object is hashed or a large object is searched
+		 *
+		 * \details Objects that are never hashed or searched by key do not carry the cache. Copies start without it and build their own when needed.
+		 */
+		mutable cache *cached;
+
+		friend class json::packed_object;
+
+		/*! \brief Returns the cached state, allocating it if necessary */
+		inline cache& cached_state() const
+		{
+			if(this->cached == NULL) this->cached = new cache();
+			return *this->cached;
+		}
+
+		/*! \brief Discards cached state after the object is modified */
+		inline void modified()
+		{
+			if(this->cached == NULL) return;
+			this->cached->hash_valid = 0;
+			this->cached->key_index.clear();
+			this->cached->indexed_entries = 0;
+		}
+
+		/*! \brief Discards cached state after values are changed or entries are appended
+		 *
+		 * \details Neither changes the position of an existing key, so the key index remains valid
+		 */
+		inline void values_modified()
+		{
+			if(this->cached != NULL) this->cached->hash_valid = 0;
+		}
+
+		/*! \brief Finds the entry for a key
+		 *
+		 * \details Small objects are searched linearly. Larger objects use cache::key_index.
+		 * @param key The key to search for
+		 * @return The index of the entry, or the number of entries if the key is not present
+		 */
+		size_t find_key(const std::string &key) const;
+
+		/*! \brief Merges the members of an object into this object
+		 *
+		 * @param overlay The object whose members are merged
+		 * @param patch True for JSON Merge Patch semantics, where null removes a member
+		 */
+		void merge_members(const jobject &overlay, const bool patch);
+
+		/*! \brief Verifies a key can be added to the object or array
+		 *
+		 * @param key The key of the entry to be added
+		 * \exception json::parsing_error Thrown if the key conflicts with an existing key or is incompatible with the object (object/array mismatch)
+		 */
+		inline void check_entry(const std::string &key) const
+		{
+			if (!this->array_flag && this->find_key(key) < this->size()) throw json::parsing_error("Key conflict");
+			if(this->array_flag && key != "") throw json::parsing_error("Array cannot have key");
+			if(!this->array_flag && key == "") throw json::parsing_error("Missing key");
+		}
+
 	public:
 		/*! \brief Default constructor
 		 *
 		 * @param array If true, the instance is initialized as an array. If false, the instance is initalized as an object. 
 		 */
 		inline jobject(bool array = false)
-			: array_flag(array) 
+			: array_flag(array),
+			cached(NULL)
 			{ }
 
 		/*! \brief Copy constructor */
 		inline jobject(const jobject &other)
 			: data(other.data),
-			array_flag(other.array_flag)
-		{ }
+			array_flag(other.array_flag),
+			cached(NULL)
+			{ }
+
+		#if JSON_HAS_CXX11
+		/*! \brief Move constructor */
+		inline jobject(jobject &&other) noexcept
+			: data(std::move(other.data)),
+			array_flag(other.array_flag),
+			cached(other.cached)
+		{
+			other.cached = NULL;
+		}
+		#endif
 
 		/*! \brief Destructor */
-		inline virtual ~jobject() { }
+		inline virtual ~jobject() { delete this->cached; }
 
 		/*! \brief Flag for differentiating objects and arrays
 		 *
@@ -449,24 +990,126 @@ namespace json
 		inline size_t size() const { return this->data.size(); }
 
 		/*! \brief Clears the JSON object or array */
-		inline void clear() { this->data.resize(0); }
+		inline void clear() { this->data.resize(0); this->modified(); }
+
+		/*! \brief Applies a JSON Patch (RFC 6902)
+		 *
+		 * \details Supports the `add`, `remove`, `replace`, `move`, `copy` and `test` operations. An operation below the top level rewrites only the affected span of the serialized entry that contains it, without parsing or re-serializing the rest of that entry or any other entry. If an operation fails, the operations already applied are undone and the object is left unchanged.
+		 * @param operations A JSON array of patch operations
+		 * @return A reference to this object
+		 * \exception json::patch_error Thrown if an operation is malformed, refers to a missing value, or fails a test
+		 */
+		jobject& apply_patch(const jobject &operations);
+
+		/*! @see json::jobject::apply_patch(const jobject&) */
+		inline jobject& apply_patch(const std::string &operations)
+		{
+			return this->apply_patch(jobject::parse(operations));
+		}
+
+		/*! @see json::jobject::apply_patch(const jobject&) */
+		inline jobject& apply_patch(const char *operations)
+		{
+			return this->apply_patch(jobject::parse(operations));
+		}
+
+		/*! \brief Computes a JSON Patch (RFC 6902) that transforms this object into another
+		 *
+		 * \details Identical subtrees are skipped after a structural comparison, starting with the cached hashes of the two objects. Object members are matched by key, so only changed members produce operations. Arrays are compared by the hashes of their elements: common leading and trailing elements are skipped, the remainder is aligned by a longest common subsequence when it is small enough, and elements that line up but differ are diffed recursively.
+		 * @param target The object to transform this object into
+		 * @return A JSON array of operations for json::jobject::apply_patch
+		 */
+		jobject diff(const jobject &target) const;
+
+		/*! \brief Applies a JSON Merge Patch (RFC 7386) in place
+		 *
+		 * \details Members of the patch that are null remove the matching member, objects are merged recursively and any other value replaces the matching member. Keys are matched through a hashed index, and each nested object the patch names is rebuilt in a single pass over its serialized text. The cost therefore follows the size of the patch and of the members it merges into, and members the patch does not name are not visited. An array patch replaces this object.
+		 * @param patch The merge patch
+		 * @return A reference to this object
+		 */
+		jobject& merge_patch(const jobject &patch);
+
+		/*! @see json::jobject::merge_patch(const jobject&) */
+		inline jobject& merge_patch(const std::string &patch)
+		{
+			return this->merge_patch(jobject::parse(patch));
+		}
+
+		/*! @see json::jobject::merge_patch(const jobject&) */
+		inline jobject& merge_patch(const char *patch)
+		{
+			return this->merge_patch(jobject::parse(patch));
+		}
+
+		/*! \brief Deep merges an object into this object in place
+		 *
+		 * \details Works like json::jobject::merge_patch, except that null values are stored rather than removing members. Unlike json::jobject::operator+=, existing members are overwritten instead of causing a conflict. An array, or an object merged into an array, replaces this object.
+		 * @param overlay The object to merge
+		 * @return A reference to this object
+		 */
+		jobject& merge(const jobject &overlay);
+
+		/*! @see json::jobject::merge(const jobject&) */
+		inline jobject& merge(const std::string &overlay)
+		{
+			return this->merge(jobject::parse(overlay));
+		}
+
+		/*! @see json::jobject::merge(const jobject&) */
+		inline jobject& merge(const char *overlay)
+		{
+			return this->merge(jobject::parse(overlay));
+		}
+
+		/*! \brief Compares two JSON objects or arrays structurally
+		 *
+		 * @param other The object or array to compare against
+		 * @param ignore_order When true, object members may appear in any order
+		 * @return True if the objects or arrays are structurally equal
+		 * @see json::parsing::equal
+		 */
+		bool equals(const jobject &other, const bool ignore_order = true) const;
+
+		/*! \brief Computes a structural hash of the object or array
+		 *
+		 * \details The hash is cached until the object is modified, so repeated hashing of an unchanged object is O(1)
+		 * @param ignore_order When true, the hash does not depend on the order of the object's members
+		 * @return A 64-bit hash that matches json::parsing::hash of the serialized object
+		 */
+		uint64_t hash(const bool ignore_order = true) const;
 
 		/*! \brief Comparison operator
 		 *
-		 * \todo Currently, the comparison just seralizes both objects and compares the strings, which is probably not as efficent as it could be
+		 * \details Objects are equal when they have the same members in any order
+		 * @see json::jobject::equals
 		 */
-		bool operator== (const json::jobject other) const { return ((std::string)(*this)) == (std::string)other; }
+		bool operator== (const json::jobject &other) const { return this->equals(other); }
 
 		/*! \brief Comparison operator */
-		bool operator!= (const json::jobject other) const { return ((std::string)(*this)) != (std::string)other; }
+		bool operator!= (const json::jobject &other) const { return !this->equals(other); }
 
 		/*! \brief Assignment operator */
-		inline jobject& operator=(const jobject rhs)
+		inline jobject& operator=(const jobject &rhs)
 		{
 			this->array_flag = rhs.array_flag;
 			this->data = rhs.data;
+			this->modified();
+			return *this;
+		}
+
+		#if JSON_HAS_CXX11
+		/*! \brief Move assignment operator */
+		inline jobject& operator=(jobject &&rhs) noexcept
+		{
+			if(this == &rhs) return *this;
+			this->array_flag = rhs.array_flag;
+			this->data = std::move(rhs.data);
+			delete this->cached;
+			this->cached = rhs.cached;
+			rhs.cached = NULL;
 			return *this;
 		}
+		#endif
 
 		/*! \brief Appends a key-value pair to a JSON object
 		 *
@@ -474,26 +1117,60 @@ namespace json
 		 */
 		jobject& operator+=(const kvp& other)
 		{
-			if (!this->array_flag && this->has_key(other.first)) throw json::parsing_error("Key conflict");
-			if(this->array_flag && other.first != "") throw json::parsing_error("Array cannot have key");
-			if(!this->array_flag && other.first == "") throw json::parsing_error("Missing key");
+			this->check_entry(other.first);
+			this->values_modified();
 			this->data.push_back(other);
 			return *this;
 		}
 
+		#if JSON_HAS_CXX11
+		/*! \brief Appends a key-value pair to a JSON object by moving it into the object
+		 *
+		 * \exception json::parsing_error Thrown if the key-value is incompatable with the existing object (object/array mismatch)
+		 */
+		jobject& operator+=(kvp &&other)
+		{
+			this->check_entry(other.first);
+			this->values_modified();
+			this->data.push_back(std::move(other));
+			return *this;
+		}
+		#endif
+
 		/*! \brief Appends one JSON object to another */
 		jobject& operator+=(const jobject& other)
 		{
 			if(this->array_flag != other.array_flag) throw json::parsing_error("Array/object mismatch");
-			json::jobject copy(other);
-			for (size_t i = 0; i < copy.size(); i++) {
-				this->operator+=(copy.data.at(i));
+			// Capture the size first so that appending an array to itself is well defined
+			const size_t count = other.size();
+			this->data.reserve(this->data.size() + count);
+			for (size_t i = 0; i < count; i++) {
+				this->operator+=(other.data[i]);
+			}
+			return *this;
+		}
+
+		#if JSON_HAS_CXX11
+		/*! \brief Appends one JSON object to another by moving the entries of the other object */
+		jobject& operator+=(jobject &&other)
+		{
+			if(this->array_flag != other.array_flag) throw json::parsing_error("Array/object mismatch");
+			if(this->data.empty()) {
+				this->data = std::move(other.data);
+				this->modified();
+				other.modified();
+				return *this;
+			}
+			this->data.reserve(this->data.size() + other.size());
+			for (size_t i = 0; i < other.size(); i++) {
+				this->operator+=(std::move(other.data[i]));
 			}
 			return *this;
 		}
+		#endif
 
 		/*! \brief Merges two JSON objects */
-		jobject operator+(jobject& other)
+		jobject operator+(const jobject& other) const
 		{
 			jobject result = *this;
 			result += other;
@@ -503,16 +1180,18 @@ namespace json
 		/*! \brief Parses a serialized JSON string
 		 *
 		 * @param input Serialized JSON string
+		 * @param validate_utf8 When true, all keys and string values are validated as UTF-8 during parsing
 		 * @return JSON object or array
 		 * \exception json::parsing_error Thrown when the input string is not valid JSON
+		 * \exception json::invalid_utf8 Thrown when validation is enabled and a string is not valid UTF-8. The offset is relative to the start of the input. 
 		 */
-		static jobject parse(const char *input);
+		static jobject parse(const char *input, const bool validate_utf8 = false);
 
 		/*! \brief Parses a serialized JSON string 
 		 *
-		 * @see json::jobject::parse(const char*)
+		 * @see json::jobject::parse(const char*, const bool)
 		 */
-		static inline jobject parse(const std::string input) { return parse(input.c_str()); }
+		static inline jobject parse(const std::string &input, const bool validate_utf8 = false) { return parse(input.c_str(), validate_utf8); }
 
 		/*! /brief Attempts to parse the input string
 		 * 
@@ -542,8 +1221,7 @@ namespace json
 		inline bool has_key(const std::string &key) const
 		{
 			if(this->array_flag) return false;
-			for (size_t i = 0; i < this->size(); i++) if (this->data.at(i).first == key) return true;
-			return false;
+			return this->find_key(key) < this->size();
 		}
 
 		/*! \brief Returns a list of the object's keys
@@ -561,6 +1239,25 @@ namespace json
 		 */
 		void set(const std::string &key, const std::string &value);
 
+		#if JSON_HAS_CXX11
+		/*! \brief Sets the value assocaited with the key by moving the value into the object
+		 *
+		 * @see json::jobject::set(const std::string&, const std::string&)
+		 */
+		void set(const std::string &key, std::string &&value);
+
+		/*! \brief Adds a new entry by moving the key and value into the object
+		 *
+		 * @param key The key for the entry. Must be empty if the instance represents an array.
+		 * @param value The serialized value for the entry
+		 * \exception json::parsing_error Thrown if the key already exists or is incompatible with the object (object/array mismatch)
+		 */
+		inline jobject& emplace(std::string &&key, std::string &&value)
+		{
+			return this->operator+=(kvp(std::move(key), std::move(value)));
+		}
+		#endif
+
 		/*! \brief Returns the serialized value at a given index
 		 *
 		 * @param index The index of the desired element
@@ -579,9 +1276,11 @@ namespace json
 		 */
 		inline std::string get(const std::string &key) const
 		{
+			JSON_STATS_SCOPE(ACCESS);
 			if(this->array_flag) throw json::invalid_key(key);
-			for (size_t i = 0; i < this->size(); i++) if (this->data.at(i).first == key) return this->get(i);
-			throw json::invalid_key(key);
+			const size_t index = this->find_key(key);
+			if(index == this->size()) throw json::invalid_key(key);
+			return this->get(index);
 		}
 
 		/*! \brief Removes the entry associated with the key
@@ -591,6 +1290,14 @@ namespace json
 		 */
 		void remove(const std::string &key);
 
+		/*! \brief Removes the entries associated with several keys
+		 *
+		 * \details The remaining entries are moved once, so removing many keys takes time linear in the size of the object, whereas removing them one at a time moves the following entries on every removal
+		 * @param keys The keys of the key value pairs to be removed
+		 * \note Keys that are not found in the object are ignored
+		 */
+		void remove(const key_list_t &keys);
+
 		/*! \brief Removes the entry at the specified index
 		 *
 		 * @param index The index of the element to be removed
@@ -598,6 +1305,7 @@ namespace json
 		void remove(const size_t index)
 		{
 			this->data.erase(this->data.begin() + index);
+			this->modified();
 		}
 
 		/*! \brief Representation of a value in the object */
@@ -619,6 +1327,7 @@ namespace json
 			template<typename T>
 			inline T get_number(const char* format) const
 			{
+				JSON_STATS_SCOPE(ACCESS);
 				return json::parsing::get_number<T>(this->ref().c_str(), format);
 			}
 
@@ -631,8 +1340,10 @@ namespace json
 			template<typename T>
 			inline std::vector<T> get_number_array(const char* format) const
 			{
+				JSON_STATS_SCOPE(ACCESS);
 				std::vector<std::string> numbers = json::parsing::parse_array(this->ref().c_str());
 				std::vector<T> result;
+				result.reserve(numbers.size());
 				for (size_t i = 0; i < numbers.size(); i++)
 				{
 					result.push_back(json::parsing::get_number<T>(numbers[i].c_str(), format));
@@ -644,6 +1355,7 @@ namespace json
 			/*! \brief Returns a string representation of the value */
 			inline std::string as_string() const
 			{
+				JSON_STATS_SCOPE(ACCESS);
 				return json::jtype::peek(*this->ref().c_str()) == json::jtype::jstring ?
 					json::parsing::decode_string(this->ref().c_str()) :
 					this->ref();
@@ -656,10 +1368,19 @@ namespace json
 			}
 
 			/*! \brief Comparison operator */
-			bool operator== (const std::string other) const { return ((std::string)(*this)) == other; }
+			bool operator== (const std::string &other) const { return ((std::string)(*this)) == other; }
 
 			/*! \brief Comparison operator */
-			bool operator!= (const std::string other) const { return !(((std::string)(*this)) == other); }
+			bool operator!= (const std::string &other) const { return !(((std::string)(*this)) == other); }
+
+			/*! \brief Computes a structural hash of the value
+			 *
+			 * @see json::parsing::hash
+			 */
+			inline uint64_t hash(const bool ignore_order = true) const
+			{
+				return json::parsing::hash(this->ref().c_str(), ignore_order);
+			}
 
 			/*! \brief Casts the value as an integer */
 			operator int() const;
@@ -688,6 +1409,8 @@ namespace json
 			 */
 			inline json::jobject as_object() const
 			{
+				JSON_STATS_SCOPE(ACCESS);
+				JSON_STATS_COUNT(REPARSES, 1);
 				return json::jobject::parse(this->ref().c_str());
 			}
 
@@ -721,8 +1444,11 @@ namespace json
 			/*! \brief Casts an array of JSON objects */
 			operator std::vector<json::jobject>() const
 			{
+				JSON_STATS_SCOPE(ACCESS);
 				const std::vector<std::string> objs = json::parsing::parse_array(this->ref().c_str());
+				JSON_STATS_COUNT(REPARSES, objs.size());
 				std::vector<json::jobject> results;
+				results.reserve(objs.size());
 				for (size_t i = 0; i < objs.size(); i++) {
 					results.push_back(json::jobject::parse(objs[i].c_str()));
 				}
@@ -730,7 +1456,11 @@ namespace json
 			}
 
 			/*! \brief Casts an array of strings */
-			operator std::vector<std::string>() const { return json::parsing::parse_array(this->ref().c_str()); }
+			operator std::vector<std::string>() const
+			{
+				JSON_STATS_SCOPE(ACCESS);
+				return json::parsing::parse_array(this->ref().c_str());
+			}
 
 			/*! \brief Casts an array
 			 *
@@ -739,24 +1469,32 @@ namespace json
 			template<typename T>
 			inline std::vector<T> as_array() const
 			{
-				return (std::vector<T>)(*this);
+				// Copy-initialization only considers the conversion operators, which keeps the cast unambiguous in C++98
+				const std::vector<T> result = *this;
+				return result;
 			}
 
 			/*! \brief Returns true if the value is a string */
 			inline bool is_string() const
 			{
+				JSON_STATS_SCOPE(ACCESS);
+				JSON_STATS_COUNT(REPARSES, 1);
 				return json::parsing::parse(this->ref().c_str()).type == json::jtype::jstring;
 			}
 
 			/*! \brief Returns true if the value is a number */
 			inline bool is_number() const
 			{
+				JSON_STATS_SCOPE(ACCESS);
+				JSON_STATS_COUNT(REPARSES, 1);
 				return json::parsing::parse(this->ref().c_str()).type == json::jtype::jnumber;
 			}
 
 			/*! \brief Returns true if the value is an object */
 			inline bool is_object() const
 			{
+				JSON_STATS_SCOPE(ACCESS);
+				JSON_STATS_COUNT(REPARSES, 1);
 				const jtype::jtype type = json::parsing::parse(this->ref().c_str()).type;
 				return type == json::jtype::jobject || type == json::jtype::jarray;
 			}
@@ -764,18 +1502,24 @@ namespace json
 			/*! \brief Returns true if the value is an array */
 			inline bool is_array() const
 			{
+				JSON_STATS_SCOPE(ACCESS);
+				JSON_STATS_COUNT(REPARSES, 1);
 				return json::parsing::parse(this->ref().c_str()).type == json::jtype::jarray;
 			}
 
 			/*! \brief Returns true if the value is a bool */
 			inline bool is_bool() const
 			{
+				JSON_STATS_SCOPE(ACCESS);
+				JSON_STATS_COUNT(REPARSES, 1);
 				return json::parsing::parse(this->ref().c_str()).type == json::jtype::jbool;
 			}
 
 			/*! \brief Returns true if the value is a boolean and set to true */
 			inline bool is_true() const
 			{
+				JSON_STATS_SCOPE(ACCESS);
+				JSON_STATS_COUNT(REPARSES, 1);
 				json::parsing::parse_results result = json::parsing::parse(this->ref().c_str());
 				return (result.type == json::jtype::jbool && result.value == "true");
 			}
@@ -783,6 +1527,8 @@ namespace json
 			/*! \brief Returns true if the value is a null value */
 			inline bool is_null() const
 			{
+				JSON_STATS_SCOPE(ACCESS);
+				JSON_STATS_COUNT(REPARSES, 1);
 				return json::parsing::parse(this->ref().c_str()).type == json::jtype::jnull;
 			}
 		};
@@ -809,10 +1555,20 @@ namespace json
 			 *
 			 * @param value The entry value to copy
 			 */
-			inline const_value(std::string value)
+			inline const_value(const std::string &value)
 			: data(value)
 			{ }
 
+			#if JSON_HAS_CXX11
+			/*! \brief Constructs a proxy by moving the provided value
+			 *
+			 * @param value The entry value to take ownership of
+			 */
+			inline const_value(std::string &&value)
+			: data(std::move(value))
+			{ }
+			#endif
+
 			/*! \brief Returns another constant value from this object
 			 *
 			 * This method assumed the entry contains a JSON object and returns another constant value from within
@@ -822,6 +1578,8 @@ namespace json
 			 */
 			inline const_value get(const std::string &key) const
 			{
+				JSON_STATS_SCOPE(ACCESS);
+				JSON_STATS_COUNT(REPARSES, 1);
 				return const_value(json::jobject::parse(this->data).get(key));
 			}
 
@@ -834,6 +1592,8 @@ namespace json
 			 */
 			inline const_value array(const size_t index) const
 			{
+				JSON_STATS_SCOPE(ACCESS);
+				JSON_STATS_COUNT(REPARSES, 1);
 				return const_value(json::jobject::parse(this->data).get(index));
 			}
 		};
@@ -855,8 +1615,9 @@ namespace json
 			/*! \brief Returns a reference to the value */
 			inline const std::string& ref() const 
 			{
-				for (size_t i = 0; i < this->source.size(); i++) if (this->source.data.at(i).first == key) return this->source.data.at(i).second;
-				throw json::invalid_key(key);
+				const size_t index = this->source.find_key(key);
+				if(index == this->source.size()) throw json::invalid_key(key);
+				return this->source.data[index].second;
 			}
 
 		public:
@@ -865,7 +1626,7 @@ namespace json
 			 * @param source The JSON object the value is being sourced from
 			 * @param key The key for the value being referenced
 			 */
-			const_proxy(const jobject &source, const std::string key) : source(source), key(key) 
+			const_proxy(const jobject &source, const std::string &key) : source(source), key(key) 
 			{ 
 				if(source.array_flag) throw std::logic_error("Source cannot be an array");
 			}
@@ -879,6 +1640,7 @@ namespace json
 			 */
 			const_value array(size_t index) const
 			{
+				JSON_STATS_SCOPE(ACCESS);
 				const char *value = this->ref().c_str();
 				if(json::jtype::peek(*value) != json::jtype::jarray)
 					throw std::invalid_argument("Input is not an array");
@@ -939,15 +1701,17 @@ namespace json
 			 * @param source The JSON object that will be updated when a value is assigned
 			 * @param key The key for the value to be updated
 			 */
-			proxy(jobject &source, const std::string key) 
+			proxy(jobject &source, const std::string &key) 
 				: json::jobject::const_proxy(source, key),
 				sink(source)
 			{ }
 
 			/*! \brief Assigns a string value */
-			inline void operator= (const std::string value)
+			inline void operator= (const std::string &value)
 			{
-				this->sink.set(this->key, json::parsing::encode_string(value.c_str()));
+				std::string encoded;
+				json::parsing::encode_string(value.data(), value.length(), encoded);
+				this->sink.set(this->key, JSON_MOVE(encoded));
 			}
 
 			/*! \brief Assigns a string value */
@@ -978,42 +1742,43 @@ namespace json
 			void operator=(const float input) { this->set_number(input, "%e"); }
 
 			/*! \brief Assigns a JSON object or array */
-			void operator=(json::jobject input)
+			void operator=(const json::jobject &input)
 			{
-				this->sink.set(key, (std::string)input);
+				this->sink.set(key, input.as_string());
 			}
 
 			/*! \brief Assigns an array of integers */
-			void operator=(const std::vector<int> input) { this->set_number_array(input, "%i"); }
+			void operator=(const std::vector<int> &input) { this->set_number_array(input, "%i"); }
 
 			/*! \brief Assigns an array of unsigned integers */
-			void operator=(const std::vector<unsigned int> input) { this->set_number_array(input, "%u"); }
+			void operator=(const std::vector<unsigned int> &input) { this->set_number_array(input, "%u"); }
 
 			/*! \brief Assigns an array of long integers */
-			void operator=(const std::vector<long> input) { this->set_number_array(input, "%li"); }
+			void operator=(const std::vector<long> &input) { this->set_number_array(input, "%li"); }
 
 			/*! \brief Assigns an array of unsigned long integers */
-			void operator=(const std::vector<unsigned long> input) { this->set_number_array(input, "%lu"); }
+			void operator=(const std::vector<unsigned long> &input) { this->set_number_array(input, "%lu"); }
 
 			/*! \brief Assigns an array of characters */
-			void operator=(const std::vector<char> input) { this->set_number_array(input, "%c"); }
+			void operator=(const std::vector<char> &input) { this->set_number_array(input, "%c"); }
 
 			/*! \brief Assigns an array of floating-point numbers */
-			void operator=(const std::vector<float> input) { this->set_number_array(input, "%e"); }
+			void operator=(const std::vector<float> &input) { this->set_number_array(input, "%e"); }
 
 			/*! \brief Assigns an array of double floating-point numbers */
-			void operator=(const std::vector<double> input) { this->set_number_array(input, "%e"); }
+			void operator=(const std::vector<double> &input) { this->set_number_array(input, "%e"); }
 
 			/*! \brief Assigns an array of strings */
-			void operator=(const std::vector<std::string> input) { this->set_array(input, true); }
+			void operator=(const std::vector<std::string> &input) { this->set_array(input, true); }
 
 			/*! \brief Assigns an array of JSON objects */
-			void operator=(const std::vector<json::jobject> input)
+			void operator=(const std::vector<json::jobject> &input)
 			{
 				std::vector<std::string> objs;
+				objs.reserve(input.size());
 				for (size_t i = 0; i < input.size(); i++)
 				{
-					objs.push_back((std::string)input[i]);
+					objs.push_back(input[i].as_string());
 				}
 				this->set_array(objs, false);
 			}
@@ -1047,8 +1812,9 @@ namespace json
 		 * @return A proxy for the value paired with the key
 		 * \exception json::invalid_key Exception thrown if the object is actually a JSON array
 		 */
-		inline virtual jobject::proxy operator[](const std::string key)
+		inline virtual jobject::proxy operator[](const std::string &key)
 		{
+			JSON_STATS_SCOPE(ACCESS);
 			if(this->array_flag) throw json::invalid_key(key);
 			return jobject::proxy(*this, key);
 		}
@@ -1059,8 +1825,9 @@ namespace json
 		 * @return A proxy for the value paired with the key
 		 * \exception json::invalid_key Exception thrown if the object is actually a JSON array
 		 */
-		inline virtual const jobject::const_proxy operator[](const std::string key) const
+		inline virtual const jobject::const_proxy operator[](const std::string &key) const
 		{
+			JSON_STATS_SCOPE(ACCESS);
 			if(this->array_flag) throw json::invalid_key(key);
 			return jobject::const_proxy(*this, key);
 		}
@@ -1074,9 +1841,21 @@ namespace json
 		 */
 		inline const jobject::const_value array(const size_t index) const
 		{
+			JSON_STATS_SCOPE(ACCESS);
 			return jobject::const_value(this->data.at(index).second);
 		}
 
+		/*! \brief Returns the value a JSON Pointer (RFC 6901) refers to
+		 *
+		 * \details Only the entry named by the first reference token is looked up in the object. The rest of the path is resolved by walking that entry's serialized value, skipping unrelated members and elements, so no intermediate objects are built.
+		 * @param pointer The JSON Pointer, such as `/a/b/3/c`
+		 * @return A copy of the value
+		 * \exception json::invalid_key Thrown if the pointer does not refer to a value
+		 * \exception std::invalid_argument Thrown if the pointer is malformed
+		 * @see json::parsing::at_pointer
+		 */
+		const_value at_pointer(const std::string &pointer) const;
+
 		/*! \see json::jobject::as_string() */
 		operator std::string() const;
 
@@ -1094,7 +1873,2106 @@ namespace json
 		 * @return A "pretty" version of the serizlied object or array
 		 */
 		std::string pretty(unsigned int indent_level = 0) const;
+
+		/*! \brief Serializes the object or array as CBOR (RFC 8949)
+		 *
+		 * \details Integers that fit in 64 bits are encoded as integers. Other numbers are encoded as single-precision floating-point values when that is exact, and as double-precision values otherwise, so numbers with more precision than a double, such as larger integers, lose precision.
+		 * @return The encoded bytes
+		 * \exception json::parsing_error Thrown if a number is too large for a double-precision value, or if arrays and objects are nested more than 1024 levels deep
+		 */
+		std::string as_cbor() const;
+
+		/*! \brief Serializes the object or array as MessagePack
+		 *
+		 * \details Integers that fit in 64 bits are encoded as integers. Other numbers are encoded as single-precision floating-point values when that is exact, and as double-precision values otherwise, so numbers with more precision than a double, such as larger integers, lose precision.
+		 * @return The encoded bytes
+		 * \exception json::parsing_error Thrown if a number is too large for a double-precision value, or if arrays and objects are nested more than 1024 levels deep
+		 */
+		std::string as_msgpack() const;
+
+		/*! \brief Parses a CBOR (RFC 8949) map or array
+		 *
+		 * @param input The encoded bytes
+		 * @param length The number of bytes
+		 * @return JSON object or array
+		 * \exception json::parsing_error Thrown when the input is malformed or contains values that cannot be represented in JSON, such as byte strings, non-string map keys and non-finite numbers, or nests maps and arrays more than 1024 levels deep
+		 * \note Tags are ignored and the tagged value is used as-is
+		 */
+		static jobject parse_cbor(const char *input, const size_t length);
+
+		/*! @see json::jobject::parse_cbor(const char*, const size_t) */
+		static inline jobject parse_cbor(const std::string &input) { return parse_cbor(input.data(), input.size()); }
+
+		/*! \brief Parses a MessagePack map or array
+		 *
+		 * @param input The encoded bytes
+		 * @param length The number of bytes
+		 * @return JSON object or array
+		 * \exception json::parsing_error Thrown when the input is malformed or contains values that cannot be represented in JSON, such as binary data, extension types, non-string map keys and non-finite numbers, or nests maps and arrays more than 1024 levels deep
+		 */
+		static jobject parse_msgpack(const char *input, const size_t length);
+
+		/*! @see json::jobject::parse_msgpack(const char*, const size_t) */
+		static inline jobject parse_msgpack(const std::string &input) { return parse_msgpack(input.data(), input.size()); }
 	};
-}
+
+	/*! \brief Computes a JSON Patch (RFC 6902) that transforms one object into another
+	 *
+	 * @see json::jobject::diff
+	 */
+	inline jobject diff(const jobject &from, const jobject &to)
+	{
+		return from.diff(to);
+	}
+
+	/*! \class packed_object
+	 * \brief A read-mostly JSON object or array stored in a single contiguous buffer
+	 *
+	 * \details Keys and serialized values are stored back to back in one buffer, with a compact table of offsets. Iteration, serialization and lookups read memory sequentially instead of visiting a separate allocation for every key and value. Convert to a json::jobject when entries need to be modified or removed.
+	 */
+	class packed_object
+	{
+	private:
+		/*! \brief Location of an entry in the buffer */
+		struct slot
+		{
+			/*! \brief Offset of the decoded key */
+			uint32_t key_offset;
+
+			/*! \brief Length of the decoded key */
+			uint32_t key_length;
+
+			/*! \brief Offset of the serialized value */
+			uint32_t value_offset;
+
+			/*! \brief Length of the serialized value */
+			uint32_t value_length;
+		};
+
+		/*! \brief The keys and values of all entries */
+		std::string buffer;
+
+		/*! \brief The location of each entry in the buffer */
+		std::vector<slot> slots;
+
+		/*! \brief Flag for arrays */
+		bool array_flag;
+
+		/*! \brief Open-addressing table of entry indices plus one, keyed by the hash of the key, built once the object is large enough to benefit
+		 *
+		 * \details Entries appended since the last lookup are recorded by the next lookup
+		 */
+		mutable std::vector<uint32_t> key_index;
+
+		/*! \brief The number of leading entries recorded in #key_index */
+		mutable size_t indexed_entries;
+
+		/*! \brief Appends characters to the buffer
+		 *
+		 * @return The offset of the characters
+		 * \exception std::length_error Thrown if the buffer would exceed the range of the offset table
+		 */
+		uint32_t store(const char *input, const size_t length);
+
+		/*! \brief Appends an entry without checking the key */
+		void append(const std::string &key, const std::string &value);
+
+		/*! \brief Determines if the key of an entry matches
+		 *
+		 * @param index The index of the entry
+		 * @param key The key to compare with
+		 * @param length The length of the key
+		 */
+		bool key_equals(const size_t index, const char *key, const size_t length) const;
+
+		/*! \brief Finds the entry for a key
+		 *
+		 * \details Small objects are searched linearly. Larger objects use #key_index.
+		 * @return The index of the entry, or the size of the object if the key is not present
+		 */
+		size_t find(const char *key, const size_t length) const;
+
+	public:
+		/*! \brief Constructor
+		 *
+		 * @param array If true, the instance is initialized as an array. If false, the instance is initalized as an object.
+		 */
+		packed_object(const bool array = false) : array_flag(array), indexed_entries(0) { }
+
+		/*! \brief Packs the entries of a JSON object or array
+		 *
+		 * @param source The object or array to pack
+		 */
+		explicit packed_object(const json::jobject &source);
+
+		/*! \brief Parses a serialized JSON object or array
+		 *
+		 * @see json::jobject::parse(const char*, const bool)
+		 */
+		static packed_object parse(const char *input, const bool validate_utf8 = false);
+
+		/*! @see json::packed_object::parse(const char*, const bool) */
+		static inline packed_object parse(const std::string &input, const bool validate_utf8 = false)
+		{
+			return parse(input.c_str(), validate_utf8);
+		}
+
+		/*! \brief Reserves storage
+		 *
+		 * @param entries The expected number of entries
+		 * @param bytes The expected total length of the keys and serialized values
+		 */
+		inline void reserve(const size_t entries, const size_t bytes)
+		{
+			this->slots.reserve(entries);
+			this->buffer.reserve(bytes);
+		}
+
+		/*! \brief Returns the number of entries */
+		inline size_t size() const
+		{
+			return this->slots.size();
+		}
+
+		/*! \brief Returns true if the instance represents a JSON array */
+		inline bool is_array() const
+		{
+			return this->array_flag;
+		}
+
+		/*! \brief Returns the number of bytes used to store keys and values */
+		inline size_t bytes() const
+		{
+			return this->buffer.size();
+		}
+
+		/*! \brief Removes all entries */
+		inline void clear()
+		{
+			this->buffer.clear();
+			this->slots.clear();
+			this->key_index.clear();
+			this->indexed_entries = 0;
+		}
+
+		/*! \brief Appends a key-value pair
+		 *
+		 * \exception json::parsing_error Thrown if the key conflicts with an existing key or is incompatible with the object (object/array mismatch)
+		 */
+		packed_object& operator+=(const json::kvp &other);
+
+		/*! \brief Determines if a key is present
+		 *
+		 * @param key The key to search for
+		 */
+		inline bool has_key(const std::string &key) const
+		{
+			return !this->array_flag && this->find(key.data(), key.length()) < this->size();
+		}
+
+		/*! \brief Returns the key of an entry
+		 *
+		 * @param index The index of the entry
+		 */
+		inline std::string key(const size_t index) const
+		{
+			const slot &target = this->slots.at(index);
+			return this->buffer.substr(target.key_offset, target.key_length);
+		}
+
+		/*! \brief Returns a list of the object's keys
+		 *
+		 * @return A list of keys contained in the object. If the object is actually an array, an empty list will be returned
+		 */
+		key_list_t list_keys() const;
+
+		/*! \brief Returns the serialized value at a given index
+		 *
+		 * @param index The index of the desired element
+		 */
+		inline std::string get(const size_t index) const
+		{
+			const slot &target = this->slots.at(index);
+			return this->buffer.substr(target.value_offset, target.value_length);
+		}
+
+		/*! \brief Returns the serialized value associated with a key
+		 *
+		 * @param key The key for the desired element
+		 * \exception json::invalid_key Exception thrown if the key does not exist in the object or the object actually represents a JSON array
+		 */
+		std::string get(const std::string &key) const;
+
+		/*! \brief Returns an element of the JSON object
+		 *
+		 * @param key The key of the element to be returned
+		 * @return A copy of the value paired with the key
+		 * \exception json::invalid_key Exception thrown if the key does not exist in the object or the object actually represents a JSON array
+		 */
+		inline json::jobject::const_value operator[](const std::string &key) const
+		{
+			return json::jobject::const_value(this->get(key));
+		}
+
+		/*! \brief Returns the value of an element in an array
+		 *
+		 * @param index The index of the element to be returned
+		 * @return A copy of the value
+		 */
+		inline json::jobject::const_value array(const size_t index) const
+		{
+			return json::jobject::const_value(this->get(index));
+		}
+
+		/*! \brief Unpacks the entries into a JSON object or array */
+		json::jobject as_object() const;
+
+		/*! @see json::packed_object::as_object() */
+		inline operator json::jobject() const
+		{
+			return this->as_object();
+		}
+
+		/*! \brief Serializes the object or array in the same form as json::jobject::as_string() */
+		std::string as_string() const;
+
+		/*! @see json::packed_object::as_string() */
+		inline operator std::string() const
+		{
+			return this->as_string();
+		}
+	};
+
+	/*! \class arena
+	 * \brief A monotonic memory pool used to allocate whole documents
+	 *
+	 * Memory is handed out sequentially from large chunks and is only reclaimed all at once, either by reset() or by destroying the arena. An optional buffer supplied by the caller is used before any chunks are allocated from the heap.
+	 */
+	class arena
+	{
+	private:
+		/*! \brief Header of a chunk allocated from the heap */
+		struct chunk
+		{
+			/*! \brief The previously allocated chunk */
+			chunk *next;
+
+			/*! \brief The number of usable bytes following the header */
+			size_t size;
+		};
+
+		/*! \brief The chunks allocated from the heap, most recent first */
+		chunk *chunks;
+
+		/*! \brief Buffer supplied by the caller */
+		char *buffer;
+
+		/*! \brief Size of the buffer supplied by the caller */
+		size_t buffer_size;
+
+		/*! \brief The next free byte */
+		char *cursor;
+
+		/*! \brief The number of free bytes following the cursor */
+		size_t remaining;
+
+		/*! \brief The size of the chunks allocated from the heap */
+		size_t chunk_size;
+
+		/*! \brief The number of bytes handed out since the last reset */
+		size_t allocated;
+
+		/*! \brief Copying is not supported */
+		arena(const arena &other);
+
+		/*! \brief Copying is not supported */
+		arena& operator=(const arena &other);
+
+		/*! \brief Points the cursor at the start of the buffer supplied by the caller */
+		void rewind();
+
+	public:
+		/*! \brief Constructor
+		 *
+		 * @param chunk_size The size of the chunks allocated from the heap
+		 */
+		arena(const size_t chunk_size = 4096);
+
+		/*! \brief Constructs an arena that allocates from the provided buffer first
+		 *
+		 * @param buffer Storage to allocate from, which must outlive the arena
+		 * @param size The size of the buffer
+		 * @param chunk_size The size of the chunks allocated from the heap once the buffer is exhausted
+		 */
+		arena(void *buffer, const size_t size, const size_t chunk_size = 4096);
+
+		/*! \brief Destructor */
+		~arena();
+
+		/*! \brief Allocates memory suitably aligned for any integer, pointer or floating-point type
+		 *
+		 * @param size The number of bytes to allocate
+		 * @return Pointer to the allocated memory
+		 */
+		void* allocate(const size_t size);
+
+		/*! \brief Copies characters into the arena and appends a null terminator
+		 *
+		 * @param input The characters to copy
+		 * @param length The number of characters to copy
+		 * @return Pointer to the copy
+		 */
+		char* copy(const char *input, const size_t length);
+
+		/*! \brief Releases all memory allocated from the arena
+		 *
+		 * \note Chunks allocated from the heap are freed, while the buffer supplied by the caller is reused
+		 */
+		void reset();
+
+		/*! \brief Returns the number of bytes allocated since the last reset */
+		inline size_t used() const
+		{
+			return this->allocated;
+		}
+
+		/*! \brief Returns the number of bytes reserved by the arena, including the buffer supplied by the caller */
+		size_t capacity() const;
+	};
+
+	/*! \class key_pool
+	 * \brief A table of interned object keys
+	 *
+	 * \details Each distinct key is stored once, and interning the same characters again returns the same pointer, so interned keys can be compared by address. Documents that share a pool store each key only once, no matter how many objects use it. Interned keys remain valid until the pool is cleared or destroyed.
+	 * \warning A pool is not thread-safe. Access from multiple threads, including to the global pool, must be synchronized by the caller.
+	 */
+	class key_pool
+	{
+	public:
+		/*! \brief A handle to an interned key */
+		class key
+		{
+		private:
+			/*! \brief The pool holding the key */
+			const key_pool *owner;
+
+			/*! \brief The interned characters */
+			const char *text;
+
+			/*! \brief The number of characters */
+			size_t size;
+
+			/*! \brief Constructor
+			 *
+			 * @param owner The pool holding the key
+			 * @param text The interned characters
+			 * @param size The number of characters
+			 */
+			key(const key_pool *owner, const char *text, const size_t size) : owner(owner), text(text), size(size) { }
+
+			friend class key_pool;
+
+		public:
+			/*! \brief Constructs a handle that does not refer to a key */
+			key() : owner(NULL), text(NULL), size(0) { }
+
+			/*! \brief Returns true if the handle refers to an interned key */
+			inline bool exists() const
+			{
+				return this->text != NULL;
+			}
+
+			/*! \brief Returns the pool holding the key */
+			inline const key_pool* pool() const
+			{
+				return this->owner;
+			}
+
+			/*! \brief Returns the null-terminated characters of the key */
+			inline const char* c_str() const
+			{
+				return this->text;
+			}
+
+			/*! \brief Returns the number of characters in the key */
+			inline size_t length() const
+			{
+				return this->size;
+			}
+
+			/*! \brief Compares two interned keys by address */
+			inline bool operator==(const key &other) const
+			{
+				return this->text == other.text;
+			}
+
+			/*! \brief Compares two interned keys by address */
+			inline bool operator!=(const key &other) const
+			{
+				return this->text != other.text;
+			}
+		};
+
+		/*! \brief Constructor
+		 *
+		 * @param chunk_size The size of the chunks used to store the keys
+		 */
+		key_pool(const size_t chunk_size = 4096);
+
+		/*! \brief Interns a key
+		 *
+		 * @param input The characters of the key
+		 * @param length The number of characters
+		 * @return The interned key
+		 */
+		key intern(const char *input, const size_t length);
+
+		/*! @see json::key_pool::intern(const char*, const size_t) */
+		inline key intern(const std::string &input)
+		{
+			return this->intern(input.data(), input.length());
+		}
+
+		/*! \brief Finds a key without interning it
+		 *
+		 * @param input The characters of the key
+		 * @param length The number of characters
+		 * @return The interned key, which does not exist if the key has not been interned
+		 */
+		key find(const char *input, const size_t length) const;
+
+		/*! @see json::key_pool::find(const char*, const size_t) const */
+		inline key find(const std::string &input) const
+		{
+			return this->find(input.data(), input.length());
+		}
+
+		/*! \brief Returns the number of interned keys */
+		inline size_t size() const
+		{
+			return this->count;
+		}
+
+		/*! \brief Removes all keys from the pool
+		 *
+		 * \warning Previously interned keys, and any documents that use them, are invalidated
+		 */
+		void clear();
+
+		/*! \brief Returns the process-wide pool */
+		static key_pool& global();
+
+	private:
+		/*! \brief An entry in the hash table */
+		struct slot
+		{
+			/*! \brief The interned characters, or `NULL` for an empty slot */
+			const char *text;
+
+			/*! \brief The number of characters */
+			size_t length;
+
+			/*! \brief The hash of the characters */
+			uint64_t hash;
+		};
+
+		/*! \brief Storage for the interned characters */
+		json::arena memory;
+
+		/*! \brief Open-addressed hash table with a power-of-two size */
+		std::vector<slot> table;
+
+		/*! \brief The number of interned keys */
+		size_t count;
+
+		/*! \brief Finds the slot for a key
+		 *
+		 * @return The slot holding the key, or the empty slot where it would be inserted
+		 */
+		size_t find_slot(const char *input, const size_t length, const uint64_t hash) const;
+
+		/*! \brief Doubles the size of the hash table */
+		void grow();
+
+		/*! \brief Copying is not supported */
+		key_pool(const key_pool &other);
+
+		/*! \brief Copying is not supported */
+		key_pool& operator=(const key_pool &other);
+	};
+
+	/*! \class document
+	 * \brief A read-only parsed JSON value whose memory is allocated from an arena
+	 *
+	 * \details Parsing copies the input into the arena and builds a tree of values that refer to the copy. Nothing in the tree has its own destructor, so discarding a document is a single arena reset regardless of its size. Use json::jobject when the parsed value needs to be modified.
+	 */
+	class document
+	{
+	private:
+		/*! \brief A value in the document */
+		struct node
+		{
+			/*! \brief The type of the value */
+			jtype::jtype type;
+
+			/*! \brief The decoded key of an object member, or `NULL` for other values */
+			const char *key;
+
+			/*! \brief The length of the key */
+			size_t key_length;
+
+			/*! \brief The decoded characters of a string, or the serialized text of any other value */
+			const char *text;
+
+			/*! \brief The length of the text */
+			size_t length;
+
+			/*! \brief The number of members or elements of an object or array */
+			size_t size;
+
+			/*! \brief The first member or element of an object or array */
+			node *first_child;
+
+			/*! \brief The next member or element of the parent */
+			node *next_sibling;
+		};
+
+		/*! \brief The arena holding the document */
+		json::arena *memory;
+
+		/*! \brief True if the arena was created by and belongs to the document */
+		const bool owns_memory;
+
+		/*! \brief The pool used to intern keys, or `NULL` if keys are not interned */
+		json::key_pool *keys;
+
+		/*! \brief The root value, or `NULL` if nothing has been parsed */
+		node *root_node;
+
+		/*! \brief Copying is not supported */
+		document(const document &other);
+
+		/*! \brief Copying is not supported */
+		document& operator=(const document &other);
+
+		/*! \brief Parses a value into a new node
+		 *
+		 * @param[in,out] index Pointer to the value, advanced past the value
+		 * @return The node holding the value
+		 * \exception json::parsing_error Thrown if the value is not valid JSON
+		 */
+		node* parse_value(const char *&index);
+
+		/*! \brief Decodes a string into the arena
+		 *
+		 * @param[in,out] index Pointer to the opening quotation, advanced past the closing quotation
+		 * @param[out] length The length of the decoded string
+		 * @return The decoded, null-terminated string
+		 * \exception json::parsing_error Thrown if the string is not valid JSON
+		 */
+		const char* parse_string(const char *&index, size_t &length);
+
+		/*! \brief Decodes a key, interning it when the document uses a key pool
+		 *
+		 * @param[in,out] index Pointer to the opening quotation, advanced past the closing quotation
+		 * @param[out] length The length of the decoded key
+		 * @return The decoded, null-terminated key
+		 * \exception json::parsing_error Thrown if the key is not valid JSON
+		 */
+		const char* parse_key(const char *&index, size_t &length);
+
+	public:
+		/*! \brief A read-only view of a value in a document
+		 *
+		 * \details Views are only valid as long as the document is neither cleared nor parsed again. A view that does not refer to a value is returned when iterating past the last member or element.
+		 */
+		class value
+		{
+		private:
+			/*! \brief The referenced value */
+			const node *target;
+
+			/*! \brief The pool holding the keys of the document, or `NULL` if keys are not interned */
+			const json::key_pool *keys;
+
+			/*! \brief Constructor
+			 *
+			 * @param target The referenced value
+			 * @param keys The pool holding the keys of the document
+			 */
+			value(const node *target, const json::key_pool *keys) : target(target), keys(keys) { }
+
+			/*! \brief Returns the referenced value
+			 *
+			 * \exception std::logic_error Thrown if the view does not refer to a value
+			 */
+			const node& get_node() const;
+
+			/*! \brief Finds the member of an object
+			 *
+			 * @param key The key of the member
+			 * @param length The length of the key
+			 * @return The member, or `NULL` if the key is not present
+			 */
+			const node* find(const char *key, const size_t length) const;
+
+			/*! \brief Finds the member of an object by interned key
+			 *
+			 * @param key The interned key of the member
+			 * @return The member, or `NULL` if the key is not present
+			 */
+			const node* find(const json::key_pool::key &key) const;
+
+			/*! \brief Converts a numeric value */
+			template<typename T>
+			inline T get_number(const char *format) const
+			{
+				if(this->get_node().type != json::jtype::jnumber) throw std::invalid_argument("Value is not a number");
+				return json::parsing::get_number<T>(this->target->text, format);
+			}
+
+			friend class document;
+
+		public:
+			/*! \brief Constructs a view that does not refer to a value */
+			value() : target(NULL), keys(NULL) { }
+
+			/*! \brief Returns true if the view refers to a value */
+			inline bool exists() const
+			{
+				return this->target != NULL;
+			}
+
+			/*! \brief Returns the type of the value
+			 *
+			 * @return The type of the value, or json::jtype::not_valid if the view does not refer to a value
+			 */
+			inline json::jtype::jtype type() const
+			{
+				return this->target == NULL ? json::jtype::not_valid : this->target->type;
+			}
+
+			/*! \brief Returns true if the value is a string */
+			inline bool is_string() const { return this->type() == json::jtype::jstring; }
+
+			/*! \brief Returns true if the value is a number */
+			inline bool is_number() const { return this->type() == json::jtype::jnumber; }
+
+			/*! \brief Returns true if the value is an object */
+			inline bool is_object() const { return this->type() == json::jtype::jobject; }
+
+			/*! \brief Returns true if the value is an array */
+			inline bool is_array() const { return this->type() == json::jtype::jarray; }
+
+			/*! \brief Returns true if the value is a bool */
+			inline bool is_bool() const { return this->type() == json::jtype::jbool; }
+
+			/*! \brief Returns true if the value is a boolean and set to true */
+			inline bool is_true() const { return this->is_bool() && *this->target->text == 't'; }
+
+			/*! \brief Returns true if the value is a null value */
+			inline bool is_null() const { return this->type() == json::jtype::jnull; }
+
+			/*! \brief Returns the number of members or elements of an object or array */
+			inline size_t size() const
+			{
+				return this->get_node().size;
+			}
+
+			/*! \brief Returns the decoded key of an object member, or `NULL` for other values */
+			inline const char* key() const
+			{
+				return this->get_node().key;
+			}
+
+			/*! \brief Returns the length of the key of an object member */
+			inline size_t key_length() const
+			{
+				return this->get_node().key_length;
+			}
+
+			/*! \brief Returns the decoded characters of a string, or the serialized text of any other value
+			 *
+			 * \note Only strings are null-terminated. Use length() for other values.
+			 */
+			inline const char* data() const
+			{
+				return this->get_node().text;
+			}
+
+			/*! \brief Returns the number of characters returned by data() */
+			inline size_t length() const
+			{
+				return this->get_node().length;
+			}
+
+			/*! \brief Returns a string representation of the value
+			 *
+			 * \note Objects and arrays are returned as they appeared in the parsed input
+			 */
+			inline std::string as_string() const
+			{
+				return std::string(this->data(), this->length());
+			}
+
+			/*! @see json::document::value::as_string() */
+			inline operator std::string() const
+			{
+				return this->as_string();
+			}
+
+			/*! \brief Copies the value into a JSON object
+			 *
+			 * \note This method also works for JSON arrays
+			 */
+			inline json::jobject as_object() const
+			{
+				return json::jobject::parse(this->as_string());
+			}
+
+			/*! \brief Casts the value as an integer */
+			operator int() const;
+
+			/*! \brief Casts the value as an unsigned integer */
+			operator unsigned int() const;
+
+			/*! \brief Casts the value as a long integer */
+			operator long() const;
+
+			/*! \brief Casts the value as an unsigned long integer */
+			operator unsigned long() const;
+
+			/*! \brief Casts the value as a floating point numer */
+			operator float() const;
+
+			/*! \brief Casts the value as a double-precision floating point number */
+			operator double() const;
+
+			/*! \brief Determines if a key is present in an object
+			 *
+			 * @param key The key to search for
+			 */
+			inline bool has_key(const std::string &key) const
+			{
+				return this->find(key.data(), key.length()) != NULL;
+			}
+
+			/*! \brief Returns a member of an object
+			 *
+			 * @param key The key of the member
+			 * @return A view of the member's value
+			 * \exception json::invalid_key Thrown if the key is not present
+			 */
+			value get(const std::string &key) const;
+
+			/*! @see json::document::value::get() */
+			inline value operator[](const std::string &key) const
+			{
+				return this->get(key);
+			}
+
+			/*! @see json::document::value::get() */
+			inline value operator[](const char *key) const
+			{
+				return this->get(key);
+			}
+
+			/*! \brief Determines if an interned key is present in an object
+			 *
+			 * \details When the key belongs to the pool used by the document, keys are compared by address
+			 * @param key The key to search for
+			 */
+			bool has_key(const json::key_pool::key &key) const;
+
+			/*! \brief Returns a member of an object by interned key
+			 *
+			 * \details When the key belongs to the pool used by the document, keys are compared by address
+			 * @param key The key of the member
+			 * @return A view of the member's value
+			 * \exception json::invalid_key Thrown if the key is not present
+			 */
+			value get(const json::key_pool::key &key) const;
+
+			/*! @see json::document::value::get(const json::key_pool::key&) const */
+			inline value operator[](const json::key_pool::key &key) const
+			{
+				return this->get(key);
+			}
+
+			/*! \brief Returns an element of an array
+			 *
+			 * @param index The index of the element
+			 * @return A view of the element
+			 * \exception std::out_of_range Thrown if the index is not valid
+			 * \note While this method is intended for JSON arrays, this method is also valid for JSON objects
+			 */
+			value array(const size_t index) const;
+
+			/*! \brief Returns the first member or element of an object or array
+			 *
+			 * @return A view of the first member or element, which does not refer to a value if the object or array is empty
+			 */
+			inline value first() const
+			{
+				return value(this->get_node().first_child, this->keys);
+			}
+
+			/*! \brief Returns the next member or element of the parent object or array
+			 *
+			 * @return A view of the next member or element, which does not refer to a value if this is the last one
+			 */
+			inline value next() const
+			{
+				return value(this->get_node().next_sibling, this->keys);
+			}
+		};
+
+		/*! \brief Constructs a document that allocates from its own arena
+		 *
+		 * @param chunk_size The size of the chunks allocated by the arena
+		 * @param keys The pool used to intern object keys, which must outlive the document, or `NULL` to store keys in the arena
+		 */
+		document(const size_t chunk_size = 4096, json::key_pool *keys = NULL);
+
+		/*! \brief Constructs a document that allocates from the provided arena
+		 *
+		 * @param memory The arena to allocate from, which must outlive the document
+		 * @param keys The pool used to intern object keys, which must outlive the document, or `NULL` to store keys in the arena
+		 * \note Memory is only reclaimed when the provided arena is reset
+		 */
+		document(json::arena &memory, json::key_pool *keys = NULL);
+
+		/*! \brief Destructor */
+		~document();
+
+		/*! \brief Parses a serialized JSON value, replacing any previously parsed value
+		 *
+		 * @param input The serialized value
+		 * @param validate_utf8 When true, the input must be valid UTF-8
+		 * \exception json::parsing_error Thrown if the input is not valid JSON
+		 * \exception json::invalid_utf8 Thrown if validation is enabled and the input is not valid UTF-8
+		 */
+		void parse(const char *input, const bool validate_utf8 = false);
+
+		/*! @see json::document::parse(const char*, const bool) */
+		inline void parse(const std::string &input, const bool validate_utf8 = false)
+		{
+			this->parse(input.c_str(), validate_utf8);
+		}
+
+		/*! \brief Returns the root value
+		 *
+		 * \exception std::logic_error Thrown if nothing has been parsed
+		 */
+		value root() const;
+
+		/*! \brief Discards the parsed value
+		 *
+		 * \note When the document owns its arena, the arena is reset
+		 */
+		void clear();
+
+		/*! \brief Returns the arena the document allocates from */
+		inline json::arena& get_arena() const
+		{
+			return *this->memory;
+		}
+	};
+
+	/*! \class snapshot
+	 * \brief A read-only view of a JSON value stored in a binary snapshot
+	 *
+	 * \details Snapshots are versioned, position-independent images of a parsed value. Every value is located through offsets relative to the start of the snapshot, arrays carry a table of element offsets, and objects carry a table of members together with an index sorted by key. Opening a snapshot only checks its header, so a snapshot can be mapped into memory, for instance with `mmap`, and read without parsing. All integers are stored in little-endian byte order and snapshots are limited to 4 GiB.
+	 */
+	class snapshot
+	{
+	private:
+		/*! \brief The snapshot */
+		const unsigned char *bytes;
+
+		/*! \brief The size of the snapshot */
+		size_t length;
+
+		/*! \brief Reads a 32-bit word
+		 *
+		 * @param offset The offset of the word
+		 * \exception json::parsing_error Thrown if the word is outside the snapshot
+		 */
+		uint32_t word(const size_t offset) const;
+
+		/*! \brief Locates the characters of a string or number
+		 *
+		 * @param offset The offset of the string or number
+		 * @param[out] size The number of characters
+		 * @return Pointer to the null-terminated characters
+		 * \exception json::parsing_error Thrown if the characters are outside the snapshot
+		 */
+		const char* text(const size_t offset, size_t &size) const;
+
+	public:
+		class value;
+		friend class value;
+
+		/*! \brief A read-only view of a value in a snapshot
+		 *
+		 * \details Views are only valid as long as the snapshot's memory is. A view that does not refer to a value is returned when iterating past the last member or element.
+		 */
+		class value
+		{
+		private:
+			/*! \brief The snapshot holding the value, or `NULL` if the view does not refer to a value */
+			const snapshot *source;
+
+			/*! \brief The offset of the value */
+			uint32_t offset;
+
+			/*! \brief The offset of the parent object or array, or zero for the root */
+			uint32_t parent;
+
+			/*! \brief The index of the value within its parent */
+			uint32_t index;
+
+			/*! \brief Constructor */
+			value(const snapshot *source, const uint32_t offset, const uint32_t parent, const uint32_t index)
+				: source(source), offset(offset), parent(parent), index(index)
+			{ }
+
+			/*! \brief Returns the snapshot holding the value
+			 *
+			 * \exception std::logic_error Thrown if the view does not refer to a value
+			 */
+			const snapshot& get_source() const;
+
+			/*! \brief Returns the view of a member or element
+			 *
+			 * @param position The position of the member or element
+			 */
+			value child(const uint32_t position) const;
+
+			/*! \brief Finds the member of an object
+			 *
+			 * @return The position of the member, or the size of the object if the key is not present
+			 */
+			uint32_t find(const char *key, const size_t length) const;
+
+			/*! \brief Appends the serialized value to a string */
+			void serialize(std::string &output) const;
+
+			/*! \brief Converts a numeric value */
+			template<typename T>
+			inline T get_number(const char *format) const
+			{
+				if(this->type() != json::jtype::jnumber) throw std::invalid_argument("Value is not a number");
+				return json::parsing::get_number<T>(this->data(), format);
+			}
+
+			friend class snapshot;
+
+		public:
+			/*! \brief Constructs a view that does not refer to a value */
+			value() : source(NULL), offset(0), parent(0), index(0) { }
+
+			/*! \brief Returns true if the view refers to a value */
+			inline bool exists() const
+			{
+				return this->source != NULL;
+			}
+
+			/*! \brief Returns the type of the value
+			 *
+			 * @return The type of the value, or json::jtype::not_valid if the view does not refer to a value
+			 */
+			json::jtype::jtype type() const;
+
+			/*! \brief Returns true if the value is a string */
+			inline bool is_string() const { return this->type() == json::jtype::jstring; }
+
+			/*! \brief Returns true if the value is a number */
+			inline bool is_number() const { return this->type() == json::jtype::jnumber; }
+
+			/*! \brief Returns true if the value is an object */
+			inline bool is_object() const { return this->type() == json::jtype::jobject; }
+
+			/*! \brief Returns true if the value is an array */
+			inline bool is_array() const { return this->type() == json::jtype::jarray; }
+
+			/*! \brief Returns true if the value is a bool */
+			inline bool is_bool() const { return this->type() == json::jtype::jbool; }
+
+			/*! \brief Returns true if the value is a boolean and set to true */
+			bool is_true() const;
+
+			/*! \brief Returns true if the value is a null value */
+			inline bool is_null() const { return this->type() == json::jtype::jnull; }
+
+			/*! \brief Returns the number of members or elements of an object or array */
+			size_t size() const;
+
+			/*! \brief Returns the key of an object member, or `NULL` for other values */
+			const char* key() const;
+
+			/*! \brief Returns the null-terminated, decoded characters of a string or the serialized text of a number
+			 *
+			 * \exception std::invalid_argument Thrown for other types of values
+			 */
+			const char* data() const;
+
+			/*! \brief Returns the number of characters returned by data() */
+			size_t length() const;
+
+			/*! \brief Returns a string representation of the value
+			 *
+			 * \note Objects and arrays are serialized in the same form as json::jobject::as_string()
+			 */
+			std::string as_string() const;
+
+			/*! @see json::snapshot::value::as_string() */
+			inline operator std::string() const
+			{
+				return this->as_string();
+			}
+
+			/*! \brief Copies the value into a JSON object
+			 *
+			 * \note This method also works for JSON arrays
+			 */
+			inline json::jobject as_object() const
+			{
+				return json::jobject::parse(this->as_string());
+			}
+
+			/*! \brief Casts the value as an integer */
+			operator int() const;
+
+			/*! \brief Casts the value as an unsigned integer */
+			operator unsigned int() const;
+
+			/*! \brief Casts the value as a long integer */
+			operator long() const;
+
+			/*! \brief Casts the value as an unsigned long integer */
+			operator unsigned long() const;
+
+			/*! \brief Casts the value as a floating point numer */
+			operator float() const;
+
+			/*! \brief Casts the value as a double-precision floating point number */
+			operator double() const;
+
+			/*! \brief Determines if a key is present in an object
+			 *
+			 * \details Keys are found by binary search
+			 * @param key The key to search for
+			 */
+			inline bool has_key(const std::string &key) const
+			{
+				return this->is_object() && this->find(key.data(), key.length()) < this->size();
+			}
+
+			/*! \brief Returns a member of an object
+			 *
+			 * \details Keys are found by binary search
+			 * @param key The key of the member
+			 * @return A view of the member's value
+			 * \exception json::invalid_key Thrown if the key is not present
+			 */
+			value get(const std::string &key) const;
+
+			/*! @see json::snapshot::value::get() */
+			inline value operator[](const std::string &key) const
+			{
+				return this->get(key);
+			}
+
+			/*! @see json::snapshot::value::get() */
+			inline value operator[](const char *key) const
+			{
+				return this->get(key);
+			}
+
+			/*! \brief Returns an element of an array
+			 *
+			 * @param index The index of the element
+			 * @return A view of the element
+			 * \exception std::out_of_range Thrown if the index is not valid
+			 * \note While this method is intended for JSON arrays, this method is also valid for JSON objects
+			 */
+			value array(const size_t index) const;
+
+			/*! \brief Returns the first member or element of an object or array
+			 *
+			 * @return A view of the first member or element, which does not refer to a value if the object or array is empty
+			 */
+			value first() const;
+
+			/*! \brief Returns the next member or element of the parent object or array
+			 *
+			 * @return A view of the next member or element, which does not refer to a value if this is the last one
+			 */
+			value next() const;
+		};
+
+		/*! \brief Opens a snapshot
+		 *
+		 * \details Only the header is checked. Offsets are checked against the size of the snapshot as values are read, and every child must follow its container, so a corrupt snapshot cannot contain cycles.
+		 * @param data The snapshot, which must remain valid while the snapshot and its views are in use
+		 * @param length The size of the snapshot
+		 * \exception json::parsing_error Thrown if the header is not valid or the version is not supported
+		 */
+		snapshot(const void *data, const size_t length);
+
+		/*! \brief Creates a snapshot of a serialized JSON value
+		 *
+		 * @param input The serialized value
+		 * @return The snapshot, which can be written to a file and later opened in place
+		 * \exception json::parsing_error Thrown if the input is not valid JSON
+		 * \exception std::length_error Thrown if the snapshot would exceed 4 GiB
+		 */
+		static std::string create(const char *input);
+
+		/*! @see json::snapshot::create(const char*) */
+		static inline std::string create(const std::string &input)
+		{
+			return create(input.c_str());
+		}
+
+		/*! @see json::snapshot::create(const char*) */
+		static inline std::string create(const json::jobject &input)
+		{
+			return create(input.as_string());
+		}
+
+		/*! \brief Returns the root value */
+		value root() const;
+	};
+
+	/*! \class lazy_value
+	 * \brief An on-demand view of a value within serialized JSON
+	 *
+	 * \details A lazy value is a pointer into the caller's buffer. Looking up a member or element scans forward from the start of the enclosing object or array and skips unrelated values by bracket matching, without validating, decoding or copying them. Only the value that is finally read is converted. Because nothing is validated ahead of time, malformed input is only detected, if at all, on the path that is actually scanned. The buffer must outlive every view into it.
+	 */
+	class lazy_value
+	{
+	private:
+		/*! \brief The start of the value, or `NULL` if the view does not refer to a value */
+		const char *input;
+
+		/*! \brief The opening quotation of the key if the value is an object member, otherwise `NULL` */
+		const char *name;
+
+		/*! \brief Constructor
+		 *
+		 * @param input The start of the value
+		 * @param name The opening quotation of the key of an object member
+		 */
+		lazy_value(const char *input, const char *name) : input(input), name(name) { }
+
+		/*! \brief Returns the start of the value
+		 *
+		 * \exception std::logic_error Thrown if the view does not refer to a value
+		 */
+		const char* get_input() const;
+
+		/*! \brief Finds the member of an object
+		 *
+		 * @param key The key of the member
+		 * @param length The length of the key
+		 * @return The member, or a view that does not refer to a value if the key is not present
+		 * \exception std::invalid_argument Thrown if the value is not an object
+		 */
+		lazy_value find(const char *key, const size_t length) const;
+
+		/*! \brief Converts a numeric value */
+		template<typename T>
+		inline T get_number(const char *format) const
+		{
+			if(!this->is_number()) throw std::invalid_argument("Value is not a number");
+			return json::parsing::get_number<T>(this->input, format);
+		}
+
+		friend class projection;
+
+	public:
+		/*! \brief Constructs a view that does not refer to a value */
+		lazy_value() : input(NULL), name(NULL) { }
+
+		/*! \brief Constructs a view of a serialized value
+		 *
+		 * @param input The null-terminated serialized value, optionally preceded by white space
+		 */
+		explicit lazy_value(const char *input);
+
+		/*! \brief Returns true if the view refers to a value */
+		inline bool exists() const
+		{
+			return this->input != NULL;
+		}
+
+		/*! \brief Returns the type of the value
+		 *
+		 * \details The type is determined from the first character of the value
+		 * @return The type of the value, or json::jtype::not_valid if the view does not refer to a value
+		 */
+		inline json::jtype::jtype type() const
+		{
+			return this->input == NULL ? json::jtype::not_valid : json::jtype::peek(*this->input);
+		}
+
+		/*! \brief Returns true if the value is a string */
+		inline bool is_string() const { return this->type() == json::jtype::jstring; }
+
+		/*! \brief Returns true if the value is a number */
+		inline bool is_number() const { return this->type() == json::jtype::jnumber; }
+
+		/*! \brief Returns true if the value is an object */
+		inline bool is_object() const { return this->type() == json::jtype::jobject; }
+
+		/*! \brief Returns true if the value is an array */
+		inline bool is_array() const { return this->type() == json::jtype::jarray; }
+
+		/*! \brief Returns true if the value is a bool */
+		inline bool is_bool() const { return this->type() == json::jtype::jbool; }
+
+		/*! \brief Returns true if the value is a boolean and set to true */
+		inline bool is_true() const { return this->is_bool() && *this->input == 't'; }
+
+		/*! \brief Returns true if the value is a null value */
+		inline bool is_null() const { return this->type() == json::jtype::jnull; }
+
+		/*! \brief Returns the number of members or elements of an object or array
+		 *
+		 * \details The object or array is scanned on every call
+		 */
+		size_t size() const;
+
+		/*! \brief Returns the decoded key of an object member, or an empty string for other values */
+		std::string key() const;
+
+		/*! \brief Returns the start of the value within the buffer */
+		inline const char* data() const
+		{
+			return this->get_input();
+		}
+
+		/*! \brief Returns the length of the serialized value
+		 *
+		 * \exception json::parsing_error Thrown if the value is not terminated
+		 */
+		size_t length() const;
+
+		/*! \brief Returns a copy of the serialized value */
+		inline std::string raw() const
+		{
+			return std::string(this->data(), this->length());
+		}
+
+		/*! \brief Returns the value as a string
+		 *
+		 * \details Strings are decoded. Other values are returned in their serialized form.
+		 */
+		std::string as_string() const;
+
+		/*! @see json::lazy_value::as_string() */
+		inline operator std::string() const
+		{
+			return this->as_string();
+		}
+
+		/*! \brief Parses the value into a JSON object */
+		inline json::jobject as_object() const
+		{
+			return json::jobject::parse(this->raw());
+		}
+
+		/*! @see json::lazy_value::as_object() */
+		inline operator json::jobject() const
+		{
+			return this->as_object();
+		}
+
+		/*! \brief Casts the value as an integer */
+		operator int() const;
+
+		/*! \brief Casts the value as an unsigned integer */
+		operator unsigned int() const;
+
+		/*! \brief Casts the value as a long integer */
+		operator long() const;
+
+		/*! \brief Casts the value as an unsigned long integer */
+		operator unsigned long() const;
+
+		/*! \brief Casts the value as a floating point numer */
+		operator float() const;
+
+		/*! \brief Casts the value as a double-precision floating point number */
+		operator double() const;
+
+		/*! \brief Determines if a key is present in an object
+		 *
+		 * @param key The key to search for
+		 */
+		inline bool has_key(const std::string &key) const
+		{
+			return this->find(key.data(), key.size()).exists();
+		}
+
+		/*! \brief Returns a member of an object
+		 *
+		 * \details Members before the requested one are skipped without being decoded. If a key appears more than once, the first member is returned.
+		 * @param key The key of the member
+		 * @return A view of the member's value
+		 * \exception json::invalid_key Thrown if the key is not present
+		 * \exception std::invalid_argument Thrown if the value is not an object
+		 */
+		lazy_value get(const std::string &key) const;
+
+		/*! @see json::lazy_value::get() */
+		inline lazy_value operator[](const std::string &key) const
+		{
+			return this->get(key);
+		}
+
+		/*! @see json::lazy_value::get() */
+		inline lazy_value operator[](const char *key) const
+		{
+			return this->get(key);
+		}
+
+		/*! \brief Returns an element of an array
+		 *
+		 * \details The elements before the requested one are skipped. Use json::lazy_value::first and json::lazy_value::next to visit every element.
+		 * @param index The index of the element
+		 * \exception std::out_of_range Thrown if the index is out of range
+		 * \exception std::invalid_argument Thrown if the value is not an array
+		 */
+		lazy_value array(const size_t index) const;
+
+		/*! \brief Returns the first member or element of an object or array
+		 *
+		 * @return The first member or element, or a view that does not refer to a value if the object or array is empty
+		 * \exception std::invalid_argument Thrown if the value is not an object or array
+		 */
+		lazy_value first() const;
+
+		/*! \brief Returns the member or element following this one
+		 *
+		 * @return The next member or element, or a view that does not refer to a value after the last one
+		 */
+		lazy_value next() const;
+	};
+
+#if JSON_HAS_CXX14
+	/*! \class static_document
+	 * \brief A JSON document parsed at compile time
+	 *
+	 * \details The constructor checks the grammar of a string literal and removes insignificant whitespace. When the document is declared `constexpr`, this happens during compilation: malformed input fails to compile, and the compacted text is stored in read-only data inside the object, without a heap allocation or any work at startup. The document is read through json::lazy_value, which walks the text without allocating.
+	 *
+	 * \code
+	 * constexpr auto defaults = json::make_static(R"({ "retries": 3, "hosts": ["a", "b"] })");
+	 * int retries = defaults["retries"];
+	 * \endcode
+	 *
+	 * Escape sequences are checked but not decoded. Nested values are checked recursively, so very deep documents can exceed the compiler's constexpr recursion limit. Requires C++14.
+	 *
+	 * @tparam N The size of the literal, including the terminating null character
+	 */
+	template <size_t N>
+	class static_document
+	{
+	private:
+		/*! \brief The compacted document, padded with null characters */
+		char text[N];
+
+		/*! \brief The number of characters in the compacted document */
+		size_t size;
+
+		/*! \brief Skips insignificant whitespace */
+		static constexpr const char* skip_space(const char *input)
+		{
+			while(*input == ' ' || *input == '\t' || *input == '\n' || *input == '\r') input++;
+			return input;
+		}
+
+		/*! \brief Returns true if the character is a digit */
+		static constexpr bool is_digit(const char c)
+		{
+			return c >= '0' && c <= '9';
+		}
+
+		/*! \brief Returns true if the character is a hexadecimal digit */
+		static constexpr bool is_hex(const char c)
+		{
+			return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+		}
+
+		/*! \brief Copies a run of characters that has already been checked */
+		constexpr void copy(const char *begin, const char *end)
+		{
+			while(begin < end) this->text[this->size++] = *begin++;
+		}
+
+		/*! \brief Checks and copies a literal keyword */
+		constexpr const char* keyword(const char *input, const char *word)
+		{
+			const char *end = input;
+			while(*word != '\0')
+			{
+				if(*end++ != *word++) throw json::parsing_error("Invalid literal");
+			}
+			this->copy(input, end);
+			return end;
+		}
+
+		/*! \brief Checks and copies a number */
+		constexpr const char* number(const char *input)
+		{
+			const char *end = input;
+			if(*end == '-') end++;
+			if(*end == '0') {
+				end++;
+			} else if(is_digit(*end)) {
+				while(is_digit(*end)) end++;
+			} else {
+				throw json::parsing_error("Invalid value");
+			}
+			if(*end == '.') {
+				if(!is_digit(*++end)) throw json::parsing_error("Invalid number");
+				while(is_digit(*end)) end++;
+			}
+			if(*end == 'e' || *end == 'E') {
+				end++;
+				if(*end == '+' || *end == '-') end++;
+				if(!is_digit(*end)) throw json::parsing_error("Invalid number");
+				while(is_digit(*end)) end++;
+			}
+			this->copy(input, end);
+			return end;
+		}
+
+		/*! \brief Checks and copies a string, including its quotations */
+		constexpr const char* string(const char *input)
+		{
+			const char *end = input + 1;
+			while(*end != '"')
+			{
+				if(*end == '\0') throw json::parsing_error("Unterminated string");
+				if((unsigned char)*end < 0x20) throw json::parsing_error("Unescaped control character in string");
+				if(*end++ != '\\') continue;
+				switch(*end++)
+				{
+				case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+					break;
+				case 'u':
+					for(size_t i = 0; i < 4; i++)
+					{
+						if(!is_hex(*end++)) throw json::parsing_error("Invalid unicode escape");
+					}
+					break;
+				default:
+					throw json::parsing_error("Invalid escape sequence");
+				}
+			}
+			this->copy(input, ++end);
+			return end;
+		}
+
+		/*! \brief Checks and copies the members of an object or the elements of an array */
+		constexpr const char* container(const char *input, const char close)
+		{
+			this->text[this->size++] = *input;
+			input = skip_space(input + 1);
+			if(*input == close) {
+				this->text[this->size++] = close;
+				return input + 1;
+			}
+			for(;;)
+			{
+				if(close == '}') {
+					if(*input != '"') throw json::parsing_error("Expected a key");
+					input = skip_space(this->string(input));
+					if(*input != ':') throw json::parsing_error("Expected ':'");
+					this->text[this->size++] = ':';
+					input++;
+				}
+				input = skip_space(this->value(skip_space(input)));
+				if(*input == close) {
+					this->text[this->size++] = close;
+					return input + 1;
+				}
+				if(*input != ',') throw json::parsing_error("Expected ',' or the end of the container");
+				this->text[this->size++] = ',';
+				input = skip_space(input + 1);
+			}
+		}
+
+		/*! \brief Checks and copies a value */
+		constexpr const char* value(const char *input)
+		{
+			switch(*input)
+			{
+			case '{': return this->container(input, '}');
+			case '[': return this->container(input, ']');
+			case '"': return this->string(input);
+			case 't': return this->keyword(input, "true");
+			case 'f': return this->keyword(input, "false");
+			case 'n': return this->keyword(input, "null");
+			default: return this->number(input);
+			}
+		}
+
+	public:
+		/*! \brief Parses a literal
+		 *
+		 * @param literal The serialized document
+		 * \exception json::parsing_error Thrown, or reported as a compile error in a constant expression, if the literal is not valid JSON
+		 */
+		constexpr explicit static_document(const char (&literal)[N]) : text(), size(0)
+		{
+			const char *end = skip_space(this->value(skip_space(literal)));
+			if(end != literal + N - 1) throw json::parsing_error("Unexpected trailing characters");
+		}
+
+		/*! \brief Returns the compacted text as a null-terminated string */
+		constexpr const char* data() const { return this->text; }
+
+		/*! \brief Returns the number of characters in the compacted text */
+		constexpr size_t length() const { return this->size; }
+
+		/*! \brief Returns a view of the document */
+		inline json::lazy_value root() const { return json::lazy_value(this->text); }
+
+		/*! \brief Returns the type of the document */
+		inline json::jtype::jtype type() const { return this->root().type(); }
+
+		/*! @see json::lazy_value::get() */
+		inline json::lazy_value operator[](const char *key) const { return this->root()[key]; }
+
+		/*! @see json::lazy_value::get() */
+		inline json::lazy_value operator[](const std::string &key) const { return this->root()[key]; }
+
+		/*! @see json::lazy_value::array() */
+		inline json::lazy_value array(const size_t index) const { return this->root().array(index); }
+
+		/*! \brief Parses the document into a json::jobject */
+		inline json::jobject as_object() const { return json::jobject::parse(this->text); }
+	};
+
+	/*! \brief Creates a json::static_document, deducing the size of the literal
+	 *
+	 * @see json::static_document
+	 */
+	template <size_t N>
+	constexpr static_document<N> make_static(const char (&literal)[N])
+	{
+		return static_document<N>(literal);
+	}
+#endif
+
+	/*! \class projection
+	 * \brief A set of paths extracted from serialized JSON in a single scan
+	 *
+	 * \details Paths name object members separated by periods, such as `user.name`, and a segment that is a decimal number selects an element when the value at that point is an array. The paths are compiled into a tree once, so a projection can be applied to many inputs. Applying it scans the input once: only members on a requested path are compared and descended into, everything else is skipped by bracket matching, and the scan stops as soon as every path has been found. As with json::lazy_value, if a key appears more than once the first member is used.
+	 */
+	class projection
+	{
+	private:
+		/*! \brief A path segment in the tree of requested paths */
+		struct node
+		{
+			/*! \brief The key of the segment */
+			std::string key;
+
+			/*! \brief The tree nodes for the segments that follow this one */
+			std::vector<size_t> children;
+
+			/*! \brief The requested paths that end at this segment */
+			std::vector<size_t> targets;
+
+			/*! \brief The parent segment */
+			size_t parent;
+
+			/*! \brief The number of segments in this subtree, including this one, that end a requested path */
+			size_t pending;
+		};
+
+		/*! \brief The requested paths */
+		std::vector<std::string> paths;
+
+		/*! \brief The tree of path segments, whose first entry is the root */
+		std::vector<node> nodes;
+
+		/*! \brief Marks the segments from a node up to the root as having fewer unresolved paths
+		 *
+		 * @param index The node
+		 * @param count The number of paths that were resolved or found to be missing
+		 * @param pending The number of unresolved paths for every node
+		 */
+		void settle(size_t index, const size_t count, std::vector<size_t> &pending) const;
+
+		/*! \brief Scans a value for the children of a node
+		 *
+		 * @param input The start of the value
+		 * @param index The node
+		 * @param pending The number of unresolved paths for every node
+		 * @param views The views of the requested paths
+		 * @return A pointer to the end of the value, or `NULL` if every path has been resolved
+		 * \exception json::parsing_error Thrown if the scanned input is malformed
+		 */
+		const char* scan(const char *input, const size_t index, std::vector<size_t> &pending, std::vector<json::lazy_value> &views) const;
+
+	public:
+		/*! \brief Constructor
+		 *
+		 * @param paths The paths to be extracted
+		 * \exception std::invalid_argument Thrown if a path is empty
+		 */
+		explicit projection(const std::vector<std::string> &paths);
+
+		/*! \brief Returns the number of paths */
+		inline size_t size() const
+		{
+			return this->paths.size();
+		}
+
+		/*! \brief Returns a path
+		 *
+		 * @param index The index of the path
+		 */
+		inline const std::string& path(const size_t index) const
+		{
+			return this->paths.at(index);
+		}
+
+		/*! \brief Locates every path in a serialized value
+		 *
+		 * @param input The null-terminated serialized value
+		 * @param[out] views One view for each path, in the order of the paths. Views of missing paths do not refer to a value.
+		 * \exception json::parsing_error Thrown if the scanned input is malformed
+		 */
+		void apply(const char *input, std::vector<json::lazy_value> &views) const;
+
+		/*! \brief Copies every path in a serialized value into an object
+		 *
+		 * @param input The null-terminated serialized value
+		 * @return An object with one member per path that was found, keyed by the path
+		 * \exception json::parsing_error Thrown if the scanned input is malformed
+		 */
+		json::jobject extract(const char *input) const;
+	};
+
+	/*! \brief Extracts a set of paths from a serialized value in a single scan
+	 *
+	 * @param input The null-terminated serialized value
+	 * @param paths The paths to be extracted, for example `{"id", "user.name", "ts"}`
+	 * @return An object with one member per path that was found, keyed by the path
+	 * @see json::projection
+	 */
+	inline json::jobject project(const char *input, const std::vector<std::string> &paths)
+	{
+		return json::projection(paths).extract(input);
+	}
+
+	/*! @see json::project(const char*, const std::vector<std::string>&) */
+	inline json::jobject project(const std::string &input, const std::vector<std::string> &paths)
+	{
+		return json::projection(paths).extract(input.c_str());
+	}
+	/*! \class schema
+	 * \brief A JSON Schema compiled into a validator
+	 *
+	 * \details Supports a subset of JSON Schema draft 2020-12: boolean schemas and the `type`, `enum`, `const`, `required`, `properties`, `additionalProperties`, `items`, `minimum`, `maximum`, `exclusiveMinimum`, `exclusiveMaximum`, `minLength`, `maxLength`, `minItems`, `maxItems` and `pattern` keywords. Other keywords are ignored. `pattern` requires C++11, where it is evaluated with `std::regex`.
+	 *
+	 * The schema is compiled once into a table of nodes with sorted property lists. Validation then checks the JSON grammar and the schema together in a single pass over the serialized input, without building a json::jobject. It stops at the first violation.
+	 */
+	class schema
+	{
+	private:
+		/*! \brief The compiled nodes of the schema */
+		struct program;
+
+		/*! \brief The compiled schema */
+		program *compiled;
+
+		/*! \brief Compiles a serialized schema */
+		void compile(const char *definition);
+
+		/*! \brief Copying is not supported */
+		schema(const schema &other);
+
+		/*! \brief Copying is not supported */
+		schema& operator=(const schema &other);
+
+	public:
+		/*! \brief Compiles a schema
+		 *
+		 * @param definition The serialized schema, which may also be `true` or `false`
+		 * \exception std::invalid_argument Thrown if the schema is malformed or uses an unsupported feature
+		 */
+		explicit schema(const char *definition);
+
+		/*! @see json::schema::schema(const char*) */
+		explicit schema(const std::string &definition);
+
+		/*! @see json::schema::schema(const char*) */
+		explicit schema(const json::jobject &definition);
+
+		/*! \brief Destructor */
+		~schema();
+
+		/*! \brief Validates a serialized value
+		 *
+		 * @param input The serialized value
+		 * @param[out] error A description of the first violation and the JSON Pointer to the value that caused it, set if the value is not valid
+		 * @return True if the input is valid JSON and conforms to the schema
+		 */
+		bool validate(const char *input, std::string &error) const;
+
+		/*! @see json::schema::validate(const char*, std::string&) const */
+		bool validate(const char *input) const;
+
+		/*! @see json::schema::validate(const char*, std::string&) const */
+		inline bool validate(const std::string &input) const
+		{
+			return this->validate(input.c_str());
+		}
+
+		/*! @see json::schema::validate(const char*, std::string&) const */
+		inline bool validate(const json::jobject &input) const
+		{
+			return this->validate(input.as_string());
+		}
+	};
+
+	/*! \brief Namespace for compile-time bindings between C++ structs and JSON objects
+	 *
+	 * \details A struct is bound by listing its fields in an X-macro and passing it to #JSON_BIND_STRUCT:
+	 * \code
+	 * struct point { int x; int y; std::string label; };
+	 * #define POINT_FIELDS(FIELD) FIELD(x) FIELD(y) FIELD(label)
+	 * JSON_BIND_STRUCT(point, POINT_FIELDS)
+	 *
+	 * point p = json::binding::parse<point>("{\"x\": 1, \"y\": 2, \"label\": \"origin\"}");
+	 * std::string text = json::binding::serialize(p);
+	 * \endcode
+	 * The generated parser reads straight from the input into the fields, without building a json::jobject or copying keys. With C++11, keys are dispatched through a `switch` over a constexpr hash of the field names, so the compiler rejects a binding whose field names collide. Older compilers compare the key against each field name in turn. Unknown members are skipped, and null values leave the field unchanged. Fields may be numbers, `bool`, `std::string`, `std::vector` of a supported type, json::jobject or other bound structs.
+	 */
+	namespace binding
+	{
+		/*! \brief The binding of a struct, specialized by #JSON_BIND_STRUCT */
+		template<typename T>
+		struct traits;
+
+		#if JSON_HAS_CXX11
+		/*! \brief Hashes a key using FNV-1a
+		 *
+		 * @param key The characters of the key
+		 * @param length The number of characters
+		 * @param seed The hash of the preceding characters
+		 */
+		constexpr uint64_t hash(const char *key, const size_t length, const uint64_t seed = 14695981039346656037ULL)
+		{
+			return length == 0 ? seed : json::binding::hash(key + 1, length - 1, (seed ^ (unsigned char)*key) * 1099511628211ULL);
+		}
+
+		/*! \brief Hashes a key read from the input
+		 *
+		 * \details Computes the same hash as json::binding::hash without recursion, so that the length of the key does not matter
+		 * @param key The characters of the key
+		 * @param length The number of characters
+		 */
+		inline uint64_t hash_key(const char *key, const size_t length)
+		{
+			uint64_t result = 14695981039346656037ULL;
+			for(size_t i = 0; i < length; i++) result = (result ^ (unsigned char)key[i]) * 1099511628211ULL;
+			return result;
+		}
+
+		/*! \brief Returns the greatest of a list of field name lengths
+		 *
+		 * @param lengths The lengths
+		 * @param count The number of lengths
+		 * @param result The greatest length seen so far
+		 */
+		constexpr size_t longest(const size_t *lengths, const size_t count, const size_t result = 0)
+		{
+			return count == 0 ? result : json::binding::longest(lengths + 1, count - 1, *lengths > result ? *lengths : result);
+		}
+		#endif
+
+		/*! \brief Returns true if a key matches a field name */
+		bool matches(const char *key, const size_t length, const char *name, const size_t name_length);
+
+		/*! \brief Moves past the opening brace of an object
+		 *
+		 * \exception json::parsing_error Thrown if the input is not an object
+		 */
+		void begin_object(const char *&input);
+
+		/*! \brief Reads the key of the next member of an object
+		 *
+		 * @param[in,out] input The position within the object, advanced to the value of the member or past the closing brace
+		 * @param[out] key The characters of the key, pointing into the input unless the key contains escape sequences
+		 * @param[out] length The number of characters in the key
+		 * @param scratch Storage for keys that contain escape sequences
+		 * @return False if the end of the object was reached
+		 * \exception json::parsing_error Thrown if the object is malformed
+		 */
+		bool next_key(const char *&input, const char *&key, size_t &length, std::string &scratch);
+
+		/*! \brief Moves past the opening bracket of an array
+		 *
+		 * \exception json::parsing_error Thrown if the input is not an array
+		 */
+		void begin_array(const char *&input);
+
+		/*! \brief Moves to the next element of an array
+		 *
+		 * @param[in,out] input The position within the array, advanced to the next element or past the closing bracket
+		 * @param first True if no element has been read yet
+		 * @return False if the end of the array was reached
+		 * \exception json::parsing_error Thrown if the array is malformed
+		 */
+		bool next_element(const char *&input, const bool first);
+
+		/*! \brief Skips a value
+		 *
+		 * \exception json::parsing_error Thrown if the value is malformed
+		 */
+		void skip(const char *&input);
+
+		/*! \brief Skips a null value
+		 *
+		 * @return True if the input was a null value
+		 */
+		bool skip_null(const char *&input);
+
+		/*! \brief Checks that nothing but whitespace follows a value
+		 *
+		 * @param input The position after the value
+		 * \exception json::parsing_error Thrown if other characters follow the value
+		 */
+		void end(const char *input);
+
+		/*! \brief Reads a value into an integer */
+		void read(const char *&input, int &value);
+
+		/*! \brief Reads a value into an unsigned integer */
+		void read(const char *&input, unsigned int &value);
+
+		/*! \brief Reads a value into a long integer */
+		void read(const char *&input, long &value);
+
+		/*! \brief Reads a value into an unsigned long integer */
+		void read(const char *&input, unsigned long &value);
+
+		/*! \brief Reads a value into a floating-point number */
+		void read(const char *&input, float &value);
+
+		/*! \brief Reads a value into a double-precision floating-point number */
+		void read(const char *&input, double &value);
+
+		/*! \brief Reads a value into a boolean */
+		void read(const char *&input, bool &value);
+
+		/*! \brief Reads a value into a string, decoding escape sequences */
+		void read(const char *&input, std::string &value);
+
+		/*! \brief Reads an object or array into a JSON object */
+		void read(const char *&input, json::jobject &value);
+
+		/*! \brief Reads an object into a bound struct */
+		template<typename T>
+		void read(const char *&input, T &value)
+		{
+			if(skip_null(input)) return;
+			traits<T>::read(input, value);
+		}
+
+		/*! \brief Reads an array into a vector */
+		template<typename T>
+		void read(const char *&input, std::vector<T> &value)
+		{
+			if(skip_null(input)) return;
+			value.clear();
+			begin_array(input);
+			for(bool first = true; next_element(input, first); first = false)
+			{
+				value.push_back(T());
+				read(input, value.back());
+			}
+		}
+
+		/*! \brief Appends an integer */
+		void write(std::string &output, const int value);
+
+		/*! \brief Appends an unsigned integer */
+		void write(std::string &output, const unsigned int value);
+
+		/*! \brief Appends a long integer */
+		void write(std::string &output, const long value);
+
+		/*! \brief Appends an unsigned long integer */
+		void write(std::string &output, const unsigned long value);
+
+		/*! \brief Appends a floating-point number */
+		void write(std::string &output, const float value);
+
+		/*! \brief Appends a double-precision floating-point number, using the shortest representation that reads back exactly */
+		void write(std::string &output, const double value);
+
+		/*! \brief Appends a boolean */
+		void write(std::string &output, const bool value);
+
+		/*! \brief Appends an encoded string */
+		void write(std::string &output, const std::string &value);
+
+		/*! \brief Appends a JSON object or array */
+		void write(std::string &output, const json::jobject &value);
+
+		/*! \brief Appends a bound struct as an object */
+		template<typename T>
+		void write(std::string &output, const T &value)
+		{
+			traits<T>::write(output, value);
+		}
+
+		/*! \brief Appends a vector as an array */
+		template<typename T>
+		void write(std::string &output, const std::vector<T> &value)
+		{
+			output += '[';
+			for(size_t i = 0; i < value.size(); i++)
+			{
+				if(i > 0) output += ',';
+				write(output, value[i]);
+			}
+			output += ']';
+		}
+
+		/*! \brief Parses serialized JSON into a value
+		 *
+		 * @param input The serialized value
+		 * @param[out] output The value to be read into. Fields that are absent keep their values.
+		 * \exception json::parsing_error Thrown if the input is malformed, is followed by other characters, does not match the type of a field or holds a number outside of the range of an integer field
+		 */
+		template<typename T>
+		void parse(const char *input, T &output)
+		{
+			read(input, output);
+			end(input);
+		}
+
+		/*! \brief Parses serialized JSON into a default-constructed value
+		 *
+		 * @see json::binding::parse(const char*, T&)
+		 */
+		template<typename T>
+		T parse(const char *input)
+		{
+			T result = T();
+			read(input, result);
+			end(input);
+			return result;
+		}
+
+		/*! @see json::binding::parse(const char*) */
+		template<typename T>
+		T parse(const std::string &input)
+		{
+			return parse<T>(input.c_str());
+		}
+
+		/*! \brief Serializes a value */
+		template<typename T>
+		std::string serialize(const T &value)
+		{
+			std::string result;
+			write(result, value);
+			return result;
+		}
+	}
+}
+
+/*! \brief Reads one bound field when its name matches the key */
+#if JSON_HAS_CXX11
+#define JSON_BIND_READ_FIELD(name) \
+	case json::binding::hash(#name, sizeof(#name) - 1): \
+		if(!json::binding::matches(key, length, #name, sizeof(#name) - 1)) return false; \
+		json::binding::read(input, object.name); \
+		return true;
+#else
+#define JSON_BIND_READ_FIELD(name) \
+	if(json::binding::matches(key, length, #name, sizeof(#name) - 1)) { \
+		json::binding::read(input, object.name); \
+		return true; \
+	}
+#endif
+
+/*! \brief Lists the length of one bound field name */
+#define JSON_BIND_NAME_LENGTH(name) sizeof(#name) - 1,
+
+/*! \brief Dispatches a key to the bound fields
+ *
+ * \details With C++11, keys longer than every field name are skipped before they are hashed
+ */
+#if JSON_HAS_CXX11
+#define JSON_BIND_DISPATCH(FIELDS) \
+	static constexpr size_t name_lengths[] = { FIELDS(JSON_BIND_NAME_LENGTH) 0 }; \
+	if(length > json::binding::longest(name_lengths, sizeof(name_lengths) / sizeof(name_lengths[0]))) return false; \
+	switch (json::binding::hash_key(key, length)) \
+	{ \
+	FIELDS(JSON_BIND_READ_FIELD) \
+	} \
+	return false;
+#else
+#define JSON_BIND_DISPATCH(FIELDS) \
+	FIELDS(JSON_BIND_READ_FIELD) \
+	return false;
+#endif
+
+/*! \brief Appends one bound field as an object member */
+#define JSON_BIND_WRITE_FIELD(name) \
+	output += separator; \
+	separator = ','; \
+	output += "\"" #name "\":"; \
+	json::binding::write(output, object.name);
+
+/*! \brief Binds a struct to a JSON object
+ *
+ * \details Must be used at global scope.
+ * @param type The fully qualified name of the struct
+ * @param FIELDS An X-macro that invokes its argument with the name of each field
+ * @see json::binding
+ */
+#define JSON_BIND_STRUCT(type, FIELDS) \
+	namespace json { namespace binding { \
+	template<> \
+	struct traits<type> \
+	{ \
+		static bool read_field(const char *key, const size_t length, const char *&input, type &object) \
+		{ \
+			JSON_BIND_DISPATCH(FIELDS) \
+		} \
+		static void read(const char *&input, type &object) \
+		{ \
+			const char *key; \
+			size_t length; \
+			std::string scratch; \
+			json::binding::begin_object(input); \
+			while(json::binding::next_key(input, key, length, scratch)) \
+			{ \
+				if(!read_field(key, length, input, object)) json::binding::skip(input); \
+			} \
+		} \
+		static void write(std::string &output, const type &object) \
+		{ \
+			char separator = '{'; \
+			FIELDS(JSON_BIND_WRITE_FIELD) \
+			if(separator == '{') output += '{'; \
+			output += '}'; \
+		} \
+	}; \
+	} }
 
 #endif // !JSON_H
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+#define BYTES(array) std::string((const char *)array, sizeof(array))
+
+bool cbor_rejected(const std::string &input)
+{
+    try { json::jobject::parse_cbor(input); } catch(const json::parsing_error &) { return true; }
+    return false;
+}
+
+bool msgpack_rejected(const std::string &input)
+{
+    try { json::jobject::parse_msgpack(input); } catch(const json::parsing_error &) { return true; }
+    return false;
+}
+
+bool encoding_rejected(const json::jobject &input)
+{
+    bool cbor = false;
+    bool msgpack = false;
+    try { input.as_cbor(); } catch(const json::parsing_error &) { cbor = true; }
+    try { input.as_msgpack(); } catch(const json::parsing_error &) { msgpack = true; }
+    return cbor && msgpack;
+}
+
+int main(void)
+{
+    const json::jobject simple = json::jobject::parse("{\"a\":1,\"b\":[2,3]}");
+
+    // Known encodings
+    const unsigned char cbor_simple[] = { 0xA2, 0x61, 0x61, 0x01, 0x61, 0x62, 0x82, 0x02, 0x03 };
+    const unsigned char msgpack_simple[] = { 0x82, 0xA1, 0x61, 0x01, 0xA1, 0x62, 0x92, 0x02, 0x03 };
+    TEST_TRUE(simple.as_cbor() == BYTES(cbor_simple));
+    TEST_TRUE(simple.as_msgpack() == BYTES(msgpack_simple));
+    TEST_TRUE(json::jobject::parse_cbor(BYTES(cbor_simple)) == simple);
+    TEST_TRUE(json::jobject::parse_msgpack(BYTES(msgpack_simple)) == simple);
+
+    // Integers and floating-point values keep their type
+    const json::jobject numbers = json::jobject::parse("[0, -1, 23, 24, -100, 1000, 1.5, 1.1, -33, 200, 4294967296, 18446744073709551615, -9223372036854775808, 1e2]");
+    const unsigned char cbor_numbers[] = {
+        0x8E, 0x00, 0x20, 0x17, 0x18, 0x18, 0x38, 0x63, 0x19, 0x03, 0xE8, 0xFA, 0x3F, 0xC0, 0x00, 0x00,
+        0xFB, 0x3F, 0xF1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A, 0x38, 0x20, 0x18, 0xC8,
+        0x1B, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x1B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0x3B, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFA, 0x42, 0xC8, 0x00, 0x00 };
+    const unsigned char msgpack_numbers[] = {
+        0x9E, 0x00, 0xFF, 0x17, 0x18, 0xD0, 0x9C, 0xCD, 0x03, 0xE8, 0xCA, 0x3F, 0xC0, 0x00, 0x00,
+        0xCB, 0x3F, 0xF1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A, 0xD0, 0xDF, 0xCC, 0xC8,
+        0xCF, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0xCF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xD3, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xCA, 0x42, 0xC8, 0x00, 0x00 };
+    TEST_TRUE(numbers.as_cbor() == BYTES(cbor_numbers));
+    TEST_TRUE(numbers.as_msgpack() == BYTES(msgpack_numbers));
+    json::jobject decoded = json::jobject::parse_cbor(BYTES(cbor_numbers));
+    TEST_TRUE(decoded == numbers);
+    TEST_STRING_EQUAL(decoded.get(11).c_str(), "18446744073709551615");
+    TEST_STRING_EQUAL(decoded.get(12).c_str(), "-9223372036854775808");
+    TEST_STRING_EQUAL(decoded.get(13).c_str(), "1e+02");
+    TEST_TRUE(decoded.as_cbor() == BYTES(cbor_numbers));
+    decoded = json::jobject::parse_msgpack(BYTES(msgpack_numbers));
+    TEST_TRUE(decoded == numbers);
+    TEST_TRUE(decoded.as_msgpack() == BYTES(msgpack_numbers));
+
+    // Round trip of a typical record, including escapes and nested values
+    const json::jobject record = json::jobject::parse(
+        "{\"_id\":\"5b8ae80aa0ad7bab287b087c\",\"isActive\":true,\"balance\":\"$3,801.20\",\"about\":\"line\\r\\n\\u00e9\","
+        "\"latitude\":41.271876,\"empty\":{},\"none\":null,\"tags\":[\"dolore\",\"et\"],"
+        "\"friends\":[{\"id\":0,\"name\":\"Amie Jarvis\"},{\"id\":1,\"name\":\"Rosanna Gonzales\"}]}");
+    TEST_TRUE(json::jobject::parse_cbor(record.as_cbor()) == record);
+    TEST_TRUE(json::jobject::parse_msgpack(record.as_msgpack()) == record);
+    TEST_TRUE(record.as_cbor().size() < record.as_string().size());
+    TEST_TRUE(record.as_msgpack().size() < record.as_string().size());
+    const json::jobject root_array = json::jobject::parse("[[], {}, \"\", false]");
+    TEST_TRUE(json::jobject::parse_cbor(root_array.as_cbor()) == root_array);
+    TEST_TRUE(json::jobject::parse_msgpack(root_array.as_msgpack()) == root_array);
+
+    // Long strings use wider length headers
+    json::jobject long_string;
+    long_string["text"] = std::string(300, 'x');
+    TEST_TRUE(json::jobject::parse_cbor(long_string.as_cbor()) == long_string);
+    TEST_TRUE(json::jobject::parse_msgpack(long_string.as_msgpack()) == long_string);
+
+    // CBOR indefinite lengths, half-precision values and tags
+    const unsigned char indefinite[] = { 0xBF, 0x61, 0x61, 0x01, 0x61, 0x62, 0x9F, 0x02, 0x03, 0xFF, 0xFF };
+    TEST_TRUE(json::jobject::parse_cbor(BYTES(indefinite)) == simple);
+    const unsigned char chunked[] = { 0x81, 0x7F, 0x65, 's', 't', 'r', 'e', 'a', 0x64, 'm', 'i', 'n', 'g', 0xFF };
+    TEST_STRING_EQUAL(json::jobject::parse_cbor(BYTES(chunked)).array(0).as_string().c_str(), "streaming");
+    const unsigned char half[] = { 0x82, 0xF9, 0x3E, 0x00, 0xC1, 0x1A, 0x51, 0x4B, 0x67, 0xB0 };
+    decoded = json::jobject::parse_cbor(BYTES(half));
+    TEST_TRUE((double)decoded.array(0) == 1.5);
+    TEST_EQUAL((long)decoded.array(1), 1363896240L);
+
+    // Malformed input and values without a JSON equivalent
+    const unsigned char truncated[] = { 0x82, 0x01 };
+    const unsigned char trailing[] = { 0x80, 0x00 };
+    const unsigned char byte_string[] = { 0x81, 0x41, 0x00 };
+    const unsigned char integer_key[] = { 0xA1, 0x01, 0x02 };
+    const unsigned char not_a_number[] = { 0x81, 0xF9, 0x7E, 0x00 };
+    const unsigned char scalar[] = { 0x01 };
+    const unsigned char stray_break[] = { 0x82, 0x01, 0xFF };
+    TEST_TRUE(cbor_rejected(BYTES(truncated)));
+    TEST_TRUE(cbor_rejected(BYTES(trailing)));
+    TEST_TRUE(cbor_rejected(BYTES(byte_string)));
+    TEST_TRUE(cbor_rejected(BYTES(integer_key)));
+    TEST_TRUE(cbor_rejected(BYTES(not_a_number)));
+    TEST_TRUE(cbor_rejected(BYTES(scalar)));
+    TEST_TRUE(cbor_rejected(BYTES(stray_break)));
+    TEST_TRUE(cbor_rejected(std::string()));
+    const unsigned char msgpack_truncated[] = { 0x92, 0x01 };
+    const unsigned char msgpack_binary[] = { 0x91, 0xC4, 0x01, 0x00 };
+    const unsigned char msgpack_integer_key[] = { 0x81, 0x01, 0x02 };
+    const unsigned char msgpack_long_string[] = { 0x91, 0xDB, 0xFF, 0xFF, 0xFF, 0xFF, 'x' };
+    TEST_TRUE(msgpack_rejected(BYTES(msgpack_truncated)));
+    TEST_TRUE(msgpack_rejected(BYTES(msgpack_binary)));
+    TEST_TRUE(msgpack_rejected(BYTES(msgpack_integer_key)));
+    TEST_TRUE(msgpack_rejected(BYTES(msgpack_long_string)));
+
+    // Numbers beyond double precision lose precision, and numbers beyond its range are not encoded
+    const json::jobject huge = json::jobject::parse("[123456789012345678901234567890]");
+    TEST_EQUAL((unsigned char)huge.as_cbor()[1], 0xFB);
+    TEST_EQUAL((unsigned char)huge.as_msgpack()[1], 0xCB);
+    TEST_TRUE((double)json::jobject::parse_cbor(huge.as_cbor()).array(0) == 123456789012345678901234567890.0);
+    TEST_TRUE((double)json::jobject::parse_msgpack(huge.as_msgpack()).array(0) == 123456789012345678901234567890.0);
+    TEST_TRUE(encoding_rejected(json::jobject::parse("[1e400]")));
+    TEST_TRUE(encoding_rejected(json::jobject::parse("{\"a\":[-1e400]}")));
+
+    // Nesting is limited to 1024 levels in both directions
+    const std::string deepest = std::string(1023, '[') + "1" + std::string(1023, ']');
+    const json::jobject nested = json::jobject::parse("[" + deepest + "]");
+    TEST_TRUE(json::jobject::parse_cbor(nested.as_cbor()) == nested);
+    TEST_TRUE(json::jobject::parse_msgpack(nested.as_msgpack()) == nested);
+    TEST_TRUE(encoding_rejected(json::jobject::parse("[[" + deepest + "]]")));
+    TEST_TRUE(cbor_rejected(std::string(100000, (char)0x81) + '\x01'));
+    TEST_TRUE(msgpack_rejected(std::string(100000, (char)0x91) + '\x01'));
+    TEST_FALSE(cbor_rejected(std::string(1024, (char)0x81) + '\x01'));
+    TEST_TRUE(cbor_rejected(std::string(1025, (char)0x81) + '\x01'));
+
+    // Chains of tags are skipped without recursion and limited in length
+    TEST_FALSE(cbor_rejected("\xA1\x61\x61" + std::string(1024, (char)0xC6) + '\x01'));
+    TEST_TRUE(cbor_rejected("\xA1\x61\x61" + std::string(1000000, (char)0xC6) + '\x01'));
+}
@@ -0,0 +1,119 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+#include <vector>
+
+namespace telemetry
+{
+    struct position
+    {
+        double lat;
+        double lon;
+    };
+
+    struct reading
+    {
+        std::string sensor;
+        int value;
+        unsigned long sequence;
+        float scale;
+        bool valid;
+        position where;
+        std::vector<int> samples;
+        std::vector<position> track;
+        json::jobject extra;
+    };
+}
+
+#define POSITION_FIELDS(FIELD) FIELD(lat) FIELD(lon)
+JSON_BIND_STRUCT(telemetry::position, POSITION_FIELDS)
+
+#define READING_FIELDS(FIELD) FIELD(sensor) FIELD(value) FIELD(sequence) FIELD(scale) FIELD(valid) FIELD(where) FIELD(samples) FIELD(track) FIELD(extra)
+JSON_BIND_STRUCT(telemetry::reading, READING_FIELDS)
+
+std::string reading_error(const char *input)
+{
+    try { json::binding::parse<telemetry::reading>(input); } catch(const json::parsing_error &error) { return error.what(); }
+    return "";
+}
+
+int main(void)
+{
+    const char *input =
+        "{ \"sensor\": \"t\\u00e9mp\", \"unknown\": {\"nested\": [1, {\"x\": \"}\"}]}, \"value\": -42, \"sequence\": 4000000000,"
+        "  \"scale\": 0.5, \"valid\": true, \"where\": {\"lon\": 4.35, \"lat\": 50.85}, \"samples\": [1, 2, 3],"
+        "  \"track\": [{\"lat\": 1, \"lon\": 2}, {\"lat\": 3, \"lon\": 4}], \"extra\": {\"k\": [null]}, \"v\\u0061lue\": 7 }";
+    telemetry::reading result = json::binding::parse<telemetry::reading>(input);
+    TEST_STRING_EQUAL(result.sensor.c_str(), "t\xc3\xa9mp");
+    TEST_EQUAL(result.value, 7);
+    TEST_EQUAL(result.sequence, 4000000000UL);
+    TEST_EQUAL(result.scale, 0.5f);
+    TEST_TRUE(result.valid);
+    TEST_EQUAL(result.where.lat, 50.85);
+    TEST_EQUAL(result.where.lon, 4.35);
+    TEST_EQUAL(result.samples.size(), 3);
+    TEST_EQUAL(result.samples[2], 3);
+    TEST_EQUAL(result.track.size(), 2);
+    TEST_EQUAL(result.track[1].lon, 4);
+    TEST_STRING_EQUAL(result.extra.as_string().c_str(), "{\"k\":[null]}");
+
+    // Serialization writes fields in declaration order and reads back identically
+    result.value = -42;
+    result.scale = 0.1f;
+    const std::string serialized = json::binding::serialize(result);
+    TEST_STRING_EQUAL(serialized.c_str(),
+        "{\"sensor\":\"t\xc3\xa9mp\",\"value\":-42,\"sequence\":4000000000,\"scale\":0.1,\"valid\":true,"
+        "\"where\":{\"lat\":50.85,\"lon\":4.35},\"samples\":[1,2,3],\"track\":[{\"lat\":1.0,\"lon\":2.0},{\"lat\":3.0,\"lon\":4.0}],"
+        "\"extra\":{\"k\":[null]}}");
+    const telemetry::reading copy = json::binding::parse<telemetry::reading>(serialized);
+    TEST_STRING_EQUAL(json::binding::serialize(copy).c_str(), serialized.c_str());
+    TEST_TRUE(json::jobject::parse(serialized).has_key("track"));
+
+    // Absent members and nulls leave fields unchanged
+    telemetry::position point = { 1.5, 2.5 };
+    json::binding::parse("{\"lat\": null}", point);
+    TEST_EQUAL(point.lat, 1.5);
+    TEST_EQUAL(point.lon, 2.5);
+
+    // Vectors of bound structs at the top level
+    const std::vector<telemetry::position> points = json::binding::parse<std::vector<telemetry::position> >(std::string("[{\"lat\": -1}, {}]"));
+    TEST_EQUAL(points.size(), 2);
+    TEST_EQUAL(points[0].lat, -1);
+    TEST_STRING_EQUAL(json::binding::serialize(std::vector<int>()).c_str(), "[]");
+
+    // Type mismatches and malformed input
+    bool thrown = false;
+    try { json::binding::parse<telemetry::reading>("{\"value\": \"text\"}"); } catch(const json::parsing_error &) { thrown = true; }
+    TEST_TRUE(thrown);
+    thrown = false;
+    try { json::binding::parse<telemetry::reading>("{\"samples\": [1 2]}"); } catch(const json::parsing_error &) { thrown = true; }
+    TEST_TRUE(thrown);
+    thrown = false;
+    try { json::binding::parse<telemetry::position>("[1, 2]"); } catch(const json::parsing_error &) { thrown = true; }
+    TEST_TRUE(thrown);
+
+    // Integer fields reject fractions and numbers outside of their range
+    TEST_STRING_EQUAL(reading_error("{\"value\": 1.5}").c_str(), "Value is not an integer");
+    TEST_STRING_EQUAL(reading_error("{\"value\": 1e3}").c_str(), "Value is not an integer");
+    TEST_STRING_EQUAL(reading_error("{\"value\": 99999999999}").c_str(), "Value is out of range");
+    TEST_STRING_EQUAL(reading_error("{\"value\": -99999999999}").c_str(), "Value is out of range");
+    TEST_STRING_EQUAL(reading_error("{\"sequence\": -1}").c_str(), "Value is out of range");
+    TEST_STRING_EQUAL(reading_error("{\"sequence\": 99999999999999999999999}").c_str(), "Value is out of range");
+    TEST_STRING_EQUAL(reading_error("{\"value\": 2147483647, \"sequence\": -0}").c_str(), "");
+    TEST_EQUAL(json::binding::parse<telemetry::reading>("{\"value\": -2147483648}").value, -2147483647 - 1);
+
+    // Long keys are skipped without recursing over their characters
+    const std::string long_key = "{\"" + std::string(2000000, 'k') + "\": 1, \"value\": 2}";
+    TEST_EQUAL(json::binding::parse<telemetry::reading>(long_key).value, 2);
+#if JSON_HAS_CXX11
+    TEST_EQUAL(json::binding::hash_key("sequence", 8), json::binding::hash("sequence", 8));
+#endif
+
+    // Only whitespace may follow the value
+    TEST_STRING_EQUAL(reading_error("{\"value\": 1} trailing garbage {").c_str(), "Unexpected characters after value");
+    TEST_STRING_EQUAL(reading_error("{\"value\": 1}{}").c_str(), "Unexpected characters after value");
+    TEST_STRING_EQUAL(reading_error(" {\"value\": 1} \n").c_str(), "");
+    thrown = false;
+    try { json::binding::parse("{\"lat\": 1} x", point); } catch(const json::parsing_error &) { thrown = true; }
+    TEST_TRUE(thrown);
+}
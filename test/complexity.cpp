@@ -0,0 +1,253 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+#include <math.h>
+#include <time.h>
+
+/*
+ * Guards the asymptotic cost of operations that have been quadratic in the past. Each workload is timed at n, 2n, 4n
+ * and 8n; the growth exponent log(T(8n) / T(n)) / log(8) must stay within half a class of the expected one, so that a
+ * linear operation turning quadratic fails while timing noise does not.
+ */
+
+typedef void (*workload)(const size_t n);
+
+static volatile size_t sink = 0;
+
+static std::string key_for(const size_t index)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "key_%lu", (unsigned long)index);
+    return buffer;
+}
+
+static std::string flat_object(const size_t n)
+{
+    std::string result = "{";
+    for(size_t i = 0; i < n; i++)
+    {
+        if(i > 0) result += ", ";
+        result += "\"" + key_for(i) + "\": [1, \"text\", true]";
+    }
+    return result + "}";
+}
+
+static std::string reversed_object(const size_t n)
+{
+    std::string result = "{";
+    for(size_t i = n; i > 0; i--)
+    {
+        if(i < n) result += ", ";
+        result += "\"" + key_for(i - 1) + "\": [1, \"text\", true]";
+    }
+    return result + "}";
+}
+
+static std::string nested_object(const size_t depth)
+{
+    std::string result = "1";
+    for(size_t i = 0; i < depth; i++) result = "{\"padding\": \"text\", \"n\": " + result + "}";
+    return result;
+}
+
+static std::string nested_array(const size_t depth)
+{
+    return std::string(depth, '[') + "1" + std::string(depth, ']');
+}
+
+/* Cached inputs, so that building them is not part of the measurement */
+static std::string inputs[4];
+static size_t input_sizes[4];
+
+static const std::string &cached(const size_t slot, const size_t n, std::string (*make)(const size_t))
+{
+    if(input_sizes[slot] != n || inputs[slot].empty())
+    {
+        inputs[slot] = make(n);
+        input_sizes[slot] = n;
+    }
+    return inputs[slot];
+}
+
+static void append_members(const size_t n)
+{
+    json::jobject result;
+    for(size_t i = 0; i < n; i++) result += json::kvp(key_for(i), "1");
+    sink += result.size();
+}
+
+static void parse_flat(const size_t n)
+{
+    sink += json::jobject::parse(cached(0, n, flat_object)).size();
+}
+
+static void parse_packed(const size_t n)
+{
+    sink += json::packed_object::parse(cached(0, n, flat_object)).size();
+}
+
+static void lookup_members(const size_t n)
+{
+    const json::jobject parsed = json::jobject::parse(cached(0, n, flat_object));
+    for(size_t i = 0; i < n; i++) sink += parsed.has_key(key_for(i));
+}
+
+static void remove_members(const size_t n)
+{
+    json::jobject parsed = json::jobject::parse(cached(0, n, flat_object));
+    json::key_list_t keys;
+    for(size_t i = 0; i < n; i += 2) keys.push_back(key_for(i));
+    parsed.remove(keys);
+    sink += parsed.size();
+}
+
+static void remove_members_singly(const size_t n)
+{
+    json::jobject parsed = json::jobject::parse(cached(0, n, flat_object));
+    for(size_t i = 0; i < n; i += 2) parsed.remove(key_for(i));
+    sink += parsed.size();
+}
+
+static void compare_reordered(const size_t n)
+{
+    sink += json::parsing::equal(cached(0, n, flat_object).c_str(), cached(3, n, reversed_object).c_str());
+}
+
+static void parse_nested(const size_t depth)
+{
+    sink += json::jobject::parse(cached(1, depth, nested_object)).size();
+}
+
+static void parse_nested_arrays(const size_t depth)
+{
+    sink += json::jobject::parse(cached(2, depth, nested_array)).size();
+}
+
+static const json::jobject &parsed_nested(const size_t depth)
+{
+    static json::jobject parsed;
+    static size_t parsed_depth = 0;
+    if(parsed_depth != depth)
+    {
+        parsed = json::jobject::parse(cached(1, depth, nested_object));
+        parsed_depth = depth;
+    }
+    return parsed;
+}
+
+static const json::jobject &parsed_flat(const size_t n)
+{
+    static json::jobject parsed;
+    static size_t parsed_size = 0;
+    if(parsed_size != n)
+    {
+        parsed = json::jobject::parse(cached(0, n, flat_object));
+        parsed_size = n;
+    }
+    return parsed;
+}
+
+static void merge_nested_members(const size_t n)
+{
+    static json::jobject target, patch;
+    static size_t merged_size = 0;
+    if(merged_size != n)
+    {
+        target = json::jobject();
+        target += json::kvp("inner", cached(0, n, flat_object));
+        std::string members = "{";
+        for(size_t i = 0; i < n; i += 2) members += (i > 0 ? ", \"" : "\"") + key_for(i) + "\": null, \"added_" + key_for(i) + "\": 1";
+        patch = json::jobject();
+        patch += json::kvp("inner", members + "}");
+        merged_size = n;
+    }
+    json::jobject result(target);
+    result.merge_patch(patch);
+    sink += result.as_string().size();
+}
+
+static void serialize_flat(const size_t n)
+{
+    sink += parsed_flat(n).as_string().size();
+}
+
+static void serialize_nested(const size_t depth)
+{
+    sink += parsed_nested(depth).as_string().size();
+}
+
+static void pretty_flat(const size_t n)
+{
+    sink += parsed_flat(n).pretty().size();
+}
+
+static void pretty_nested(const size_t depth)
+{
+    sink += parsed_nested(depth).pretty().size();
+}
+
+static void read_nested(const size_t depth)
+{
+    const std::string &input = cached(1, depth, nested_object);
+    json::reader stream;
+    for(size_t i = 0; i < input.size(); i++) stream.push(input[i]);
+    sink += stream.is_valid();
+}
+
+/* Seconds per call, repeating the workload until the measurement is long enough to trust, best of three */
+static double seconds_per_call(workload run, const size_t n)
+{
+    double best = 0;
+    for(int attempt = 0; attempt < 3; attempt++)
+    {
+        size_t calls = 0;
+        const clock_t start = clock();
+        clock_t elapsed = 0;
+        do
+        {
+            run(n);
+            calls++;
+            elapsed = clock() - start;
+        } while(elapsed < CLOCKS_PER_SEC / 50);
+        const double per_call = (double)elapsed / CLOCKS_PER_SEC / calls;
+        if(attempt == 0 || per_call < best) best = per_call;
+    }
+    return best;
+}
+
+static double growth(const char *name, workload run, const size_t n)
+{
+    double times[4];
+    for(size_t i = 0; i < 4; i++) times[i] = seconds_per_call(run, n << i);
+    const double exponent = log(times[3] / times[0]) / log(8.0);
+    printf("%-20s n=%-6lu %.3g %.3g %.3g %.3g s, exponent %.2f\n", name, (unsigned long)n, times[0], times[1], times[2], times[3], exponent);
+    return exponent;
+}
+
+int main(void)
+{
+    // Linear in the number of members
+    TEST_TRUE(growth("append_members", append_members, 4000) < 1.5);
+    TEST_TRUE(growth("parse_flat", parse_flat, 2000) < 1.5);
+    TEST_TRUE(growth("parse_packed", parse_packed, 2000) < 1.5);
+    TEST_TRUE(growth("lookup_members", lookup_members, 2000) < 1.5);
+    TEST_TRUE(growth("remove_members", remove_members, 2000) < 1.5);
+    TEST_TRUE(growth("serialize_flat", serialize_flat, 2000) < 1.5);
+    TEST_TRUE(growth("pretty_flat", pretty_flat, 2000) < 1.5);
+    TEST_TRUE(growth("compare_reordered", compare_reordered, 2000) < 1.5);
+    TEST_TRUE(growth("merge_nested_members", merge_nested_members, 2000) < 1.5);
+
+    // Linear in the depth of nesting
+    TEST_TRUE(growth("parse_nested", parse_nested, 200) < 1.5);
+    TEST_TRUE(growth("parse_nested_arrays", parse_nested_arrays, 200) < 1.5);
+    TEST_TRUE(growth("serialize_nested", serialize_nested, 2000) < 1.5);
+
+    // Removing keys one at a time moves the following entries on every removal
+    TEST_TRUE(growth("remove_members_singly", remove_members_singly, 250) < 2.5);
+
+    // Pretty printing is linear in its output, which grows quadratically with depth as every line is indented
+    TEST_TRUE(growth("pretty_nested", pretty_nested, 200) < 2.5);
+
+    // The reader hands each character down its chain of sub-readers, which is quadratic in depth by design
+    TEST_TRUE(growth("read_nested", read_nested, 50) < 2.5);
+}
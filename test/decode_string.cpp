@@ -0,0 +1,47 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+int main(void)
+{
+    // Basic multilingual plane
+    TEST_STRING_EQUAL(json::parsing::decode_string("\"\\u0041\"").c_str(), "A");
+    TEST_STRING_EQUAL(json::parsing::decode_string("\"caf\\u00E9\"").c_str(), "caf\xc3\xa9");
+    TEST_STRING_EQUAL(json::parsing::decode_string("\"\\u20ac5\"").c_str(), "\xe2\x82\xac" "5");
+
+    // Surrogate pairs
+    TEST_STRING_EQUAL(json::parsing::decode_string("\"\\ud83d\\ude00!\"").c_str(), "\xf0\x9f\x98\x80!");
+
+    // Unpaired surrogates are replaced
+    TEST_STRING_EQUAL(json::parsing::decode_string("\"\\ud83dx\"").c_str(), "\xef\xbf\xbdx");
+    TEST_STRING_EQUAL(json::parsing::decode_string("\"\\ude00\\n\"").c_str(), "\xef\xbf\xbd\n");
+
+    // Mixed escapes and long clean runs
+    TEST_STRING_EQUAL(
+        json::parsing::decode_string("\"a long run of plain text \\\"quoted\\\" \\/ and \\u0026 more\"").c_str(),
+        "a long run of plain text \"quoted\" / and & more");
+
+    // Appending overload returns the remainder
+    std::string output = "key=";
+    const char *remainder = json::parsing::decode_string("\"value\",next", output);
+    TEST_STRING_EQUAL(output.c_str(), "key=value");
+    TEST_STRING_EQUAL(remainder, ",next");
+
+    // Invalid input
+    bool thrown = false;
+    try { json::parsing::decode_string("\"\\u12g4\""); } catch(const json::parsing_error &) { thrown = true; }
+    TEST_TRUE(thrown);
+    thrown = false;
+    try { json::parsing::decode_string("\"unterminated"); } catch(const json::parsing_error &) { thrown = true; }
+    TEST_TRUE(thrown);
+
+    // Round trip through ASCII-only encoding
+    const char *utf8 = "\xce\xba\xce\xb1\xce\xbb\xce\xb7\xce\xbc\xe1\xbd\xb3\xcf\x81\xce\xb1 \xf0\x9f\x8c\x8d";
+    const std::string encoded = json::parsing::encode_string(utf8, true);
+    TEST_STRING_EQUAL(json::parsing::decode_string(encoded.c_str()).c_str(), utf8);
+
+    // Escaped solidus and unicode are accepted by the parser
+    json::jobject result = json::jobject::parse("{\"path\":\"a\\/b\",\"name\":\"\\u00e9t\\u00e9\"}");
+    TEST_STRING_EQUAL(result["path"].as_string().c_str(), "a/b");
+    TEST_STRING_EQUAL(result["name"].as_string().c_str(), "\xc3\xa9t\xc3\xa9");
+}
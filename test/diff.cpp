@@ -0,0 +1,63 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+/*! \brief Diffs two documents, checks that the patch transforms one into the other and returns the patch */
+std::string check_diff(const char *from, const char *to)
+{
+    const json::jobject source = json::jobject::parse(from);
+    const json::jobject target = json::jobject::parse(to);
+    const json::jobject patch = json::diff(source, target);
+    json::jobject result = source;
+    result.apply_patch(patch);
+    TEST_TRUE(result.equals(target));
+    return patch.as_string();
+}
+
+int main(void)
+{
+    // Identical documents produce an empty patch, regardless of member order and number spelling
+    TEST_STRING_EQUAL(check_diff("{\"a\": 1, \"b\": [1, 2]}", "{\"b\": [1.0, 2], \"a\": 1}").c_str(), "[]");
+
+    // Object members are matched by key
+    TEST_STRING_EQUAL(check_diff("{\"a\": 1, \"b\": 2, \"c\": 3}", "{\"a\": 1, \"c\": 4, \"d\": 5}").c_str(),
+        "[{\"op\":\"remove\",\"path\":\"\\/b\"},{\"op\":\"replace\",\"path\":\"\\/c\",\"value\":4},{\"op\":\"add\",\"path\":\"\\/d\",\"value\":5}]");
+
+    // Nested changes produce operations at the deepest differing path
+    TEST_STRING_EQUAL(check_diff(
+        "{\"config\": {\"net\": {\"ssid\": \"home\", \"retries\": 3}, \"log\": {\"level\": \"info\"}}}",
+        "{\"config\": {\"net\": {\"ssid\": \"home\", \"retries\": 5}, \"log\": {\"level\": \"info\"}}}").c_str(),
+        "[{\"op\":\"replace\",\"path\":\"\\/config\\/net\\/retries\",\"value\":5}]");
+
+    // Keys are escaped in paths
+    TEST_STRING_EQUAL(check_diff("{\"a/b\": {\"c~d\": 1}}", "{\"a/b\": {\"c~d\": 2}}").c_str(),
+        "[{\"op\":\"replace\",\"path\":\"\\/a~1b\\/c~0d\",\"value\":2}]");
+
+    // Array insertions and removals are aligned rather than rewriting every following element
+    TEST_STRING_EQUAL(check_diff("{\"l\": [1, 2, 3, 4, 5]}", "{\"l\": [1, 2, 9, 3, 4, 5]}").c_str(),
+        "[{\"op\":\"add\",\"path\":\"\\/l\\/2\",\"value\":9}]");
+    TEST_STRING_EQUAL(check_diff("{\"l\": [1, 2, 3, 4, 5]}", "{\"l\": [1, 3, 4, 5]}").c_str(),
+        "[{\"op\":\"remove\",\"path\":\"\\/l\\/1\"}]");
+    TEST_STRING_EQUAL(check_diff("{\"l\": [{\"id\": 1, \"v\": \"a\"}, {\"id\": 2, \"v\": \"b\"}]}", "{\"l\": [{\"id\": 1, \"v\": \"a\"}, {\"id\": 2, \"v\": \"c\"}]}").c_str(),
+        "[{\"op\":\"replace\",\"path\":\"\\/l\\/1\\/v\",\"value\":\"c\"}]");
+    check_diff("{\"l\": [1, 2, 3]}", "{\"l\": [4, 3, 2, 1, 0]}");
+    check_diff("{\"l\": [\"a\", \"b\", \"c\", \"d\"]}", "{\"l\": [\"x\", \"b\", \"y\", \"d\", \"z\"]}");
+    check_diff("{\"l\": []}", "{\"l\": [[], {}, null]}");
+
+    // Top-level arrays, type changes and whole-document replacement
+    TEST_STRING_EQUAL(check_diff("[1, 2]", "[1, 2, 3]").c_str(), "[{\"op\":\"add\",\"path\":\"\\/2\",\"value\":3}]");
+    TEST_STRING_EQUAL(check_diff("{\"a\": [1]}", "{\"a\": {\"b\": 1}}").c_str(), "[{\"op\":\"replace\",\"path\":\"\\/a\",\"value\":{\"b\":1}}]");
+    TEST_STRING_EQUAL(check_diff("{\"a\": 1}", "[1]").c_str(), "[{\"op\":\"replace\",\"path\":\"\",\"value\":[1]}]");
+
+    // Long arrays fall back to pairing elements by position
+    std::string from = "[";
+    std::string to = "[";
+    for(int i = 0; i < 1000; i++)
+    {
+        from += (i > 0 ? "," : "") + json::parsing::get_number_string(i, "%i");
+        to += (i > 0 ? "," : "") + json::parsing::get_number_string(i % 7 == 0 ? -i : i, "%i");
+    }
+    from += "]";
+    to += "]";
+    check_diff(("{\"l\": " + from + "}").c_str(), ("{\"l\": " + to + "}").c_str());
+}
@@ -0,0 +1,93 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+int main(void)
+{
+    const char *input =
+        "{ \"name\": \"caf\\u00e9\", \"count\": 42, \"ratio\": -1.5e2, \"flag\": true, \"none\": null,"
+        "  \"list\": [1, [2, 3], {\"inner\": \"value\"}], \"empty\": {}, \"quote\\\"key\": \"a\\nb\" }";
+
+    json::document doc;
+    doc.parse(input);
+    const json::document::value root = doc.root();
+    TEST_TRUE(root.is_object());
+    TEST_EQUAL(root.size(), 8);
+
+    // Scalars
+    TEST_STRING_EQUAL(root["name"].data(), "caf\xc3\xa9");
+    TEST_STRING_EQUAL(root["name"].as_string().c_str(), "caf\xc3\xa9");
+    TEST_EQUAL((int)root["count"], 42);
+    TEST_TRUE((double)root["ratio"] == -150.0);
+    TEST_TRUE(root["flag"].is_true());
+    TEST_TRUE(root["none"].is_null());
+    TEST_STRING_EQUAL(root["quote\"key"].data(), "a\nb");
+    TEST_FALSE(root.has_key("missing"));
+    bool thrown = false;
+    try { root.get("missing"); } catch(const json::invalid_key &) { thrown = true; }
+    TEST_TRUE(thrown);
+
+    // Nested values
+    const json::document::value list = root["list"];
+    TEST_TRUE(list.is_array());
+    TEST_EQUAL(list.size(), 3);
+    TEST_EQUAL((int)list.array(1).array(0), 2);
+    TEST_STRING_EQUAL(list.array(2)["inner"].data(), "value");
+    TEST_STRING_EQUAL(list.array(1).as_string().c_str(), "[2, 3]");
+    TEST_EQUAL(root["empty"].size(), 0);
+    TEST_FALSE(root["empty"].first().exists());
+
+    // Iteration
+    size_t members = 0;
+    for(json::document::value member = root.first(); member.exists(); member = member.next()) members++;
+    TEST_EQUAL(members, root.size());
+    TEST_STRING_EQUAL(root.first().key(), "name");
+
+    // Conversion to a modifiable object
+    json::jobject copy = root.as_object();
+    TEST_TRUE(copy == json::jobject::parse(input));
+
+    // Invalid input
+    const char *invalid[] = { "", "{", "[1,]", "{\"a\" 1}", "[01]", "tru", "\"open", "[1] 2", "{\"a\":1,}", "-" };
+    for(size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+    {
+        thrown = false;
+        try { doc.parse(invalid[i]); } catch(const json::parsing_error &) { thrown = true; }
+        TEST_TRUE(thrown);
+    }
+    thrown = false;
+    try { doc.parse("[\"\xff\"]", true); } catch(const json::invalid_utf8 &) { thrown = true; }
+    TEST_TRUE(thrown);
+
+    // Documents sharing a caller-supplied arena
+    char buffer[256];
+    json::arena memory(buffer, sizeof(buffer), 64);
+    {
+        json::document first(memory);
+        json::document second(memory);
+        first.parse("[1,2,3]");
+        second.parse("{\"a\":\"a string long enough to spill out of the buffer and into the heap\"}");
+        TEST_EQUAL((int)first.root().array(2), 3);
+        TEST_STRING_EQUAL(second.root()["a"].data(), "a string long enough to spill out of the buffer and into the heap");
+        TEST_TRUE(memory.used() > 0);
+        TEST_TRUE(memory.capacity() > sizeof(buffer));
+    }
+    memory.reset();
+    TEST_EQUAL(memory.used(), 0);
+    TEST_EQUAL(memory.capacity(), sizeof(buffer));
+
+    // Large documents spanning many chunks
+    std::string large = "[";
+    for(int i = 0; i < 1000; i++)
+    {
+        if(i > 0) large += ",";
+        large += "{\"id\":" + json::parsing::get_number_string(i, "%i") + ",\"tag\":\"item\"}";
+    }
+    large += "]";
+    json::document big(256);
+    big.parse(large);
+    TEST_EQUAL(big.root().size(), 1000);
+    TEST_EQUAL((int)big.root().array(999)["id"], 999);
+    big.clear();
+    TEST_EQUAL(big.get_arena().used(), 0);
+}
@@ -0,0 +1,52 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+int main(void)
+{
+    // Control characters without a short escape
+    std::string result = json::parsing::encode_string("a\x01z\x1f");
+    TEST_STRING_EQUAL(result.c_str(), "\"a\\u0001z\\u001f\"");
+
+    // Escapes at every position of a string longer than a machine word
+    const std::string clean = "abcdefghijklmnopqrstuvwxyz0123456789";
+    for (size_t i = 0; i < clean.size(); i++)
+    {
+        std::string input = clean;
+        input[i] = '"';
+        std::string expected = "\"" + clean.substr(0, i) + "\\\"" + clean.substr(i + 1) + "\"";
+        result = json::parsing::encode_string(input.c_str());
+        TEST_STRING_EQUAL(result.c_str(), expected.c_str());
+        input[i] = '\n';
+        expected = "\"" + clean.substr(0, i) + "\\n" + clean.substr(i + 1) + "\"";
+        result = json::parsing::encode_string(input.c_str());
+        TEST_STRING_EQUAL(result.c_str(), expected.c_str());
+    }
+
+    // Appending to an existing string with an explicit length
+    result = "prefix:";
+    const char embedded[] = { 'a', '\0', 'b' };
+    json::parsing::encode_string(embedded, sizeof(embedded), result);
+    TEST_STRING_EQUAL(result.c_str(), "prefix:\"a\\u0000b\"");
+
+    // UTF-8 is passed through by default
+    const char *utf8 = "caf\xc3\xa9 \xf0\x9f\x98\x80";
+    result = json::parsing::encode_string(utf8);
+    TEST_STRING_EQUAL(result.c_str(), "\"caf\xc3\xa9 \xf0\x9f\x98\x80\"");
+
+    // ASCII-only output escapes non-ASCII characters, using surrogate pairs when needed
+    result = json::parsing::encode_string(utf8, true);
+    TEST_STRING_EQUAL(result.c_str(), "\"caf\\u00e9 \\ud83d\\ude00\"");
+    result = json::parsing::encode_string("\xe2\x82\xac and a long ASCII tail to scan", true);
+    TEST_STRING_EQUAL(result.c_str(), "\"\\u20ac and a long ASCII tail to scan\"");
+
+    // Invalid UTF-8 is escaped as Latin-1 in ASCII-only mode
+    result = json::parsing::encode_string("\xff\xc3", true);
+    TEST_STRING_EQUAL(result.c_str(), "\"\\u00ff\\u00c3\"");
+
+    // Keys are escaped when serializing
+    json::jobject obj;
+    obj["quote\"key"] = "line\nbreak";
+    TEST_STRING_EQUAL(obj.as_string().c_str(), "{\"quote\\\"key\":\"line\\nbreak\"}");
+    TEST_STRING_EQUAL(obj.pretty().c_str(), "{\n\t\"quote\\\"key\": \"line\\nbreak\"\n}");
+}
@@ -0,0 +1,106 @@
+#include "json.h"
+#include "test.h"
+
+bool equal(const char *lhs, const char *rhs, const bool ignore_order = true)
+{
+	return json::parsing::equal(lhs, rhs, ignore_order);
+}
+
+int main(void)
+{
+	// Numbers are compared by value
+	TEST_TRUE(equal("1", "1.0"));
+	TEST_TRUE(equal("1.0", "1e0"));
+	TEST_TRUE(equal("100", "1E2"));
+	TEST_TRUE(equal("0.0012", "12e-4"));
+	TEST_TRUE(equal("-0", "0.000"));
+	TEST_TRUE(equal("123.4500", "1.2345e+2"));
+	TEST_FALSE(equal("1", "-1"));
+	TEST_FALSE(equal("1", "10"));
+	TEST_FALSE(equal("12345678901234567890", "12345678901234567891"));
+
+	// Strings are compared by decoded content
+	TEST_TRUE(equal("\"hello\"", "\"hello\""));
+	TEST_TRUE(equal("\"A\\/\"", "\"\\u0041/\""));
+	TEST_TRUE(equal("\"caf\xc3\xa9\"", "\"caf\\u00e9\""));
+	TEST_FALSE(equal("\"hello\"", "\"hell\""));
+	TEST_FALSE(equal("\"hello\"", "\"hello!\""));
+
+	// Literals and type mismatches
+	TEST_TRUE(equal("true", "true"));
+	TEST_TRUE(equal("null", " null"));
+	TEST_FALSE(equal("true", "false"));
+	TEST_FALSE(equal("null", "0"));
+	TEST_FALSE(equal("\"1\"", "1"));
+
+	// Arrays are ordered
+	TEST_TRUE(equal("[1, 2, [3]]", "[1.0,2,[3e0]]"));
+	TEST_FALSE(equal("[1,2]", "[2,1]"));
+	TEST_FALSE(equal("[1,2]", "[1,2,3]"));
+	TEST_FALSE(equal("[]", "[1]"));
+	TEST_TRUE(equal("[ ]", "[]"));
+
+	// Objects ignore order unless requested
+	TEST_TRUE(equal("{\"a\":1,\"b\":{\"c\":[1,{\"d\":2,\"e\":3}]}}", "{\"b\":{\"c\":[1,{\"e\":3,\"d\":2.0}]},\"a\":1}"));
+	TEST_FALSE(equal("{\"a\":1,\"b\":2}", "{\"b\":2,\"a\":1}", false));
+	TEST_TRUE(equal("{\"a\":1,\"b\":2}", "{ \"a\" : 1 , \"b\" : 2 }", false));
+	TEST_FALSE(equal("{\"a\":1,\"b\":2}", "{\"a\":1,\"c\":2}"));
+	TEST_FALSE(equal("{\"a\":1}", "{\"a\":1,\"b\":2}"));
+	TEST_FALSE(equal("{\"a\":1,\"b\":2}", "{\"a\":1}"));
+	TEST_FALSE(equal("{\"a\":1,\"b\":2}", "{\"b\":2,\"a\":3}"));
+	TEST_TRUE(equal("{}", "{ }"));
+
+	// Duplicated keys are matched once each, consistent with hashing
+	TEST_FALSE(equal("{\"a\":1,\"a\":1}", "{\"a\":1,\"b\":2}"));
+	TEST_FALSE(equal("{\"a\":1,\"b\":2}", "{\"a\":1,\"a\":1}"));
+	TEST_TRUE(equal("{\"a\":1,\"a\":2}", "{\"a\":2,\"a\":1}"));
+	TEST_NOT_EQUAL(json::parsing::hash("{\"a\":1,\"a\":1}"), json::parsing::hash("{\"a\":1,\"b\":2}"));
+
+	// Malformed input is not equal
+	TEST_FALSE(equal("[1,2", "[1,2"));
+	TEST_FALSE(equal("{\"a\":", "{\"a\":"));
+	TEST_FALSE(equal("", ""));
+	TEST_FALSE(equal("\"\\x\"", "\"\\x\""));
+	TEST_FALSE(equal("{\"\\u00\":1}", "{\"\\u00\":1}"));
+
+	// Large objects in a different order are matched through an index of their keys
+	std::string forward = "{", backward = "{";
+	for(int i = 0; i < 1000; i++)
+	{
+		char member[32];
+		snprintf(member, sizeof(member), "\"k%d\":%d", i, i % 3);
+		forward += std::string(i > 0 ? "," : "") + member;
+		snprintf(member, sizeof(member), "\"k%d\":%d", 999 - i, (999 - i) % 3);
+		backward += std::string(i > 0 ? "," : "") + member;
+	}
+	forward += "}";
+	backward += "}";
+	TEST_TRUE(equal(forward.c_str(), backward.c_str()));
+	TEST_TRUE(equal(forward.c_str(), forward.c_str()));
+	TEST_FALSE(equal(forward.c_str(), backward.c_str(), false));
+	const std::string half = forward.substr(0, forward.find(",\"k500\"")) + "," + backward.substr(1, backward.find(",\"k499\"") - 1) + "}";
+	TEST_TRUE(equal(forward.c_str(), half.c_str()));
+	TEST_TRUE(equal(half.c_str(), forward.c_str()));
+	std::string changed = backward;
+	changed.replace(changed.find("\"k500\":2"), 8, "\"k500\":1");
+	TEST_FALSE(equal(forward.c_str(), changed.c_str()));
+	changed = backward;
+	changed.replace(changed.find("\"k500\":2"), 8, "\"k999\":0");
+	TEST_FALSE(equal(forward.c_str(), changed.c_str()));
+
+	// Object comparison
+	json::jobject lhs = json::jobject::parse("{\"x\":1.0,\"y\":[1,2],\"z\":{\"k\":\"v\"}}");
+	json::jobject rhs = json::jobject::parse("{\"z\":{\"k\":\"v\"},\"y\":[1e0,2],\"x\":1}");
+	TEST_TRUE(lhs == rhs);
+	TEST_FALSE(lhs != rhs);
+	TEST_TRUE(lhs.equals(rhs));
+	TEST_FALSE(lhs.equals(rhs, false));
+	rhs["y"] = "changed";
+	TEST_FALSE(lhs == rhs);
+	TEST_FALSE(json::jobject::parse("[1,2]") == json::jobject::parse("{\"a\":1,\"b\":2}"));
+	TEST_FALSE(json::jobject::parse("[1,2]") == json::jobject::parse("[2,1]"));
+	TEST_TRUE(json::jobject::parse("[1,2]") == json::jobject::parse("[1.0,2]"));
+
+	// Duplicated keys within nested objects
+	TEST_FALSE(json::jobject::parse("{\"x\":{\"a\":1,\"a\":1}}") == json::jobject::parse("{\"x\":{\"a\":1,\"b\":2}}"));
+}
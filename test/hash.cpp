@@ -0,0 +1,76 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+int main(void)
+{
+    // Equal values hash equally regardless of representation
+    TEST_TRUE(json::parsing::hash("1.0") == json::parsing::hash("1e0"));
+    TEST_TRUE(json::parsing::hash("-0.25") == json::parsing::hash("-2.5E-1"));
+    TEST_TRUE(json::parsing::hash("0") == json::parsing::hash("-0.0"));
+    TEST_TRUE(json::parsing::hash("\"caf\\u00e9\"") == json::parsing::hash("\"caf\xc3\xa9\""));
+    TEST_TRUE(json::parsing::hash(" [ 1 , true , null ] ") == json::parsing::hash("[1,true,null]"));
+
+    // Different values hash differently
+    TEST_TRUE(json::parsing::hash("1") != json::parsing::hash("2"));
+    TEST_TRUE(json::parsing::hash("10") != json::parsing::hash("1"));
+    TEST_TRUE(json::parsing::hash("\"1\"") != json::parsing::hash("1"));
+    TEST_TRUE(json::parsing::hash("true") != json::parsing::hash("false"));
+    TEST_TRUE(json::parsing::hash("[1,2]") != json::parsing::hash("[2,1]"));
+    TEST_TRUE(json::parsing::hash("[[1],2]") != json::parsing::hash("[1,[2]]"));
+    TEST_TRUE(json::parsing::hash("\"a long string spanning words\"") != json::parsing::hash("\"a long string spanning wordz\""));
+
+    // Member order matters only when requested
+    const char *ordered = "{\"a\":1,\"b\":[2,3],\"c\":{\"d\":null}}";
+    const char *reordered = "{\"c\":{\"d\":null},\"b\":[2,3],\"a\":1}";
+    TEST_TRUE(json::parsing::hash(ordered) == json::parsing::hash(reordered));
+    TEST_TRUE(json::parsing::hash(ordered, false) != json::parsing::hash(reordered, false));
+    TEST_TRUE(json::parsing::hash("{\"a\":1,\"b\":2}") != json::parsing::hash("{\"a\":2,\"b\":1}"));
+
+    // Objects hash the same as their serialized form
+    json::jobject obj = json::jobject::parse(ordered);
+    TEST_TRUE(obj.hash() == json::parsing::hash(ordered));
+    TEST_TRUE(obj.hash(false) == json::parsing::hash(ordered, false));
+    TEST_TRUE(obj["b"].hash() == json::parsing::hash("[2,3]"));
+    json::jobject array = json::jobject::parse("[\"x\",1.5,{}]");
+    TEST_TRUE(array.hash() == json::parsing::hash("[\"x\",15e-1,{}]"));
+
+    // Cached hashes are invalidated by modification
+    const uint64_t before = obj.hash();
+    obj["a"] = 2;
+    TEST_TRUE(obj.hash() != before);
+    TEST_TRUE(obj.hash() == json::parsing::hash(obj.as_string().c_str()));
+    obj["a"] = 1;
+    TEST_TRUE(obj.hash() == before);
+    obj.remove("c");
+    TEST_TRUE(obj.hash() == json::parsing::hash("{\"a\":1,\"b\":[2,3]}"));
+
+    // Copies build their own cache, and assignment discards the previous one
+    json::jobject copy = obj;
+    TEST_TRUE(copy.hash() == obj.hash());
+    copy.clear();
+    TEST_TRUE(copy.hash() == json::parsing::hash("{}"));
+    copy = obj;
+    TEST_TRUE(copy.hash() == obj.hash());
+
+    // The cache lives outside the object, so objects stay small
+    TEST_TRUE(sizeof(json::jobject) <= sizeof(std::vector<json::kvp>) + 3 * sizeof(void*));
+
+    // Large objects keep finding keys through copies and moves
+    json::jobject large;
+    for(int i = 0; i < 100; i++) large["key" + json::parsing::get_number_string(i, "%i")] = i;
+    TEST_TRUE(large.has_key("key99"));
+    const uint64_t large_hash = large.hash();
+    json::jobject large_copy(large);
+    TEST_TRUE(large_copy.has_key("key50"));
+    TEST_FALSE(large_copy.has_key("key100"));
+    TEST_TRUE(large_copy.hash() == large_hash);
+    #if JSON_HAS_CXX11
+    json::jobject moved(std::move(large_copy));
+    TEST_TRUE(moved.has_key("key50"));
+    TEST_TRUE(moved.hash() == large_hash);
+    large_copy = std::move(moved);
+    TEST_TRUE(large_copy.has_key("key0"));
+    TEST_TRUE(large_copy.hash() == large_hash);
+    #endif
+}
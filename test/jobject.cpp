@@ -176,4 +176,18 @@ int main(void)
 	// Test copy constructor
 	json::jobject copy(test);
 	TEST_STRING_EQUAL(copy.as_string().c_str(), test.as_string().c_str());
+
+	// Removing several keys at once keeps the order of the remaining entries
+	json::jobject several = json::jobject::parse("{\"a\":1,\"b\":2,\"c\":3,\"d\":4}");
+	json::key_list_t removed;
+	removed.push_back("c");
+	removed.push_back("missing");
+	removed.push_back("a");
+	removed.push_back("c");
+	several.remove(removed);
+	TEST_STRING_EQUAL(several.as_string().c_str(), "{\"b\":2,\"d\":4}");
+	TEST_FALSE(several.has_key("a"));
+	TEST_TRUE(several.has_key("d"));
+	several.remove(json::key_list_t());
+	TEST_EQUAL(several.size(), 2);
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+std::string patched(const char *document, const char *patch)
+{
+    json::jobject result = json::jobject::parse(document);
+    result.apply_patch(patch);
+    return result.as_string();
+}
+
+size_t failed_operation(json::jobject &document, const char *patch)
+{
+    try
+    {
+        document.apply_patch(patch);
+    }
+    catch(const json::patch_error &error)
+    {
+        return error.operation;
+    }
+    return (size_t)-1;
+}
+
+int main(void)
+{
+    // Examples from RFC 6902, appendix A
+    TEST_STRING_EQUAL(patched("{\"foo\": \"bar\"}", "[{\"op\": \"add\", \"path\": \"/baz\", \"value\": \"qux\"}]").c_str(),
+        "{\"foo\":\"bar\",\"baz\":\"qux\"}");
+    TEST_STRING_EQUAL(patched("{\"foo\": [\"bar\", \"baz\"]}", "[{\"op\": \"add\", \"path\": \"/foo/1\", \"value\": \"qux\"}]").c_str(),
+        "{\"foo\":[\"bar\",\"qux\",\"baz\"]}");
+    TEST_STRING_EQUAL(patched("{\"baz\": \"qux\", \"foo\": \"bar\"}", "[{\"op\": \"remove\", \"path\": \"/baz\"}]").c_str(),
+        "{\"foo\":\"bar\"}");
+    TEST_STRING_EQUAL(patched("{\"foo\": [\"bar\", \"qux\", \"baz\"]}", "[{\"op\": \"remove\", \"path\": \"/foo/1\"}]").c_str(),
+        "{\"foo\":[\"bar\",\"baz\"]}");
+    TEST_STRING_EQUAL(patched("{\"baz\": \"qux\", \"foo\": \"bar\"}", "[{\"op\": \"replace\", \"path\": \"/baz\", \"value\": \"boo\"}]").c_str(),
+        "{\"baz\":\"boo\",\"foo\":\"bar\"}");
+    TEST_STRING_EQUAL(patched(
+        "{\"foo\": {\"bar\": \"baz\", \"waldo\": \"fred\"}, \"qux\": {\"corge\": \"grault\"}}",
+        "[{\"op\": \"move\", \"from\": \"/foo/waldo\", \"path\": \"/qux/thud\"}]").c_str(),
+        "{\"foo\":{\"bar\":\"baz\"},\"qux\":{\"corge\":\"grault\",\"thud\":\"fred\"}}");
+    TEST_STRING_EQUAL(patched("{\"foo\": [\"all\", \"grass\", \"cows\", \"eat\"]}",
+        "[{\"op\": \"move\", \"from\": \"/foo/1\", \"path\": \"/foo/3\"}]").c_str(),
+        "{\"foo\":[\"all\",\"cows\",\"eat\",\"grass\"]}");
+    TEST_STRING_EQUAL(patched("{\"foo\": \"bar\"}", "[{\"op\": \"add\", \"path\": \"/child\", \"value\": {\"grandchild\": {}}}]").c_str(),
+        "{\"foo\":\"bar\",\"child\":{\"grandchild\":{}}}");
+    TEST_STRING_EQUAL(patched("{\"foo\": [\"bar\"]}", "[{\"op\": \"add\", \"path\": \"/foo/-\", \"value\": [\"abc\", \"def\"]}]").c_str(),
+        "{\"foo\":[\"bar\",[\"abc\",\"def\"]]}");
+    TEST_STRING_EQUAL(patched("{\"foo\": [\"bar\"]}", "[{\"op\": \"copy\", \"from\": \"/foo/0\", \"path\": \"/foo/-\"}]").c_str(),
+        "{\"foo\":[\"bar\",\"bar\"]}");
+
+    // Escaped keys, empty containers and nested objects
+    TEST_STRING_EQUAL(patched("{\"a\": {\"b/c\": {}, \"d\": []}}",
+        "[{\"op\": \"add\", \"path\": \"/a/b~1c/x~0y\", \"value\": 1}, {\"op\": \"add\", \"path\": \"/a/d/0\", \"value\": true}]").c_str(),
+        "{\"a\":{\"b/c\":{\"x~y\":1},\"d\":[true]}}");
+    TEST_STRING_EQUAL(patched("{\"a\": {\"only\": 1}}", "[{\"op\": \"remove\", \"path\": \"/a/only\"}]").c_str(), "{\"a\":{}}");
+    TEST_STRING_EQUAL(patched("{\"a\": [1, 2, 3]}", "[{\"op\": \"remove\", \"path\": \"/a/2\"}]").c_str(), "{\"a\":[1,2]}");
+
+    // Top-level arrays and whole-document replacement
+    TEST_STRING_EQUAL(patched("[1, 2]", "[{\"op\": \"add\", \"path\": \"/0\", \"value\": 0}, {\"op\": \"replace\", \"path\": \"/2\", \"value\": 3}]").c_str(),
+        "[0,1,3]");
+    TEST_STRING_EQUAL(patched("{\"a\": 1}", "[{\"op\": \"replace\", \"path\": \"\", \"value\": [true]}]").c_str(), "[true]");
+
+    // Tests compare values structurally
+    json::jobject document = json::jobject::parse("{\"a\": {\"x\": 1, \"y\": [1.0, \"s\"]}, \"b\": null}");
+    const std::string original = document.as_string();
+    document.apply_patch("[{\"op\": \"test\", \"path\": \"/a\", \"value\": {\"y\": [1, \"s\"], \"x\": 1e0}}, {\"op\": \"test\", \"path\": \"/b\", \"value\": null}]");
+    TEST_STRING_EQUAL(document.as_string().c_str(), original.c_str());
+
+    // Failed patches leave the object unchanged
+    TEST_EQUAL(failed_operation(document, "[{\"op\": \"add\", \"path\": \"/c\", \"value\": 1}, {\"op\": \"test\", \"path\": \"/b\", \"value\": 1}]"), 1);
+    TEST_STRING_EQUAL(document.as_string().c_str(), original.c_str());
+    TEST_EQUAL(failed_operation(document,
+        "[{\"op\": \"remove\", \"path\": \"/a/y/0\"}, {\"op\": \"replace\", \"path\": \"/b\", \"value\": 2}, {\"op\": \"remove\", \"path\": \"/a\"}, {\"op\": \"remove\", \"path\": \"/a/x\"}]"), 3);
+    TEST_STRING_EQUAL(document.as_string().c_str(), original.c_str());
+    TEST_EQUAL(failed_operation(document, "[{\"op\": \"replace\", \"path\": \"\", \"value\": []}, {\"op\": \"copy\", \"from\": \"/a\", \"path\": \"/z\"}]"), 1);
+    TEST_STRING_EQUAL(document.as_string().c_str(), original.c_str());
+    TEST_EQUAL(failed_operation(document,
+        "[{\"op\": \"add\", \"path\": \"/a/y/1\", \"value\": {\"n\": [2]}}, {\"op\": \"replace\", \"path\": \"/a/y/1/n/0\", \"value\": \"long replacement\"},"
+        " {\"op\": \"remove\", \"path\": \"/a/x\"}, {\"op\": \"add\", \"path\": \"/a/w\", \"value\": 0}, {\"op\": \"move\", \"from\": \"/a/y/0\", \"path\": \"/a/y/-\"},"
+        " {\"op\": \"test\", \"path\": \"/a/w\", \"value\": 1}]"), 5);
+    TEST_STRING_EQUAL(document.as_string().c_str(), original.c_str());
+
+    // Moving a value onto itself requires the value to exist
+    document.apply_patch("[{\"op\": \"move\", \"from\": \"/a/x\", \"path\": \"/a/x\"}]");
+    TEST_STRING_EQUAL(document.as_string().c_str(), original.c_str());
+    TEST_EQUAL(failed_operation(document, "[{\"op\": \"move\", \"from\": \"/a/missing\", \"path\": \"/a/missing\"}]"), 0);
+    TEST_EQUAL(failed_operation(document, "[{\"op\": \"move\", \"from\": \"/c\", \"path\": \"/c\"}]"), 0);
+
+    // Invalid operations
+    TEST_EQUAL(failed_operation(document, "[{\"op\": \"add\", \"path\": \"/a/missing/x\", \"value\": 1}]"), 0);
+    TEST_EQUAL(failed_operation(document, "[{\"op\": \"add\", \"path\": \"/a/y/3\", \"value\": 1}]"), 0);
+    TEST_EQUAL(failed_operation(document, "[{\"op\": \"replace\", \"path\": \"/a/z\", \"value\": 1}]"), 0);
+    TEST_EQUAL(failed_operation(document, "[{\"op\": \"move\", \"from\": \"/a\", \"path\": \"/a/x/b\"}]"), 0);
+    TEST_EQUAL(failed_operation(document, "[{\"op\": \"add\", \"path\": \"/a\"}]"), 0);
+    TEST_EQUAL(failed_operation(document, "[{\"op\": \"test\", \"path\": \"/b\", \"value\": null}, {\"op\": \"frobnicate\", \"path\": \"/a\"}]"), 1);
+    TEST_EQUAL(failed_operation(document, "[{\"op\": \"remove\", \"path\": \"a\"}]"), 0);
+    TEST_EQUAL(failed_operation(document, "{\"op\": \"remove\", \"path\": \"/a\"}"), 0);
+    TEST_STRING_EQUAL(document.as_string().c_str(), original.c_str());
+}
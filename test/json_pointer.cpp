@@ -0,0 +1,62 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+bool missing(const json::jobject &source, const std::string &pointer)
+{
+    try { source.at_pointer(pointer); } catch(const json::invalid_key &) { return true; }
+    return false;
+}
+
+int main(void)
+{
+    // Examples from RFC 6901
+    const char *rfc =
+        "{ \"foo\": [\"bar\", \"baz\"], \"a/b\": 1, \"c%d\": 2, \"e^f\": 3, \"g|h\": 4,"
+        "  \"i\\\\j\": 5, \"k\\\"l\": 6, \" \": 7, \"m~n\": 8 }";
+    const json::jobject doc = json::jobject::parse(rfc);
+    TEST_STRING_EQUAL(doc.at_pointer("").as_string().c_str(), doc.as_string().c_str());
+    TEST_STRING_EQUAL(doc.at_pointer("/foo").as_string().c_str(), "[\"bar\",\"baz\"]");
+    TEST_STRING_EQUAL(doc.at_pointer("/foo/0").as_string().c_str(), "bar");
+    TEST_STRING_EQUAL(json::parsing::at_pointer("{\"x\": 1, \"\": 0}", "/").c_str(), "0");
+    TEST_EQUAL((int)doc.at_pointer("/a~1b"), 1);
+    TEST_EQUAL((int)doc.at_pointer("/c%d"), 2);
+    TEST_EQUAL((int)doc.at_pointer("/e^f"), 3);
+    TEST_EQUAL((int)doc.at_pointer("/g|h"), 4);
+    TEST_EQUAL((int)doc.at_pointer("/i\\j"), 5);
+    TEST_EQUAL((int)doc.at_pointer("/k\"l"), 6);
+    TEST_EQUAL((int)doc.at_pointer("/ "), 7);
+    TEST_EQUAL((int)doc.at_pointer("/m~0n"), 8);
+
+    // Nested paths through the serialized text
+    const json::jobject nested = json::jobject::parse(
+        "{\"a\": {\"skip\": {\"deep\": [1, 2, {\"x\": \"]}\"}]}, \"b\": [10, \"t\\\"ext\", [], {\"c\": {\"d\\u0065\": true}}, 14]}}");
+    TEST_TRUE(nested.at_pointer("/a/b/3/c/de").is_true());
+    TEST_EQUAL((int)nested.at_pointer("/a/b/4"), 14);
+    TEST_STRING_EQUAL(nested.at_pointer("/a/b/1").as_string().c_str(), "t\"ext");
+    TEST_STRING_EQUAL(nested.at_pointer("/a/skip/deep/2/x").as_string().c_str(), "]}");
+    TEST_STRING_EQUAL(nested.at_pointer("/a/b/3").as_string().c_str(), "{\"c\":{\"d\\u0065\":true}}");
+    TEST_STRING_EQUAL(json::parsing::at_pointer("[1, [2, 3]]", "/1/0").c_str(), "2");
+
+    // Root arrays
+    const json::jobject array = json::jobject::parse("[{\"id\": 1}, {\"id\": 2}]");
+    TEST_EQUAL((int)array.at_pointer("/1/id"), 2);
+
+    // Paths that do not refer to a value
+    TEST_TRUE(missing(nested, "/missing"));
+    TEST_TRUE(missing(nested, "/a/b/5"));
+    TEST_TRUE(missing(nested, "/a/b/-"));
+    TEST_TRUE(missing(nested, "/a/b/01"));
+    TEST_TRUE(missing(nested, "/a/b/0/x"));
+    TEST_TRUE(missing(nested, "/a/b/3/c/d"));
+    TEST_TRUE(missing(array, "/2"));
+    TEST_TRUE(missing(array, "/id"));
+
+    // Malformed pointers
+    bool thrown = false;
+    try { doc.at_pointer("foo"); } catch(const std::invalid_argument &) { thrown = true; }
+    TEST_TRUE(thrown);
+    thrown = false;
+    try { doc.at_pointer("/foo~2"); } catch(const std::invalid_argument &) { thrown = true; }
+    TEST_TRUE(thrown);
+}
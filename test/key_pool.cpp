@@ -0,0 +1,59 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+int main(void)
+{
+    // Interning returns stable, shared storage
+    json::key_pool pool;
+    const json::key_pool::key id = pool.intern("id");
+    const json::key_pool::key name = pool.intern(std::string("name"));
+    TEST_TRUE(id == pool.intern("id", 2));
+    TEST_TRUE(id != name);
+    TEST_STRING_EQUAL(id.c_str(), "id");
+    TEST_EQUAL(name.length(), 4);
+    TEST_EQUAL(pool.size(), 2);
+    TEST_FALSE(pool.find("missing").exists());
+    TEST_TRUE(pool.find("name") == name);
+
+    // Growing the table keeps previously interned keys
+    const char *first = id.c_str();
+    for(int i = 0; i < 200; i++) pool.intern("key" + json::parsing::get_number_string(i, "%i"));
+    TEST_EQUAL(pool.size(), 202);
+    TEST_TRUE(pool.intern("id").c_str() == first);
+    TEST_TRUE(pool.find("key150").exists());
+
+    // Documents sharing a pool reference the same keys
+    json::document records(4096, &pool);
+    records.parse("[{\"id\":1,\"name\":\"a\"},{\"id\":2,\"name\":\"b\"},{\"n\\u0061me\":\"c\",\"id\":3}]");
+    const json::document::value root = records.root();
+    TEST_TRUE(root.array(0).first().key() == root.array(1).first().key());
+    TEST_TRUE(root.array(0).first().key() == first);
+    TEST_TRUE(root.array(2).first().key() == name.c_str());
+    TEST_EQUAL(pool.size(), 202);
+
+    // Lookups by string and by interned key
+    TEST_EQUAL((int)root.array(2)["id"], 3);
+    TEST_STRING_EQUAL(root.array(2)[name].data(), "c");
+    TEST_TRUE(root.array(1).has_key(id));
+    TEST_FALSE(root.array(1).has_key("missing"));
+    TEST_FALSE(root.array(1).has_key(pool.intern("key7")));
+    bool thrown = false;
+    try { root.array(0).get(pool.find("key1")); } catch(const json::invalid_key &) { thrown = true; }
+    TEST_TRUE(thrown);
+
+    // Keys from another pool are compared by content
+    json::key_pool other;
+    TEST_STRING_EQUAL(root.array(1)[other.intern("name")].data(), "b");
+
+    // Documents without a pool accept interned keys as well
+    json::document plain;
+    plain.parse("{\"id\":7}");
+    TEST_EQUAL((int)plain.root()[id], 7);
+
+    // The global pool
+    TEST_TRUE(&json::key_pool::global() == &json::key_pool::global());
+    json::document global(4096, &json::key_pool::global());
+    global.parse("{\"shared\":true}");
+    TEST_TRUE(global.root().first().key() == json::key_pool::global().find("shared").c_str());
+}
@@ -0,0 +1,70 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+int main(void)
+{
+    const std::string input =
+        "{ \"header\": {\"skip\": [1, {\"x\": \"}]\"}, \"a\\\"b\"]}, \"id\" : 42, \"ratio\": 0.25,"
+        "  \"name\": \"caf\\u00e9\", \"tags\": [\"a\", [], {\"k\": null}, true, -7], \"ok\": false, \"id\": 43 }";
+    const json::lazy_value root(input.c_str());
+
+    // Member lookup skips earlier members, and the first duplicate wins
+    TEST_TRUE(root.is_object());
+    TEST_EQUAL((int)root["id"], 42);
+    TEST_EQUAL((double)root["ratio"], 0.25);
+    TEST_STRING_EQUAL(root["name"].as_string().c_str(), "caf\xc3\xa9");
+    TEST_STRING_EQUAL(root["name"].raw().c_str(), "\"caf\\u00e9\"");
+    TEST_STRING_EQUAL(root["header"]["skip"].array(1)["x"].as_string().c_str(), "}]");
+    TEST_TRUE(root["ok"].is_bool());
+    TEST_FALSE(root["ok"].is_true());
+    TEST_TRUE(root.has_key("tags"));
+    TEST_FALSE(root.has_key("missing"));
+    TEST_EQUAL(root.size(), 7);
+
+    // Views point into the input buffer
+    TEST_TRUE(root["tags"].data() > input.c_str() && root["tags"].data() < input.c_str() + input.size());
+    TEST_STRING_EQUAL(root["tags"].raw().c_str(), "[\"a\", [], {\"k\": null}, true, -7]");
+
+    // Array access
+    const json::lazy_value tags = root["tags"];
+    TEST_EQUAL(tags.size(), 5);
+    TEST_STRING_EQUAL(tags.array(0).as_string().c_str(), "a");
+    TEST_EQUAL(tags.array(1).size(), 0);
+    TEST_TRUE(tags.array(2)["k"].is_null());
+    TEST_TRUE(tags.array(3).is_true());
+    TEST_EQUAL((long)tags.array(4), -7);
+
+    // Iteration
+    std::string keys;
+    for(json::lazy_value member = root.first(); member.exists(); member = member.next()) keys += member.key() + ",";
+    TEST_STRING_EQUAL(keys.c_str(), "header,id,ratio,name,tags,ok,id,");
+    int count = 0;
+    for(json::lazy_value element = tags.first(); element.exists(); element = element.next()) count++;
+    TEST_EQUAL(count, 5);
+    TEST_FALSE(root.next().exists());
+
+    // Conversion to a full object
+    const json::jobject header = root["header"].as_object();
+    TEST_STRING_EQUAL(header.as_string().c_str(), "{\"skip\":[1,{\"x\":\"}]\"},\"a\\\"b\"]}");
+
+    // Errors
+    bool thrown = false;
+    try { root["missing"]; } catch(const json::invalid_key &) { thrown = true; }
+    TEST_TRUE(thrown);
+    thrown = false;
+    try { tags.array(5); } catch(const std::out_of_range &) { thrown = true; }
+    TEST_TRUE(thrown);
+    thrown = false;
+    try { tags["a"]; } catch(const std::invalid_argument &) { thrown = true; }
+    TEST_TRUE(thrown);
+    thrown = false;
+    try { (int)root["name"]; } catch(const std::invalid_argument &) { thrown = true; }
+    TEST_TRUE(thrown);
+    thrown = false;
+    try { json::lazy_value("{\"a\": 1, \"b\": [1, 2").get("c"); } catch(const json::parsing_error &) { thrown = true; }
+    TEST_TRUE(thrown);
+    thrown = false;
+    try { json::lazy_value().as_string(); } catch(const std::logic_error &) { thrown = true; }
+    TEST_TRUE(thrown);
+}
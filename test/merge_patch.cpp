@@ -0,0 +1,90 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+std::string merged(const char *target, const char *patch)
+{
+    json::jobject result = json::jobject::parse(target);
+    result.merge_patch(patch);
+    return result.as_string();
+}
+
+int main(void)
+{
+    // Examples from RFC 7386, appendix A
+    TEST_STRING_EQUAL(merged("{\"a\":\"b\"}", "{\"a\":\"c\"}").c_str(), "{\"a\":\"c\"}");
+    TEST_STRING_EQUAL(merged("{\"a\":\"b\"}", "{\"b\":\"c\"}").c_str(), "{\"a\":\"b\",\"b\":\"c\"}");
+    TEST_STRING_EQUAL(merged("{\"a\":\"b\"}", "{\"a\":null}").c_str(), "{}");
+    TEST_STRING_EQUAL(merged("{\"a\":\"b\",\"b\":\"c\"}", "{\"a\":null}").c_str(), "{\"b\":\"c\"}");
+    TEST_STRING_EQUAL(merged("{\"a\":[\"b\"]}", "{\"a\":\"c\"}").c_str(), "{\"a\":\"c\"}");
+    TEST_STRING_EQUAL(merged("{\"a\":\"c\"}", "{\"a\":[\"b\"]}").c_str(), "{\"a\":[\"b\"]}");
+    TEST_STRING_EQUAL(merged("{\"a\":{\"b\":\"c\"}}", "{\"a\":{\"b\":\"d\",\"c\":null}}").c_str(), "{\"a\":{\"b\":\"d\"}}");
+    TEST_STRING_EQUAL(merged("{\"a\":[{\"b\":\"c\"}]}", "{\"a\":[1]}").c_str(), "{\"a\":[1]}");
+    TEST_STRING_EQUAL(merged("[\"a\",\"b\"]", "[\"c\",\"d\"]").c_str(), "[\"c\",\"d\"]");
+    TEST_STRING_EQUAL(merged("{\"a\":\"b\"}", "[\"c\"]").c_str(), "[\"c\"]");
+    TEST_STRING_EQUAL(merged("{\"e\":null}", "{\"a\":1}").c_str(), "{\"e\":null,\"a\":1}");
+    TEST_STRING_EQUAL(merged("[1,2]", "{\"a\":\"b\",\"c\":null}").c_str(), "{\"a\":\"b\"}");
+    TEST_STRING_EQUAL(merged("{}", "{\"a\":{\"bb\":{\"ccc\":null}}}").c_str(), "{\"a\":{\"bb\":{}}}");
+
+    // Nested objects are merged in place, and removing members keeps the text well formed
+    TEST_STRING_EQUAL(merged(
+        "{\"title\":\"Goodbye!\",\"author\":{\"givenName\":\"John\",\"familyName\":\"Doe\"},\"tags\":[\"example\",\"sample\"],\"content\":\"This will be unchanged\"}",
+        "{\"title\":\"Hello!\",\"phoneNumber\":\"+01-123-456-7890\",\"author\":{\"familyName\":null},\"tags\":[\"example\"]}").c_str(),
+        "{\"title\":\"Hello!\",\"author\":{\"givenName\":\"John\"},\"tags\":[\"example\"],\"content\":\"This will be unchanged\",\"phoneNumber\":\"+01-123-456-7890\"}");
+    TEST_STRING_EQUAL(merged("{\"a\":{\"x\":1,\"y\":2,\"z\":3}}", "{\"a\":{\"x\":null,\"z\":null,\"w\":{\"k\":null,\"v\":1}}}").c_str(),
+        "{\"a\":{\"y\":2,\"w\":{\"v\":1}}}");
+    TEST_STRING_EQUAL(merged("{\"a\":{\"b\\\"\":{\"c\":1}}}", "{\"a\":{\"b\\\"\":{\"d\":[null]}}}").c_str(),
+        "{\"a\":{\"b\\\"\":{\"c\":1,\"d\":[null]}}}");
+
+    // Whitespace in the target is tolerated, and duplicated keys in nested text merge the first member of the target with the last of the patch
+    json::jobject spaced;
+    spaced += json::kvp("a", "{ \"x\" : 1 , \"y\" : { \"z\" : 2 } }");
+    spaced.merge_patch("{\"a\":{\"y\":{\"w\":3}}}");
+    TEST_STRING_EQUAL(spaced.as_string().c_str(), "{\"a\":{\"x\" : 1,\"y\":{\"z\" : 2,\"w\":3}}}");
+    json::jobject duplicated;
+    duplicated += json::kvp("a", "{\"k\":1,\"k\":2}");
+    json::jobject duplicating;
+    duplicating += json::kvp("a", "{\"k\":null,\"n\":1,\"n\":2}");
+    duplicated.merge_patch(duplicating);
+    TEST_STRING_EQUAL(duplicated.as_string().c_str(), "{\"a\":{\"k\":2,\"n\":2}}");
+
+    // Deep merge stores null values and overwrites existing members
+    json::jobject base = json::jobject::parse("{\"a\":{\"b\":1,\"c\":{\"d\":2}},\"e\":[1]}");
+    base.merge(json::jobject::parse("{\"a\":{\"c\":{\"f\":3},\"b\":null},\"e\":[2],\"g\":true}"));
+    TEST_STRING_EQUAL(base.as_string().c_str(), "{\"a\":{\"b\":null,\"c\":{\"d\":2,\"f\":3}},\"e\":[2],\"g\":true}");
+    base.merge(base);
+    TEST_STRING_EQUAL(base.as_string().c_str(), "{\"a\":{\"b\":null,\"c\":{\"d\":2,\"f\":3}},\"e\":[2],\"g\":true}");
+    base.merge("{\"e\":{\"h\":1}}");
+    TEST_STRING_EQUAL(base.as_string().c_str(), "{\"a\":{\"b\":null,\"c\":{\"d\":2,\"f\":3}},\"e\":{\"h\":1},\"g\":true}");
+    base.merge(std::string("{\"g\":false}"));
+    TEST_STRING_EQUAL(base.as_string().c_str(), "{\"a\":{\"b\":null,\"c\":{\"d\":2,\"f\":3}},\"e\":{\"h\":1},\"g\":false}");
+
+    // Large objects use the hashed key index, across appends, merges and removals
+    json::jobject large;
+    for(int i = 0; i < 200; i++) large["key" + json::parsing::get_number_string(i, "%i")] = i;
+    TEST_TRUE(large.has_key("key0"));
+    TEST_TRUE(large.has_key("key199"));
+    TEST_FALSE(large.has_key("key200"));
+    json::jobject overlay;
+    for(int i = 0; i < 200; i += 2) overlay["key" + json::parsing::get_number_string(i, "%i")].set_null();
+    overlay["key1"] = "one";
+    overlay["extra"] = "added";
+    large.merge_patch(overlay);
+    TEST_EQUAL(large.size(), 101);
+    TEST_FALSE(large.has_key("key0"));
+    TEST_FALSE(large.has_key("key198"));
+    TEST_STRING_EQUAL(large["key1"].as_string().c_str(), "one");
+    TEST_EQUAL((int)large["key199"], 199);
+    TEST_STRING_EQUAL(large["extra"].as_string().c_str(), "added");
+    large.remove("key3");
+    TEST_FALSE(large.has_key("key3"));
+    TEST_EQUAL((int)large["key5"], 5);
+    large["key3"] = 33;
+    TEST_EQUAL((int)large["key3"], 33);
+    TEST_EQUAL(large.size(), 101);
+
+    // Appending a conflicting key is still rejected
+    bool thrown = false;
+    try { large += json::kvp("key5", "1"); } catch(const json::parsing_error &) { thrown = true; }
+    TEST_TRUE(thrown);
+}
@@ -0,0 +1,62 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+int main(void)
+{
+#if JSON_HAS_CXX11
+	// Move construction leaves the source empty
+	json::jobject source = json::jobject::parse("{\"a\":1,\"b\":\"two\"}");
+	json::jobject moved(std::move(source));
+	TEST_EQUAL(moved.size(), 2);
+	TEST_EQUAL(source.size(), 0);
+	TEST_EQUAL((int)moved["a"], 1);
+
+	// Move assignment keeps the array flag
+	json::jobject array = json::jobject::parse("[1,2,3]");
+	json::jobject target;
+	target = std::move(array);
+	TEST_TRUE(target.is_array());
+	TEST_EQUAL(target.size(), 3);
+
+	// Moving values into an object
+	std::string payload(64, 'x');
+	payload = "\"" + payload + "\"";
+	json::jobject built;
+	built.set("payload", std::move(payload));
+	TEST_EQUAL(built["payload"].as_string().size(), 64);
+	built.set("payload", std::string("null"));
+	TEST_TRUE(built["payload"].is_null());
+
+	// Emplacing new entries
+	built.emplace("count", "3");
+	TEST_EQUAL((int)built["count"], 3);
+	bool thrown = false;
+	try { built.emplace("count", "4"); } catch(const json::parsing_error &) { thrown = true; }
+	TEST_TRUE(thrown);
+	TEST_EQUAL((int)built["count"], 3);
+	json::jobject list(true);
+	list.emplace("", "1");
+	list.emplace("", "2");
+	TEST_STRING_EQUAL(list.as_string().c_str(), "[1,2]");
+
+	// Appending an rvalue object moves its entries
+	json::jobject extra = json::jobject::parse("{\"c\":true}");
+	built += std::move(extra);
+	TEST_TRUE(built["c"].is_true());
+	json::jobject empty;
+	empty += json::jobject::parse("{\"d\":null}");
+	TEST_TRUE(empty["d"].is_null());
+#endif
+
+	// Appending an array to itself
+	json::jobject repeated = json::jobject::parse("[1,2]");
+	repeated += repeated;
+	TEST_STRING_EQUAL(repeated.as_string().c_str(), "[1,2,1,2]");
+
+	// Merging from a const object
+	const json::jobject left = json::jobject::parse("{\"x\":1}");
+	const json::jobject right = json::jobject::parse("{\"y\":2}");
+	const json::jobject merged = left + right;
+	TEST_EQUAL(merged.size(), 2);
+}
@@ -0,0 +1,82 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+int main(void)
+{
+    const char *input = "{ \"id\": 42, \"name\": \"caf\\u00e9\", \"tags\": [\"a\", \"b\"], \"nested\": {\"x\": null}, \"quote\\\"key\": true }";
+    const json::jobject source = json::jobject::parse(input);
+
+    // Parsing directly and packing an existing object produce the same layout
+    const json::packed_object parsed = json::packed_object::parse(input);
+    const json::packed_object packed(source);
+    TEST_EQUAL(parsed.size(), 5);
+    TEST_EQUAL(packed.size(), 5);
+    TEST_EQUAL(parsed.bytes(), packed.bytes());
+    TEST_FALSE(parsed.is_array());
+
+    // Serialization matches the unpacked object
+    TEST_STRING_EQUAL(parsed.as_string().c_str(), source.as_string().c_str());
+    TEST_TRUE(parsed.as_object() == source);
+
+    // Lookups
+    TEST_TRUE(parsed.has_key("name"));
+    TEST_TRUE(parsed.has_key("quote\"key"));
+    TEST_FALSE(parsed.has_key("missing"));
+    TEST_EQUAL((int)parsed["id"], 42);
+    TEST_STRING_EQUAL(parsed["name"].as_string().c_str(), "caf\xc3\xa9");
+    TEST_STRING_EQUAL(parsed["nested"].get("x").as_string().c_str(), "null");
+    TEST_STRING_EQUAL(parsed.get("tags").c_str(), "[\"a\",\"b\"]");
+    TEST_STRING_EQUAL(parsed.key(1).c_str(), "name");
+    TEST_EQUAL(parsed.list_keys().size(), 5);
+    bool thrown = false;
+    try { parsed.get("missing"); } catch(const json::invalid_key &) { thrown = true; }
+    TEST_TRUE(thrown);
+
+    // Arrays
+    const json::packed_object array = json::packed_object::parse("[1, \"two\", [3]]");
+    TEST_TRUE(array.is_array());
+    TEST_EQUAL(array.size(), 3);
+    TEST_EQUAL((int)array.array(0), 1);
+    TEST_STRING_EQUAL(array.array(1).as_string().c_str(), "two");
+    TEST_STRING_EQUAL(array.as_string().c_str(), "[1,\"two\",[3]]");
+    TEST_FALSE(array.has_key(""));
+    TEST_EQUAL(array.list_keys().size(), 0);
+
+    // Appending entries
+    json::packed_object built;
+    built += json::kvp("a", "1");
+    built += json::kvp("b", "\"x\"");
+    TEST_STRING_EQUAL(built.as_string().c_str(), "{\"a\":1,\"b\":\"x\"}");
+    thrown = false;
+    try { built += json::kvp("a", "2"); } catch(const json::parsing_error &) { thrown = true; }
+    TEST_TRUE(thrown);
+    thrown = false;
+    try { json::packed_object::parse("{\"a\":}"); } catch(const json::parsing_error &) { thrown = true; }
+    TEST_TRUE(thrown);
+    built.clear();
+    TEST_EQUAL(built.size(), 0);
+    TEST_STRING_EQUAL(built.as_string().c_str(), "{}");
+
+    // Large objects are indexed, including entries appended after a lookup and after clearing
+    for(int i = 0; i < 100; i++)
+    {
+        char key[16];
+        snprintf(key, sizeof(key), "k%d", i);
+        built += json::kvp(key, "1");
+        TEST_TRUE(built.has_key(key));
+    }
+    TEST_EQUAL(built.size(), 100);
+    TEST_TRUE(built.has_key("k0"));
+    TEST_FALSE(built.has_key("k100"));
+    thrown = false;
+    try { built += json::kvp("k42", "2"); } catch(const json::parsing_error &) { thrown = true; }
+    TEST_TRUE(thrown);
+    const json::packed_object copied = built;
+    TEST_TRUE(copied.has_key("k99"));
+    built.clear();
+    TEST_FALSE(built.has_key("k0"));
+    for(int i = 0; i < 20; i++) built += json::kvp(std::string(1, (char)('a' + i)), "1");
+    TEST_TRUE(built.has_key("t"));
+    TEST_FALSE(built.has_key("k0"));
+}
@@ -0,0 +1,76 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+#include <vector>
+
+std::vector<std::string> split(const char *paths)
+{
+    std::vector<std::string> result;
+    std::string current;
+    for(const char *index = paths; ; index++)
+    {
+        if(*index == ',' || *index == '\0') {
+            result.push_back(current);
+            current.clear();
+            if(*index == '\0') return result;
+        } else {
+            current += *index;
+        }
+    }
+}
+
+int main(void)
+{
+    const char *input =
+        "{\"ts\": 1700000000, \"level\": \"info\", \"user\": {\"id\": 7, \"name\": \"ada\", \"roles\": [\"admin\", \"dev\"]},"
+        " \"payload\": {\"user\": {\"name\": \"decoy\"}}, \"id\": \"req-1\", \"items\": [{\"sku\": \"a\"}, {\"sku\": \"b\"}], \"id\": \"dup\"}";
+
+    // Extraction into an object keyed by path
+    json::jobject result = json::project(input, split("id,user.name,ts,missing,user.missing"));
+    TEST_EQUAL(result.size(), 3);
+    TEST_STRING_EQUAL(result["id"].as_string().c_str(), "req-1");
+    TEST_STRING_EQUAL(result["user.name"].as_string().c_str(), "ada");
+    TEST_EQUAL((long)result["ts"], 1700000000L);
+    TEST_FALSE(result.has_key("missing"));
+
+    // Array indices and overlapping paths
+    result = json::project(std::string(input), split("items.1.sku,user.roles.0,user,user.id,items.5"));
+    TEST_EQUAL(result.size(), 4);
+    TEST_STRING_EQUAL(result["items.1.sku"].as_string().c_str(), "b");
+    TEST_STRING_EQUAL(result["user.roles.0"].as_string().c_str(), "admin");
+    TEST_EQUAL((int)result["user.id"], 7);
+    TEST_STRING_EQUAL(result["user"].as_object()["name"].as_string().c_str(), "ada");
+
+    // Views in path order, reusable across inputs
+    const json::projection fields(split("level,user.name,user.name,ts"));
+    TEST_EQUAL(fields.size(), 4);
+    TEST_STRING_EQUAL(fields.path(1).c_str(), "user.name");
+    std::vector<json::lazy_value> views;
+    fields.apply(input, views);
+    TEST_EQUAL(views.size(), 4);
+    TEST_STRING_EQUAL(views[0].as_string().c_str(), "info");
+    TEST_STRING_EQUAL(views[1].as_string().c_str(), "ada");
+    TEST_STRING_EQUAL(views[1].key().c_str(), "name");
+    TEST_TRUE(views[2].data() == views[1].data());
+    fields.apply("{\"user\": {\"n\\u0061me\": \"grace\"}, \"extra\": [1, 2, 3]}", views);
+    TEST_STRING_EQUAL(views[1].as_string().c_str(), "grace");
+    TEST_FALSE(views[0].exists());
+    TEST_FALSE(views[3].exists());
+
+    // The scan stops once every path is found, so malformed input after the last field is not examined
+    fields.apply("{\"level\": \"warn\", \"user\": {\"name\": \"x\"}, \"ts\": 1, \"junk\": ", views);
+    TEST_STRING_EQUAL(views[0].as_string().c_str(), "warn");
+    TEST_EQUAL((int)views[3], 1);
+
+    // Non-containers produce no matches
+    fields.apply("42", views);
+    TEST_FALSE(views[0].exists());
+
+    // Errors
+    bool thrown = false;
+    try { json::project("{\"a\": [1, 2", split("b")); } catch(const json::parsing_error &) { thrown = true; }
+    TEST_TRUE(thrown);
+    thrown = false;
+    try { json::projection(split("a,")); } catch(const std::invalid_argument &) { thrown = true; }
+    TEST_TRUE(thrown);
+}
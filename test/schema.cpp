@@ -0,0 +1,105 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+bool rejects(const char *definition)
+{
+    try
+    {
+        json::schema compiled(definition);
+    }
+    catch(const std::invalid_argument &)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main(void)
+{
+    const json::schema person(
+        "{\"type\":\"object\",\"required\":[\"name\",\"age\"],"
+        "\"properties\":{"
+            "\"name\":{\"type\":\"string\",\"minLength\":1,\"maxLength\":8},"
+            "\"age\":{\"type\":\"integer\",\"minimum\":0,\"exclusiveMaximum\":150},"
+            "\"tags\":{\"type\":\"array\",\"items\":{\"enum\":[\"a\",\"b\",{\"c\":[1,2]}]},\"maxItems\":3},"
+            "\"score\":{\"type\":[\"number\",\"null\"],\"maximum\":1}"
+        "}}");
+
+    // Valid documents
+    TEST_TRUE(person.validate("{\"name\":\"Ann\",\"age\":30}"));
+    TEST_TRUE(person.validate(" { \"age\" : 1.0e1 , \"name\" : \"\\u00e9t\\u00e9\", \"extra\": [true, {\"x\": null}] } "));
+    TEST_TRUE(person.validate("{\"name\":\"B\",\"age\":0,\"tags\":[\"b\",{\"c\":[1,2]}],\"score\":null}"));
+    TEST_TRUE(person.validate(std::string("{\"name\":\"\xce\xba\xce\xb1\xce\xbb\xce\xb7\xce\xbc\xe1\xbd\xb3\xcf\x81\xce\xb1\",\"age\":2,\"score\":0.5}")));
+
+    // Violations report the location of the value
+    std::string error;
+    TEST_FALSE(person.validate("{\"name\":\"Ann\"}", error));
+    TEST_STRING_EQUAL(error.c_str(), "Missing required property \"age\" at \"\"");
+    TEST_FALSE(person.validate("{\"name\":\"Ann\",\"age\":1.5}", error));
+    TEST_STRING_EQUAL(error.c_str(), "Expected an integer at \"/age\"");
+    TEST_FALSE(person.validate("{\"name\":\"Ann\",\"age\":150}", error));
+    TEST_STRING_EQUAL(error.c_str(), "Number is not below the exclusive maximum at \"/age\"");
+    TEST_FALSE(person.validate("{\"name\":\"\",\"age\":1}", error));
+    TEST_STRING_EQUAL(error.c_str(), "String is too short at \"/name\"");
+    TEST_FALSE(person.validate("{\"name\":\"Maximilian\",\"age\":1}", error));
+    TEST_STRING_EQUAL(error.c_str(), "String is too long at \"/name\"");
+    TEST_FALSE(person.validate("{\"name\":\"Ann\",\"age\":1,\"tags\":[\"a\",{\"c\":[2,1]}]}", error));
+    TEST_STRING_EQUAL(error.c_str(), "Value is not one of the enumerated values at \"/tags/1\"");
+    TEST_FALSE(person.validate("{\"name\":\"Ann\",\"age\":1,\"tags\":[\"a\",\"a\",\"a\",\"a\"]}", error));
+    TEST_STRING_EQUAL(error.c_str(), "Too many elements at \"/tags\"");
+    TEST_FALSE(person.validate("{\"name\":\"Ann\",\"age\":1,\"score\":\"high\"}", error));
+    TEST_STRING_EQUAL(error.c_str(), "Unexpected string at \"/score\"");
+    TEST_FALSE(person.validate("[]", error));
+    TEST_STRING_EQUAL(error.c_str(), "Unexpected array at \"\"");
+
+    // Grammar is checked alongside the schema, including unconstrained values
+    TEST_FALSE(person.validate("{\"name\":\"Ann\",\"age\":01}"));
+    TEST_FALSE(person.validate("{\"name\":\"Ann\",\"age\":1,}"));
+    TEST_FALSE(person.validate("{\"name\":\"Ann\",\"age\":1} x"));
+    TEST_FALSE(person.validate("{\"name\":\"Ann\",\"age\":1,\"extra\":[1 2]}"));
+    TEST_FALSE(person.validate("{\"name\":\"Ann\",\"age\":1,\"extra\":tru}"));
+    TEST_FALSE(person.validate("{\"name\":\"Ann\",\"age\":1,\"extra\":\"\\x\"}"));
+    TEST_FALSE(person.validate("{\"name\":\"Ann"));
+
+    // Boolean schemas and additionalProperties
+    TEST_TRUE(json::schema("true").validate("[1,{\"a\":null}]"));
+    TEST_FALSE(json::schema("false").validate("1"));
+    const json::schema closed("{\"properties\":{\"a/b\":{\"const\":1}},\"additionalProperties\":false}");
+    TEST_TRUE(closed.validate("{\"a/b\":1.0}"));
+    TEST_FALSE(closed.validate("{\"a/b\":2}", error));
+    TEST_STRING_EQUAL(error.c_str(), "Value is not one of the enumerated values at \"/a~1b\"");
+    TEST_FALSE(closed.validate("{\"a/b\":1,\"c\":1}", error));
+    TEST_STRING_EQUAL(error.c_str(), "Value is not allowed at \"/c\"");
+
+    // Schemas built from objects
+    json::jobject definition;
+    definition["type"] = "array";
+    definition["minItems"] = 2;
+    const json::schema pair(definition);
+    TEST_TRUE(pair.validate("[1,\"x\"]"));
+    TEST_FALSE(pair.validate("[1]"));
+    json::jobject instance = json::jobject::parse("[3,4,5]");
+    TEST_TRUE(pair.validate(instance));
+
+    // Enumerated and constant objects match regardless of member order
+    const json::schema choices("{\"enum\":[{\"a\":1,\"b\":2}]}");
+    TEST_TRUE(choices.validate("{\"b\":2,\"a\":1}"));
+    TEST_FALSE(choices.validate("{\"b\":2,\"a\":3}"));
+    const json::schema constant("{\"const\":{\"a\":1,\"b\":2}}");
+    TEST_TRUE(constant.validate("{\"b\":2.0,\"a\":1}"));
+    TEST_FALSE(constant.validate("{\"a\":1}"));
+
+#if JSON_HAS_CXX11
+    const json::schema code("{\"type\":\"string\",\"pattern\":\"^[A-Z]{2}-[0-9]+$\"}");
+    TEST_TRUE(code.validate("\"AB-12\""));
+    TEST_FALSE(code.validate("\"ab-12\""));
+    TEST_TRUE(rejects("{\"pattern\":\"[\"}"));
+#endif
+
+    // Malformed schemas
+    TEST_TRUE(rejects("{\"type\":\"text\"}"));
+    TEST_TRUE(rejects("{\"minItems\":-1}"));
+    TEST_TRUE(rejects("{\"required\":\"a\"}"));
+    TEST_TRUE(rejects("1"));
+}
@@ -0,0 +1,118 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+bool rejected(const std::string &input)
+{
+    try { json::snapshot opened(input.data(), input.size()); opened.root().as_string(); } catch(const json::parsing_error &) { return true; }
+    return false;
+}
+
+uint32_t word(const std::string &image, const size_t offset)
+{
+    uint32_t result = 0;
+    for(size_t i = 0; i < 4; i++) result |= (uint32_t)(unsigned char)image[offset + i] << (8 * i);
+    return result;
+}
+
+void set_word(std::string &image, const size_t offset, const uint32_t value)
+{
+    for(size_t i = 0; i < 4; i++) image[offset + i] = (char)(value >> (8 * i));
+}
+
+int main(void)
+{
+    const char *input =
+        "{\"zeta\": 1, \"alpha\": \"caf\\u00e9\", \"list\": [1.5, true, false, null, [], {}],"
+        " \"nested\": {\"b\": {\"c\": -42}}, \"mid\": \"x\", \"alpha\": \"duplicate\"}";
+    const std::string image = json::snapshot::create(input);
+    TEST_EQUAL(image.size() % 4, 0);
+    TEST_TRUE(memcmp(image.data(), "SJSN", 4) == 0);
+
+    // Reading in place
+    const json::snapshot snap(image.data(), image.size());
+    const json::snapshot::value root = snap.root();
+    TEST_TRUE(root.is_object());
+    TEST_EQUAL(root.size(), 6);
+    TEST_STRING_EQUAL(root["alpha"].data(), "caf\xc3\xa9");
+    TEST_EQUAL((int)root["zeta"], 1);
+    TEST_EQUAL((int)root["nested"]["b"]["c"], -42);
+    TEST_TRUE(root.has_key("mid"));
+    TEST_FALSE(root.has_key("missing"));
+    TEST_FALSE(root.has_key("alph"));
+    bool thrown = false;
+    try { root.get("zz"); } catch(const json::invalid_key &) { thrown = true; }
+    TEST_TRUE(thrown);
+
+    // Arrays
+    const json::snapshot::value list = root["list"];
+    TEST_TRUE(list.is_array());
+    TEST_EQUAL(list.size(), 6);
+    TEST_TRUE((double)list.array(0) == 1.5);
+    TEST_TRUE(list.array(1).is_true());
+    TEST_TRUE(list.array(2).is_bool());
+    TEST_FALSE(list.array(2).is_true());
+    TEST_TRUE(list.array(3).is_null());
+    TEST_EQUAL(list.array(4).size(), 0);
+    TEST_FALSE(list.array(5).first().exists());
+    thrown = false;
+    try { list.array(6); } catch(const std::out_of_range &) { thrown = true; }
+    TEST_TRUE(thrown);
+
+    // Iteration keeps the original order
+    const char *keys[] = { "zeta", "alpha", "list", "nested", "mid", "alpha" };
+    size_t count = 0;
+    for(json::snapshot::value member = root.first(); member.exists(); member = member.next())
+    {
+        TEST_STRING_EQUAL(member.key(), keys[count]);
+        count++;
+    }
+    TEST_EQUAL(count, 6);
+    TEST_NULL(root.key());
+    TEST_NULL(list.array(0).key());
+
+    // Serialization matches the parsed object
+    TEST_STRING_EQUAL(root["list"].as_string().c_str(), "[1.5,true,false,null,[],{}]");
+    TEST_STRING_EQUAL(root["nested"].as_string().c_str(), "{\"b\":{\"c\":-42}}");
+    const std::string escaped = json::snapshot::create("{\"a\":[1,{\"b\":\"\\n\"}]}");
+    TEST_TRUE(json::snapshot(escaped.data(), escaped.size()).root().as_object() == json::jobject::parse("{\"a\":[1,{\"b\":\"\\n\"}]}"));
+
+    // Snapshots of objects and scalar roots
+    json::jobject source;
+    source["id"] = 7;
+    source["name"] = "seven";
+    const std::string object_image = json::snapshot::create(source);
+    const json::snapshot from_object(object_image.data(), object_image.size());
+    TEST_TRUE(from_object.root().as_object() == source);
+    const std::string scalar_image = json::snapshot::create("\"text\"");
+    TEST_STRING_EQUAL(json::snapshot(scalar_image.data(), scalar_image.size()).root().data(), "text");
+
+    // Snapshots are position independent and may be followed by padding
+    std::string moved = "\x01\x02\x03\x04" + image + std::string(100, '\0');
+    const json::snapshot relocated(moved.data() + 4, moved.size() - 4);
+    TEST_STRING_EQUAL(relocated.root()["mid"].data(), "x");
+
+    // Invalid snapshots
+    TEST_TRUE(rejected(""));
+    TEST_TRUE(rejected("not a snapshot at all"));
+    TEST_TRUE(rejected(image.substr(0, image.size() - 4)));
+    std::string version = image;
+    version[4] = 2;
+    TEST_TRUE(rejected(version));
+    std::string corrupt = image;
+    corrupt[12] = (char)0xFF;
+    corrupt[13] = (char)0xFF;
+    TEST_TRUE(rejected(corrupt));
+
+    // Child offsets pointing back at an ancestor are rejected rather than followed
+    const std::string nested_image = json::snapshot::create("[[1]]");
+    const uint32_t outer = word(nested_image, 12);
+    const uint32_t inner = word(nested_image, outer + 8);
+    std::string cyclic = nested_image;
+    set_word(cyclic, outer + 8, outer);
+    TEST_TRUE(rejected(cyclic));
+    std::string ancestor = nested_image;
+    set_word(ancestor, inner + 8, outer);
+    TEST_TRUE(rejected(ancestor));
+    TEST_FALSE(rejected(nested_image));
+}
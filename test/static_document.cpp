@@ -0,0 +1,59 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+int main(void)
+{
+#if JSON_HAS_CXX14
+    // Parsed and compacted during compilation
+    constexpr auto defaults = json::make_static(
+        "{\n"
+        "    \"retries\": 3,\n"
+        "    \"ratio\" : -0.5e-3,\n"
+        "    \"hosts\": [ \"a\", \"b\\u0041\" ],\n"
+        "    \"tls\": { \"enabled\": true, \"ca\": null }\n"
+        "}");
+    static_assert(defaults.length() == 86, "document is compacted");
+    static_assert(defaults.data()[0] == '{' && defaults.data()[85] == '}', "document is compacted");
+    TEST_STRING_EQUAL(defaults.data(), "{\"retries\":3,\"ratio\":-0.5e-3,\"hosts\":[\"a\",\"b\\u0041\"],\"tls\":{\"enabled\":true,\"ca\":null}}");
+
+    // Read through the lazy view
+    TEST_EQUAL(defaults.type(), json::jtype::jobject);
+    TEST_EQUAL((int)defaults["retries"], 3);
+    TEST_TRUE((double)defaults["ratio"] < 0);
+    TEST_STRING_EQUAL(defaults["hosts"].array(1).as_string().c_str(), "bA");
+    TEST_TRUE(defaults["tls"]["enabled"].is_true());
+    TEST_TRUE(defaults["tls"]["ca"].is_null());
+    TEST_FALSE(defaults.root().has_key("missing"));
+
+    constexpr auto table = json::make_static("[ 1, [], {} ]");
+    TEST_EQUAL(table.root().size(), 3);
+    TEST_TRUE(table.array(2).is_object());
+    constexpr auto scalar = json::make_static(" \"text\" ");
+    TEST_STRING_EQUAL(scalar.data(), "\"text\"");
+
+    // Conversion to a mutable object
+    json::jobject copy = defaults.as_object();
+    TEST_EQUAL(copy.size(), 4);
+    TEST_STRING_EQUAL(copy["hosts"].as_string().c_str(), "[\"a\",\"b\\u0041\"]");
+
+    // Outside of constant expressions errors are thrown
+    const char *invalid[] = { "[1,]", "{\"a\" 1}", "01", "1.", "tru", "\"\\x\"", "\"\\u12g4\"", "[1] 2", "" };
+    for(size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+    {
+        bool thrown = false;
+        char literal[16] = { 0 };
+        strcpy(literal, invalid[i]);
+        try
+        {
+            json::static_document<16> document(literal);
+            (void)document;
+        }
+        catch(const json::parsing_error &)
+        {
+            thrown = true;
+        }
+        TEST_TRUE(thrown);
+    }
+#endif
+}
@@ -0,0 +1,108 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+#include <vector>
+#include <string.h>
+
+// The application opts in to counting allocations
+JSON_STATS_DEFINE_NEW
+
+int main(void)
+{
+    TEST_STRING_EQUAL(json::stats::name(json::stats::PARSE), "parse");
+    TEST_STRING_EQUAL(json::stats::name(json::stats::SERIALIZE), "serialize");
+    TEST_STRING_EQUAL(json::stats::name(json::stats::ACCESS), "access");
+
+    json::stats::reset();
+    json::stats::collector collected;
+    json::jobject parsed = json::jobject::parse("{\"list\":[1,2,3],\"text\":\"a string that does not fit in a small string buffer\"}");
+    const std::string serialized = parsed.as_string();
+    const std::vector<int> list = parsed["list"];
+    parsed["text"] = "another string that does not fit in a small string buffer";
+
+#if JSON_ENABLE_STATS
+    // Allocations are attributed to the operation the application invoked
+    TEST_TRUE(collected[json::stats::PARSE].count > 0);
+    TEST_TRUE(collected[json::stats::PARSE].bytes >= serialized.size());
+    TEST_TRUE(collected[json::stats::SERIALIZE].bytes >= serialized.size());
+    TEST_TRUE(collected[json::stats::ACCESS].count > 0);
+    TEST_EQUAL(collected.total().count, collected[json::stats::PARSE].count + collected[json::stats::SERIALIZE].count + collected[json::stats::ACCESS].count);
+    TEST_EQUAL(json::stats::allocated(json::stats::PARSE).count, collected[json::stats::PARSE].count);
+
+    // Allocations outside of simpleson are not counted
+    {
+        json::stats::collector inner;
+        std::string *outside = new std::string(200, 'x');
+        delete outside;
+        TEST_EQUAL(inner.total().count, 0);
+    }
+
+    // Nested collectors all receive the allocation
+    const uint64_t before = collected[json::stats::PARSE].count;
+    {
+        json::stats::collector inner;
+        json::jobject::parse("[\"a string that does not fit in a small string buffer\"]");
+        TEST_TRUE(inner[json::stats::PARSE].count > 0);
+        TEST_EQUAL(collected[json::stats::PARSE].count - before, inner[json::stats::PARSE].count);
+    }
+
+    // Hot-path counters
+    json::stats::reset();
+    json::reader stream;
+    const char *pushed = "[1, {\"a\": 2}]";
+    for(size_t i = 0; i < strlen(pushed); i++) stream.push(pushed[i]);
+    TEST_EQUAL(json::stats::counted(json::stats::INPUT_CHARACTERS), strlen(pushed));
+    // A streamed value is timed once, not once per character
+    TEST_EQUAL(json::stats::latency(json::stats::PARSE).count, 1);
+    TEST_TRUE(json::stats::counted(json::stats::SUB_READERS) >= 2);
+    TEST_TRUE(parsed["list"].is_array());
+    TEST_EQUAL(json::stats::counted(json::stats::REPARSES), 1);
+    TEST_EQUAL((int)parsed["list"].array(2), 3);
+    TEST_EQUAL(json::stats::counted(json::stats::FORMAT_CALLS), 1);
+    TEST_TRUE(parsed.has_key("text"));
+    TEST_FALSE(parsed.has_key("missing"));
+    TEST_EQUAL(json::stats::counted(json::stats::KEY_COMPARISONS), 2 + 2 + 2);
+
+    // Parsing counts the characters it consumes
+    json::stats::reset();
+    const char *object_text = "{\"a\": [1, 2], \"b\": \"text\"}";
+    json::jobject::parse(object_text);
+    TEST_EQUAL(json::stats::counted(json::stats::INPUT_CHARACTERS), strlen(object_text));
+    json::stats::reset();
+    json::parsing::parse("[true, false] ");
+    TEST_EQUAL(json::stats::counted(json::stats::INPUT_CHARACTERS), strlen("[true, false]"));
+    TEST_EQUAL(json::stats::latency(json::stats::PARSE).count, 1);
+
+    // Latency of the outermost operations
+    json::stats::reset();
+    json::jobject::parse("{\"a\":{\"b\":[1,2]}}").pretty();
+    TEST_EQUAL(json::stats::latency(json::stats::PARSE).count, 1);
+    TEST_EQUAL(json::stats::latency(json::stats::SERIALIZE).count, 1);
+    uint64_t bucketed = 0;
+    const json::stats::histogram parse_latency = json::stats::latency(json::stats::PARSE);
+    for(size_t i = 0; i < json::stats::histogram::BUCKETS; i++) bucketed += parse_latency.buckets[i];
+    TEST_EQUAL(bucketed, 1);
+
+    // Everything can be dumped as an object
+    const json::jobject dumped = json::stats::dump();
+    TEST_TRUE(dumped["enabled"].is_true());
+    TEST_EQUAL((int)dumped.at_pointer("/latency/parse/count"), 1);
+    TEST_EQUAL(dumped.at_pointer("/latency/serialize/buckets").as_array<int>().size(), json::stats::histogram::BUCKETS);
+    TEST_TRUE(dumped["counters"].as_object().has_key("reparses"));
+
+    json::stats::reset();
+    TEST_EQUAL(json::stats::allocated(json::stats::PARSE).count, 0);
+    TEST_EQUAL(json::stats::counted(json::stats::KEY_LOOKUPS), 0);
+#else
+    // Without instrumentation the counters stay at zero
+    TEST_EQUAL(collected.total().count, 0);
+    TEST_EQUAL(json::stats::allocated(json::stats::PARSE).bytes, 0);
+    TEST_EQUAL(list.size(), 3);
+    TEST_TRUE(parsed["list"].is_array());
+    TEST_EQUAL(json::stats::counted(json::stats::REPARSES), 0);
+    TEST_EQUAL(json::stats::latency(json::stats::PARSE).count, 0);
+    const json::jobject dumped = json::stats::dump();
+    TEST_FALSE(dumped["enabled"].is_true());
+    TEST_EQUAL((int)dumped.at_pointer("/counters/key_lookups"), 0);
+#endif
+}
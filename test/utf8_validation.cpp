@@ -0,0 +1,71 @@
+#include "json.h"
+#include "test.h"
+#include <string>
+
+size_t validate(const char *input)
+{
+    return json::parsing::validate_utf8(input, strlen(input));
+}
+
+size_t parse_error_offset(const char *input)
+{
+    try
+    {
+        json::jobject::parse(input, true);
+    }
+    catch(const json::invalid_utf8 &error)
+    {
+        return error.offset;
+    }
+    return (size_t)-1;
+}
+
+int main(void)
+{
+    // Valid text
+    TEST_EQUAL(validate(""), 0);
+    TEST_EQUAL(validate("plain ASCII text that spans several machine words"), 49);
+    TEST_EQUAL(validate("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 \xf4\x8f\xbf\xbf"), 19);
+
+    // Invalid text reports the start of the offending sequence
+    TEST_EQUAL(validate("abc\x80"), 3);
+    TEST_EQUAL(validate("abcdefghij\xc0\xaf"), 10);
+    TEST_EQUAL(validate("ab\xe0\x80\xaf"), 2);
+    TEST_EQUAL(validate("\xed\xa0\x80"), 0);
+    TEST_EQUAL(validate("\xf4\x90\x80\x80"), 0);
+    TEST_EQUAL(validate("\xf5\x80\x80\x80"), 0);
+    TEST_EQUAL(validate("ok\xe2\x82"), 2);
+    TEST_EQUAL(validate("ok\xe2\x82z"), 2);
+
+    // Reader rejects invalid sequences only when validating
+    const char *invalid = "\"a\xff\"";
+    json::reader validating(true);
+    json::reader permissive;
+    TEST_EQUAL(validating.push(invalid[0]), json::reader::ACCEPTED);
+    TEST_EQUAL(validating.push(invalid[1]), json::reader::ACCEPTED);
+    TEST_EQUAL(validating.push(invalid[2]), json::reader::REJECTED);
+    TEST_TRUE(validating.utf8_error());
+    for (size_t i = 0; i < strlen(invalid); i++) TEST_EQUAL(permissive.push(invalid[i]), json::reader::ACCEPTED);
+    TEST_TRUE(permissive.is_valid());
+    TEST_FALSE(permissive.utf8_error());
+
+    // A truncated sequence is rejected at the closing quote
+    validating.clear();
+    const char *truncated = "\"\xc3\"";
+    TEST_EQUAL(validating.push(truncated[0]), json::reader::ACCEPTED);
+    TEST_EQUAL(validating.push(truncated[1]), json::reader::ACCEPTED);
+    TEST_EQUAL(validating.push(truncated[2]), json::reader::REJECTED);
+
+    // Validation during document parsing
+    const char *valid_doc = "{\"name\":\"\xce\xba\xce\xb1\xce\xbb\xce\xb7\xce\xbc\xe1\xbd\xb3\xcf\x81\xce\xb1\",\"list\":[\"\xe2\x82\xac\"]}";
+    json::jobject result = json::jobject::parse(valid_doc, true);
+    TEST_EQUAL(result.size(), 2);
+    TEST_EQUAL(parse_error_offset("{\"a\":\"ok\",\"b\":\"x\xc3(\"}"), 16);
+    TEST_EQUAL(parse_error_offset("{ \"k\xff\": 1 }"), 4);
+    TEST_EQUAL(parse_error_offset("{\"a\":{\"b\":[1,\"\xe2\x28\xa1\"]}}"), 14);
+    TEST_EQUAL(parse_error_offset("[\"x\", \"\xed\xbf\xbf\"]"), 7);
+
+    // Without validation the same input is accepted
+    result = json::jobject::parse("{\"a\":\"ok\",\"b\":\"x\xc3(\"}");
+    TEST_EQUAL(result.size(), 2);
+}